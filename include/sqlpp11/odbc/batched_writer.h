@@ -0,0 +1,109 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_BATCHED_WRITER_H
+#define SQLPP11_ODBC_BATCHED_WRITER_H
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <utility>
+#include <sqlpp11/odbc/connection.h>
+
+namespace sqlpp {
+	namespace odbc {
+		//! Outcome of a batch, reported once it has been committed or rolled back
+		struct batch_result {
+			//Statements in the batch, not counting the one that failed
+			size_t statements;
+			bool committed;
+			//What went wrong if the batch was rolled back
+			std::string error;
+		};
+		
+		struct batched_writer_config {
+			//Commit once this many statements have been executed...
+			size_t max_statements = 1000;
+			//...or this long after the first statement of a batch, whichever comes first
+			std::chrono::milliseconds max_delay = std::chrono::milliseconds(100);
+			//Called for every batch that ends, committed or not
+			std::function<void(const batch_result&)> on_batch;
+		};
+		
+		//! Runs inserts, updates, removes and prepared executions in transactions of many statements each (group commit).
+		// Time is only checked when statements are written, writers that might stay idle should call flush_if_due() now and then.
+		// A failing statement rolls back the whole batch, it is reported through on_batch and its exception rethrown.
+		// Not thread safe, and the connection mustn't be used for anything else while a batch is open.
+		class batched_writer {
+			connection& _db;
+			batched_writer_config _config;
+			bool _open = false;
+			size_t _pending = 0;
+			std::chrono::steady_clock::time_point _started;
+			
+			void begin();
+			void written();
+			void abort(const std::string& error);
+			void report(const batch_result& result);
+			
+		public:
+			batched_writer(connection& db, batched_writer_config config = batched_writer_config());
+			batched_writer(const batched_writer&) = delete;
+			batched_writer& operator=(const batched_writer&) = delete;
+			//! Commits the open batch, errors are only reported through on_batch
+			~batched_writer();
+			
+			template <typename T>
+			auto operator()(const T& t) -> decltype(std::declval<connection&>()(t)) {
+				begin();
+				try {
+					auto result = _db(t);
+					written();
+					return result;
+				} catch(const std::exception& e) {
+					abort(e.what());
+					throw;
+				}
+			}
+			
+			size_t execute(const std::string& command);
+			
+			//! Commits the open batch, if any. Rethrows commit errors after the batch has been rolled back and reported.
+			void flush();
+			
+			//! Commits the open batch if max_delay has passed, returns whether it did
+			bool flush_if_due();
+			
+			//! Statements in the open batch
+			size_t pending() const {
+				return _pending;
+			}
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_BATCHED_WRITER_H
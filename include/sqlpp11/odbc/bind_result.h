@@ -49,12 +49,16 @@
 namespace sqlpp {
 	namespace odbc {
 		class connection;
+		class lazy_result_t;
+		class numeric_t;
 		namespace detail {
 			struct prepared_statement_handle_t;
+			struct result_column_t;
 		}
 		
 		class bind_result_t {
 			friend connection;
+			friend lazy_result_t;
 			std::shared_ptr<detail::prepared_statement_handle_t> _handle;
 			
 		public:
@@ -80,7 +84,6 @@ namespace sqlpp {
 					if (not result_row) {
 						result_row._validate();
 					}
-					std::cerr << "Calling _bind" << std::endl;
 					result_row._bind(*this);
 				} else {
 					if (result_row) {
@@ -97,10 +100,19 @@ namespace sqlpp {
 			void _bind_date_time_result(size_t index, ::sqlpp::time_point::_cpp_value_type* value, bool* is_null);
 			void _bind_time_of_day_result(size_t index, ::sqlpp::time_of_day::_cpp_value_type* value, bool* is_null);
 			void _bind_timestamp_result(size_t index, SQL_TIMESTAMP_STRUCT* value, bool* is_null);
+			void _bind_numeric_result(size_t index, numeric_t* value, bool* is_null);
 
 			size_t size() const;
+			
+			//! Stops the statement while another thread fetches from it, that thread gets query_cancelled
+			void cancel();
 		private:
 			bool next_impl();
+			//! The column as described by the driver, cached in the statement handle
+			const detail::result_column_t& result_column(size_t index);
+			//! Buffer size for the first SQLGetData of a text column
+			size_t initial_text_length(size_t index);
+			void _bind_wide_text_result(size_t index, const char** text, size_t* len);
 		};
 	}
 }
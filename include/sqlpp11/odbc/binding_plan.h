@@ -0,0 +1,383 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_BINDING_PLAN_H
+#define SQLPP11_ODBC_BINDING_PLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <sqlpp11/chrono.h>
+#include <sqlpp11/data_types.h>
+#include <sqlpp11/result_row.h>
+#include <sqlpp11/odbc/civil_time.h>
+#include <sqlpp11/odbc/result_columns.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sqlext.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			struct prepared_statement_handle_t;
+			struct result_binding_t;
+			
+			//! C type, buffer size and alignment a column of that kind is bound with
+			template <column_kind Kind, size_t TextLength>
+			struct column_plan;
+			template <size_t TextLength>
+			struct column_plan<column_kind::integral, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_SBIGINT;
+				static constexpr size_t width = sizeof(SQLBIGINT);
+				static constexpr size_t alignment = alignof(SQLBIGINT);
+			};
+			template <size_t TextLength>
+			struct column_plan<column_kind::floating_point, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_DOUBLE;
+				static constexpr size_t width = sizeof(SQLDOUBLE);
+				static constexpr size_t alignment = alignof(SQLDOUBLE);
+			};
+			template <size_t TextLength>
+			struct column_plan<column_kind::boolean, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_BIT;
+				static constexpr size_t width = sizeof(SQLCHAR);
+				static constexpr size_t alignment = alignof(SQLCHAR);
+			};
+			template <size_t TextLength>
+			struct column_plan<column_kind::text, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_CHAR;
+				//Room for the terminating null character
+				static constexpr size_t width = TextLength + 1;
+				static constexpr size_t alignment = 1;
+			};
+			template <size_t TextLength>
+			struct column_plan<column_kind::date, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_TYPE_DATE;
+				static constexpr size_t width = sizeof(SQL_DATE_STRUCT);
+				static constexpr size_t alignment = alignof(SQL_DATE_STRUCT);
+			};
+			template <size_t TextLength>
+			struct column_plan<column_kind::date_time, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_TYPE_TIMESTAMP;
+				static constexpr size_t width = sizeof(SQL_TIMESTAMP_STRUCT);
+				static constexpr size_t alignment = alignof(SQL_TIMESTAMP_STRUCT);
+			};
+			template <size_t TextLength>
+			struct column_plan<column_kind::time_of_day, TextLength> {
+				static constexpr SQLSMALLINT c_type = SQL_C_TYPE_TIME;
+				static constexpr size_t width = sizeof(SQL_TIME_STRUCT);
+				static constexpr size_t alignment = alignof(SQL_TIME_STRUCT);
+			};
+			
+			//Rows are aligned for the most demanding value or indicator
+			constexpr size_t row_alignment = alignof(SQLBIGINT) > alignof(SQLDOUBLE) ?
+				(alignof(SQLBIGINT) > alignof(SQLLEN) ? alignof(SQLBIGINT) : alignof(SQLLEN)) :
+				(alignof(SQLDOUBLE) > alignof(SQLLEN) ? alignof(SQLDOUBLE) : alignof(SQLLEN));
+			
+			constexpr size_t align_up(size_t offset, size_t alignment) {
+				return (offset + alignment - 1) / alignment * alignment;
+			}
+			
+			//! Offset of column index in a row, each value follows the previous one at its own alignment
+			constexpr size_t value_offset(const size_t* widths, const size_t* alignments, size_t index) {
+				return index == 0 ? 0 : align_up(value_offset(widths, alignments, index - 1) + widths[index - 1], alignments[index]);
+			}
+			
+			template <size_t... Indexes>
+			struct index_sequence {};
+			template <size_t N, size_t... Indexes>
+			struct make_index_sequence : make_index_sequence<N - 1, N - 1, Indexes...> {};
+			template <size_t... Indexes>
+			struct make_index_sequence<0, Indexes...> {
+				using type = index_sequence<Indexes...>;
+			};
+			
+			//! A binding plan as seen by the code that binds and fetches, which is not a template
+			struct binding_plan_view_t {
+				size_t column_count;
+				const SQLSMALLINT* c_types;
+				const size_t* widths;
+				const size_t* offsets;
+				const size_t* indicator_offsets;
+				size_t row_size;
+			};
+			
+			template <size_t TextLength, typename Indexes, typename... FieldSpecs>
+			struct binding_plan_impl;
+			
+			template <size_t TextLength, size_t... Indexes, typename... FieldSpecs>
+			struct binding_plan_impl<TextLength, index_sequence<Indexes...>, FieldSpecs...> {
+				static constexpr size_t column_count = sizeof...(FieldSpecs);
+				static constexpr SQLSMALLINT c_types[] = {column_plan<field_kind<FieldSpecs>::value, TextLength>::c_type...};
+				static constexpr size_t widths[] = {column_plan<field_kind<FieldSpecs>::value, TextLength>::width...};
+				static constexpr size_t alignments[] = {column_plan<field_kind<FieldSpecs>::value, TextLength>::alignment...};
+				static constexpr size_t offsets[] = {value_offset(widths, alignments, Indexes)...};
+				//The null indicators follow the values
+				static constexpr size_t indicators_offset = align_up(offsets[column_count - 1] + widths[column_count - 1], alignof(SQLLEN));
+				static constexpr size_t indicator_offsets[] = {(indicators_offset + Indexes * sizeof(SQLLEN))...};
+				//Rows follow each other at this stride (SQL_ATTR_ROW_BIND_TYPE), so every row is aligned like the first
+				static constexpr size_t row_size = align_up(indicators_offset + column_count * sizeof(SQLLEN), row_alignment);
+				
+				static binding_plan_view_t view() {
+					return {column_count, c_types, widths, offsets, indicator_offsets, row_size};
+				}
+			};
+			
+			template <size_t TextLength, size_t... Indexes, typename... FieldSpecs>
+			constexpr SQLSMALLINT binding_plan_impl<TextLength, index_sequence<Indexes...>, FieldSpecs...>::c_types[];
+			template <size_t TextLength, size_t... Indexes, typename... FieldSpecs>
+			constexpr size_t binding_plan_impl<TextLength, index_sequence<Indexes...>, FieldSpecs...>::widths[];
+			template <size_t TextLength, size_t... Indexes, typename... FieldSpecs>
+			constexpr size_t binding_plan_impl<TextLength, index_sequence<Indexes...>, FieldSpecs...>::alignments[];
+			template <size_t TextLength, size_t... Indexes, typename... FieldSpecs>
+			constexpr size_t binding_plan_impl<TextLength, index_sequence<Indexes...>, FieldSpecs...>::offsets[];
+			template <size_t TextLength, size_t... Indexes, typename... FieldSpecs>
+			constexpr size_t binding_plan_impl<TextLength, index_sequence<Indexes...>, FieldSpecs...>::indicator_offsets[];
+		}
+		
+		//! Row buffer layout of a result row type, worked out at compile time
+		// Every column is bound (SQLBindCol) row-wise into one buffer: c_types, widths and offsets describe the
+		// values, indicator_offsets their length/null indicators. Text columns hold up to TextLength bytes.
+		template <typename ResultRow, size_t TextLength = 255>
+		struct binding_plan;
+		
+		template <typename Db, typename... FieldSpecs, size_t TextLength>
+		struct binding_plan<::sqlpp::result_row_t<Db, FieldSpecs...>, TextLength>
+			: detail::binding_plan_impl<TextLength, typename detail::make_index_sequence<sizeof...(FieldSpecs)>::type, FieldSpecs...> {
+		};
+		
+		//! Fetches a result block by block into a row-wise bound buffer laid out by a binding plan
+		class planned_result_t {
+		protected:
+			std::shared_ptr<detail::prepared_statement_handle_t> _handle;
+			detail::binding_plan_view_t _plan;
+			//Buffer and fetched row count the driver writes to, owned by the statement handle if the binding is kept
+			std::shared_ptr<detail::result_binding_t> _binding;
+			//Row the fields are bound from
+			const char* _row = nullptr;
+			const char* _end = nullptr;
+			bool _done = false;
+			
+			bool fetch();
+			
+			//! Moves to the next row, fetching the next block when the current one is used up
+			bool next_row() {
+				if(_row) {
+					_row += _plan.row_size;
+				}
+				if(_row == _end) {
+					return fetch();
+				}
+				return true;
+			}
+			
+			SQLLEN indicator(size_t index) const {
+				SQLLEN value;
+				std::memcpy(&value, _row + _plan.indicator_offsets[index], sizeof(value));
+				return value;
+			}
+			
+		public:
+			planned_result_t() = default;
+			//! Binds the columns of an executed statement, rows is the number fetched per SQLFetch
+			// With keep_binding, the columns stay bound after the result is gone, and the next planned result of the
+			// statement with the same plan and rows uses them as they are.
+			planned_result_t(const std::shared_ptr<detail::prepared_statement_handle_t>& handle, const detail::binding_plan_view_t& plan, size_t rows, bool keep_binding = false);
+			planned_result_t(const planned_result_t&) = delete;
+			planned_result_t(planned_result_t&&) = default;
+			planned_result_t& operator=(const planned_result_t&) = delete;
+			planned_result_t& operator=(planned_result_t&&) = default;
+			~planned_result_t();
+			
+			bool operator==(const planned_result_t& rhs) const {
+				return _handle == rhs._handle;
+			}
+			
+			size_t capacity() const;
+		};
+		
+		//! A result decoded along a binding_plan, iterated like the result of db(select(...))
+		// Columns are bound once and SQLFetch fills whole blocks of rows. Each _bind_*_result reads at an offset
+		// that is a compile-time constant once the calls from ResultRow::_bind are inlined.
+		template <typename ResultRow, size_t TextLength = 255>
+		class planned_result : public planned_result_t {
+			using plan = binding_plan<ResultRow, TextLength>;
+			ResultRow _result_row;
+			
+			template <typename T>
+			T read(size_t index) const {
+				T v;
+				std::memcpy(&v, _row + plan::offsets[index], sizeof(T));
+				return v;
+			}
+			
+			bool null(size_t index) const {
+				return indicator(index) == SQL_NULL_DATA;
+			}
+			
+		public:
+			class iterator {
+				planned_result* _owner = nullptr;
+				
+			public:
+				using iterator_category = std::input_iterator_tag;
+				using value_type = ResultRow;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const ResultRow*;
+				using reference = const ResultRow&;
+				
+				iterator() = default;
+				explicit iterator(planned_result* owner) : _owner(owner && owner->_result_row ? owner : nullptr) {}
+				
+				reference operator*() const {
+					return _owner->_result_row;
+				}
+				
+				pointer operator->() const {
+					return &_owner->_result_row;
+				}
+				
+				iterator& operator++() {
+					_owner->next(_owner->_result_row);
+					if(!_owner->_result_row) {
+						_owner = nullptr;
+					}
+					return *this;
+				}
+				
+				bool operator==(const iterator& rhs) const {
+					return _owner == rhs._owner;
+				}
+				
+				bool operator!=(const iterator& rhs) const {
+					return !(*this == rhs);
+				}
+			};
+			
+			planned_result() = default;
+			explicit planned_result(planned_result_t&& result) : planned_result_t(std::move(result)) {
+				next(_result_row);
+			}
+			planned_result(const planned_result&) = delete;
+			planned_result(planned_result&& rhs) : planned_result_t(std::move(rhs)) {
+				//The fields point into the buffer, which moved along with it
+				if(rhs._result_row) {
+					rhs._result_row._invalidate();
+					_result_row._validate();
+					_result_row._bind(*this);
+				}
+			}
+			planned_result& operator=(const planned_result&) = delete;
+			planned_result& operator=(planned_result&&) = delete;
+			~planned_result() = default;
+			
+			//! Single pass: begin() starts at the current row
+			iterator begin() {
+				return iterator(this);
+			}
+			
+			iterator end() {
+				return iterator();
+			}
+			
+			void next(ResultRow& result_row) {
+				if(_handle && next_row()) {
+					if(not result_row) {
+						result_row._validate();
+					}
+					result_row._bind(*this);
+				} else {
+					if(result_row) {
+						result_row._invalidate();
+					}
+				}
+			}
+			
+			void _bind_boolean_result(size_t index, signed char* value, bool* is_null) {
+				*is_null = null(index);
+				*value = static_cast<signed char>(read<SQLCHAR>(index));
+			}
+			
+			void _bind_floating_point_result(size_t index, double* value, bool* is_null) {
+				*is_null = null(index);
+				*value = read<SQLDOUBLE>(index);
+			}
+			
+			void _bind_integral_result(size_t index, int64_t* value, bool* is_null) {
+				*is_null = null(index);
+				*value = read<SQLBIGINT>(index);
+			}
+			
+			void _bind_text_result(size_t index, const char** value, size_t* len) {
+				const SQLLEN ind = indicator(index);
+				*value = ind == SQL_NULL_DATA ? nullptr : _row + plan::offsets[index];
+				*len = ind == SQL_NULL_DATA ? 0 : static_cast<size_t>(ind);
+			}
+			
+			void _bind_date_result(size_t index, ::sqlpp::day_point::_cpp_value_type* value, bool* is_null) {
+				*is_null = null(index);
+				if(!*is_null) {
+					const SQL_DATE_STRUCT date = read<SQL_DATE_STRUCT>(index);
+					*value = ::sqlpp::day_point::_cpp_value_type(::sqlpp::chrono::days(days_from_civil(date.year, date.month, date.day)));
+				}
+			}
+			
+			void _bind_date_time_result(size_t index, ::sqlpp::time_point::_cpp_value_type* value, bool* is_null) {
+				*is_null = null(index);
+				if(!*is_null) {
+					*value = ::sqlpp::time_point::_cpp_value_type(std::chrono::microseconds(microseconds_from_timestamp(read<SQL_TIMESTAMP_STRUCT>(index))));
+				}
+			}
+			
+			void _bind_time_of_day_result(size_t index, ::sqlpp::time_of_day::_cpp_value_type* value, bool* is_null) {
+				*is_null = null(index);
+				if(!*is_null) {
+					*value = std::chrono::microseconds(microseconds_from_time(read<SQL_TIME_STRUCT>(index)));
+				}
+			}
+			
+			void _bind_timestamp_result(size_t index, SQL_TIMESTAMP_STRUCT* value, bool* is_null) {
+				*is_null = null(index);
+				*value = read<SQL_TIMESTAMP_STRUCT>(index);
+			}
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_BINDING_PLAN_H
@@ -0,0 +1,142 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_CIVIL_TIME_H
+#define SQLPP11_ODBC_CIVIL_TIME_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sqlext.h>
+
+//Conversions between the ODBC date/time structs and day or microsecond counts since 1970-01-01 (proleptic Gregorian).
+//They follow Howard Hinnant's days_from_civil/civil_from_days, but shift the years by 82 eras (32800 years),
+//so every SQLSMALLINT year is positive and no branches are needed for negative years.
+//The batch functions convert whole columns, their loops are free of branches so compilers can vectorize them.
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			constexpr int32_t civil_year_shift = 82 * 400;
+			constexpr int32_t civil_day_shift = 82 * 146097 + 719468;
+			constexpr int64_t microseconds_per_day = INT64_C(86400000000);
+		}
+		
+		inline int32_t days_from_civil(int32_t year, uint32_t month, uint32_t day) {
+			const uint32_t y = static_cast<uint32_t>(year + detail::civil_year_shift - (month <= 2));
+			const uint32_t era = y / 400;
+			const uint32_t yoe = y - era * 400;
+			//Months counted from March, so the leap day is the last day of the year
+			const uint32_t mp = (month + 9) % 12;
+			const uint32_t doy = (153 * mp + 2) / 5 + day - 1;
+			const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return static_cast<int32_t>(era * 146097 + doe) - detail::civil_day_shift;
+		}
+		
+		inline SQL_DATE_STRUCT civil_from_days(int32_t days) {
+			const uint32_t z = static_cast<uint32_t>(days + detail::civil_day_shift);
+			const uint32_t era = z / 146097;
+			const uint32_t doe = z - era * 146097;
+			const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+			const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+			const uint32_t mp = (5 * doy + 2) / 153;
+			const uint32_t month = (mp + 2) % 12 + 1;
+			SQL_DATE_STRUCT date;
+			date.year = static_cast<SQLSMALLINT>(static_cast<int32_t>(yoe + era * 400) - detail::civil_year_shift + (month <= 2));
+			date.month = static_cast<SQLUSMALLINT>(month);
+			date.day = static_cast<SQLUSMALLINT>(doy - (153 * mp + 2) / 5 + 1);
+			return date;
+		}
+		
+		inline int64_t microseconds_from_time(uint32_t hour, uint32_t minute, uint32_t second) {
+			return static_cast<int64_t>(hour * 3600 + minute * 60 + second) * 1000000;
+		}
+		
+		inline int64_t microseconds_from_time(const SQL_TIME_STRUCT& time) {
+			return microseconds_from_time(time.hour, time.minute, time.second);
+		}
+		
+		//! The fraction of a timestamp is in nanoseconds, it is truncated to microseconds
+		inline int64_t microseconds_from_timestamp(const SQL_TIMESTAMP_STRUCT& timestamp) {
+			return days_from_civil(timestamp.year, timestamp.month, timestamp.day) * detail::microseconds_per_day +
+				microseconds_from_time(timestamp.hour, timestamp.minute, timestamp.second) + timestamp.fraction / 1000;
+		}
+		
+		//! Splits microseconds since the epoch into days and the (never negative) microseconds into that day
+		inline int32_t split_microseconds(int64_t microseconds, int64_t& time_of_day) {
+			int64_t days = microseconds / detail::microseconds_per_day;
+			time_of_day = microseconds % detail::microseconds_per_day;
+			//Round towards negative infinity without a branch
+			const int64_t borrow = time_of_day >> 63;
+			days += borrow;
+			time_of_day += detail::microseconds_per_day & borrow;
+			return static_cast<int32_t>(days);
+		}
+		
+		inline SQL_TIME_STRUCT time_from_microseconds(int64_t microseconds) {
+			int64_t time_of_day;
+			split_microseconds(microseconds, time_of_day);
+			const uint32_t seconds = static_cast<uint32_t>(time_of_day / 1000000);
+			SQL_TIME_STRUCT time;
+			time.hour = static_cast<SQLUSMALLINT>(seconds / 3600);
+			time.minute = static_cast<SQLUSMALLINT>(seconds / 60 % 60);
+			time.second = static_cast<SQLUSMALLINT>(seconds % 60);
+			return time;
+		}
+		
+		inline SQL_TIMESTAMP_STRUCT timestamp_from_microseconds(int64_t microseconds) {
+			int64_t time_of_day;
+			const SQL_DATE_STRUCT date = civil_from_days(split_microseconds(microseconds, time_of_day));
+			const uint32_t seconds = static_cast<uint32_t>(time_of_day / 1000000);
+			SQL_TIMESTAMP_STRUCT timestamp;
+			timestamp.year = date.year;
+			timestamp.month = date.month;
+			timestamp.day = date.day;
+			timestamp.hour = static_cast<SQLUSMALLINT>(seconds / 3600);
+			timestamp.minute = static_cast<SQLUSMALLINT>(seconds / 60 % 60);
+			timestamp.second = static_cast<SQLUSMALLINT>(seconds % 60);
+			timestamp.fraction = static_cast<SQLUINTEGER>(time_of_day % 1000000) * 1000;
+			return timestamp;
+		}
+		
+		void days_from_dates(const SQL_DATE_STRUCT* dates, size_t count, int32_t* days);
+		void microseconds_from_timestamps(const SQL_TIMESTAMP_STRUCT* timestamps, size_t count, int64_t* microseconds);
+		void microseconds_from_times(const SQL_TIME_STRUCT* times, size_t count, int64_t* microseconds);
+		void dates_from_days(const int32_t* days, size_t count, SQL_DATE_STRUCT* dates);
+		void timestamps_from_microseconds(const int64_t* microseconds, size_t count, SQL_TIMESTAMP_STRUCT* timestamps);
+	}
+}
+
+#endif //SQLPP11_ODBC_CIVIL_TIME_H
@@ -0,0 +1,229 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_COALESCING_LOOKUP_H
+#define SQLPP11_ODBC_COALESCING_LOOKUP_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/result_row.h>
+#include <sqlpp11/odbc/in_list.h>
+
+namespace sqlpp {
+	namespace odbc {
+		struct coalescing_config {
+			//How long the lookup opening a batch waits for others to join it
+			std::chrono::microseconds max_delay = std::chrono::microseconds(500);
+			//Lookups per batch, a full batch runs right away
+			size_t max_keys = 128;
+			//Statements the batches run, see in_list_lookup
+			in_list_config lookup;
+		};
+		
+		namespace detail {
+			//! Position of Alias in Aliases, or their number if it's not one of them
+			template <typename Alias, size_t Index, typename... Aliases>
+			struct alias_index : std::integral_constant<size_t, Index> {};
+			
+			template <typename Alias, size_t Index, typename First, typename... Rest>
+			struct alias_index<Alias, Index, First, Rest...> : std::conditional<std::is_same<Alias, First>::value,
+				std::integral_constant<size_t, Index>, alias_index<Alias, Index + 1, Rest...>>::type {};
+			
+			//! Index of Column among the fields of ResultRow
+			template <typename Column, typename ResultRow>
+			struct key_column_index;
+			
+			template <typename Column, typename Db, typename... FieldSpecs>
+			struct key_column_index<Column, ::sqlpp::result_row_t<Db, FieldSpecs...>> : alias_index<typename Column::_alias_t, 0, typename FieldSpecs::_alias_t...> {
+				static_assert(alias_index<typename Column::_alias_t, 0, typename FieldSpecs::_alias_t...>::value < sizeof...(FieldSpecs), "the key column must be selected to route rows by it");
+			};
+			
+			inline void read_block_key(const rowset_block_t& block, size_t column, size_t row, int64_t& key) {
+				key = block.values<SQLBIGINT>(column)[row];
+			}
+			inline void read_block_key(const rowset_block_t& block, size_t column, size_t row, std::string& key) {
+				key.assign(block.text(column, row), block.text_length(column, row));
+			}
+		}
+		
+		//! Coalesces point lookups from many threads into in_list_lookup batches on one connection, DataLoader style.
+		// The first lookup of a batch waits up to max_delay for others to join, or until max_keys have, then runs the
+		// batch and fulfills the futures of all its callers; the callers that joined return at once. Rows are routed back
+		// by the key column, which must be selected. Callers asking for the same key share its place in the IN list,
+		// and each gets its own copy of the rows. If the batch fails, every future of it holds the exception.
+		// Batches run one at a time, a batch can fill while the one before it is still running.
+		template <typename Select, typename Column>
+		class coalescing_lookup {
+		public:
+			using _lookup_t = in_list_lookup<Select, Column>;
+			using _result_row_t = typename _lookup_t::_result_row_t;
+			using _key_t = typename _lookup_t::_key_t;
+			using _result_t = stored_result<_result_row_t>;
+			
+		private:
+			struct batch_t {
+				std::vector<_key_t> keys;
+				std::vector<std::promise<_result_t>> promises;
+			};
+			
+			struct state_t {
+				std::mutex mutex;
+				std::condition_variable closed;
+				//The batch lookups join, null until the next lookup opens one
+				std::shared_ptr<batch_t> open;
+				size_t lookups = 0;
+				size_t batches = 0;
+				//Held while a batch runs, the connection takes one statement at a time
+				std::mutex running;
+			};
+			
+			std::chrono::microseconds _max_delay;
+			size_t _max_keys;
+			_lookup_t _lookup;
+			std::unique_ptr<state_t> _state;
+			
+			void run(batch_t& batch) {
+				std::lock_guard<std::mutex> running(_state->running);
+				try {
+					std::map<_key_t, std::vector<size_t>> callers;
+					for(size_t i = 0; i < batch.keys.size(); ++i) {
+						callers[batch.keys[i]].push_back(i);
+					}
+					std::vector<_key_t> keys;
+					keys.reserve(callers.size());
+					for(const auto& key : callers) {
+						keys.push_back(key.first);
+					}
+					std::vector<stored_result_t> results(batch.keys.size(), stored_result_t(result_columns<_result_row_t>::kinds()));
+					const size_t index = detail::key_column_index<Column, _result_row_t>::value;
+					_key_t key;
+					_lookup.each_block(keys, [&](const rowset_block_t& block) {
+						for(size_t row = 0; row < block.size(); ++row) {
+							if(block.is_null(index, row)) {
+								continue;
+							}
+							detail::read_block_key(block, index, row, key);
+							//Rows matching none of the keys as given (case insensitive collations) can't be routed
+							auto it = callers.find(key);
+							if(it == callers.end()) {
+								continue;
+							}
+							for(size_t caller : it->second) {
+								results[caller].append(block, row, 1);
+							}
+						}
+					});
+					for(size_t i = 0; i < batch.promises.size(); ++i) {
+						batch.promises[i].set_value(_result_t(std::move(results[i])));
+					}
+				} catch(...) {
+					for(auto& promise : batch.promises) {
+						try {
+							promise.set_exception(std::current_exception());
+						} catch(const std::future_error&) {
+							//Fulfilled before the failure
+						}
+					}
+				}
+			}
+			
+		public:
+			coalescing_lookup(connection& db, Select select, Column column, coalescing_config config = coalescing_config())
+				: _max_delay(config.max_delay)
+				, _max_keys(config.max_keys)
+				, _lookup(db, std::move(select), std::move(column), std::move(config.lookup))
+				, _state(new state_t)
+			{
+				if(_max_keys == 0) {
+					throw sqlpp::exception("ODBC error: coalescing_config::max_keys must be above 0");
+				}
+			}
+			coalescing_lookup(const coalescing_lookup&) = delete;
+			coalescing_lookup(coalescing_lookup&&) = default;
+			coalescing_lookup& operator=(const coalescing_lookup&) = delete;
+			
+			//! Rows of key, ready when the batch the lookup joined has run
+			std::future<_result_t> operator()(const _key_t& key) {
+				std::unique_lock<std::mutex> lock(_state->mutex);
+				++_state->lookups;
+				std::shared_ptr<batch_t> batch = _state->open;
+				const bool opened = !batch;
+				if(opened) {
+					batch = std::make_shared<batch_t>();
+					_state->open = batch;
+				}
+				batch->keys.push_back(key);
+				batch->promises.emplace_back();
+				std::future<_result_t> result = batch->promises.back().get_future();
+				if(batch->keys.size() >= _max_keys) {
+					_state->open.reset();
+					_state->closed.notify_all();
+				}
+				if(opened) {
+					_state->closed.wait_for(lock, _max_delay, [this, &batch]() {
+						return _state->open != batch;
+					});
+					if(_state->open == batch) {
+						_state->open.reset();
+					}
+					++_state->batches;
+					lock.unlock();
+					run(*batch);
+				}
+				return result;
+			}
+			
+			//! Lookups asked for so far
+			size_t lookups() const {
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				return _state->lookups;
+			}
+			
+			//! Batches run so far, each of them one or more statements
+			size_t batches() const {
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				return _state->batches;
+			}
+		};
+		
+		template <typename Select, typename Column>
+		coalescing_lookup<Select, Column> make_coalescing_lookup(connection& db, const Select& select, const Column& column, const coalescing_config& config = coalescing_config()) {
+			return coalescing_lookup<Select, Column>(db, select, column, config);
+		}
+	}
+}
+
+#endif //SQLPP11_ODBC_COALESCING_LOOKUP_H
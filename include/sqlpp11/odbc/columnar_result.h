@@ -0,0 +1,317 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_COLUMNAR_RESULT_H
+#define SQLPP11_ODBC_COLUMNAR_RESULT_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sqlpp11/chrono.h>
+#include <sqlpp11/data_types.h>
+#include <sqlpp11/result_row.h>
+#include <sqlpp11/odbc/civil_time.h>
+#include <sqlpp11/odbc/result_columns.h>
+#include <sqlpp11/odbc/rowset.h>
+
+namespace sqlpp {
+	namespace odbc {
+		//! One bit per row, least significant bit first, set for non-NULL values (the Arrow validity layout)
+		class validity_bitmap_t {
+			std::vector<uint8_t> _bytes;
+			size_t _size = 0;
+			size_t _null_count = 0;
+			
+		public:
+			void push_back(bool valid) {
+				if(_size % 8 == 0) {
+					_bytes.push_back(0);
+				}
+				if(valid) {
+					_bytes.back() |= static_cast<uint8_t>(1u << (_size % 8));
+				} else {
+					++_null_count;
+				}
+				++_size;
+			}
+			
+			bool operator[](size_t index) const {
+				return (_bytes[index / 8] >> (index % 8)) & 1u;
+			}
+			
+			size_t size() const {
+				return _size;
+			}
+			
+			size_t null_count() const {
+				return _null_count;
+			}
+			
+			const uint8_t* data() const {
+				return _bytes.data();
+			}
+		};
+		
+		//! Contiguous fixed width values, NULL rows hold a value initialized T
+		template <typename T>
+		class value_column_t {
+			std::vector<T> _values;
+			validity_bitmap_t _validity;
+			
+		public:
+			using value_type = T;
+			
+			size_t size() const {
+				return _values.size();
+			}
+			
+			bool is_null(size_t row) const {
+				return !_validity[row];
+			}
+			
+			const T& operator[](size_t row) const {
+				return _values[row];
+			}
+			
+			const T* data() const {
+				return _values.data();
+			}
+			
+			const std::vector<T>& values() const {
+				return _values;
+			}
+			
+			const validity_bitmap_t& validity() const {
+				return _validity;
+			}
+			
+			void push_back(const T& value, bool valid) {
+				_values.push_back(value);
+				_validity.push_back(valid);
+			}
+		};
+		
+		//! Text stored back to back, value i spans [offsets()[i], offsets()[i+1]) of chars()
+		class text_column_t {
+			std::vector<int64_t> _offsets = std::vector<int64_t>(1, 0);
+			std::vector<char> _chars;
+			validity_bitmap_t _validity;
+			
+		public:
+			using value_type = std::string;
+			
+			size_t size() const {
+				return _offsets.size() - 1;
+			}
+			
+			bool is_null(size_t row) const {
+				return !_validity[row];
+			}
+			
+			const char* data(size_t row) const {
+				return _chars.data() + _offsets[row];
+			}
+			
+			size_t length(size_t row) const {
+				return static_cast<size_t>(_offsets[row + 1] - _offsets[row]);
+			}
+			
+			std::string operator[](size_t row) const {
+				return std::string(data(row), length(row));
+			}
+			
+			const std::vector<int64_t>& offsets() const {
+				return _offsets;
+			}
+			
+			const std::vector<char>& chars() const {
+				return _chars;
+			}
+			
+			const validity_bitmap_t& validity() const {
+				return _validity;
+			}
+			
+			void push_back(const char* text, size_t length, bool valid) {
+				_chars.insert(_chars.end(), text, text + length);
+				_offsets.push_back(static_cast<int64_t>(_chars.size()));
+				_validity.push_back(valid);
+			}
+		};
+		
+		namespace detail {
+			template <column_kind Kind>
+			struct column_storage;
+			template <>
+			struct column_storage<column_kind::integral> {
+				using type = value_column_t<int64_t>;
+			};
+			template <>
+			struct column_storage<column_kind::floating_point> {
+				using type = value_column_t<double>;
+			};
+			template <>
+			struct column_storage<column_kind::boolean> {
+				using type = value_column_t<uint8_t>;
+			};
+			template <>
+			struct column_storage<column_kind::text> {
+				using type = text_column_t;
+			};
+			template <>
+			struct column_storage<column_kind::date> {
+				using type = value_column_t<::sqlpp::day_point::_cpp_value_type>;
+			};
+			template <>
+			struct column_storage<column_kind::date_time> {
+				using type = value_column_t<::sqlpp::time_point::_cpp_value_type>;
+			};
+			template <>
+			struct column_storage<column_kind::time_of_day> {
+				using type = value_column_t<::sqlpp::time_of_day::_cpp_value_type>;
+			};
+			
+			template <typename FieldSpec>
+			using field_storage = typename column_storage<field_kind<FieldSpec>::value>::type;
+			
+			inline int64_t decode(const SQLBIGINT& value) {
+				return value;
+			}
+			
+			inline double decode(const SQLDOUBLE& value) {
+				return value;
+			}
+			
+			inline uint8_t decode(const SQLCHAR& value) {
+				return value != 0;
+			}
+			
+			template <typename Source, typename T>
+			void append_values(value_column_t<T>& column, const rowset_block_t& block, size_t index) {
+				const Source* values = block.values<Source>(index);
+				for(size_t row = 0; row < block.size(); ++row) {
+					const bool valid = !block.is_null(index, row);
+					column.push_back(valid ? decode(values[row]) : T(), valid);
+				}
+			}
+			
+			inline void append_column(value_column_t<int64_t>& column, const rowset_block_t& block, size_t index) {
+				append_values<SQLBIGINT>(column, block, index);
+			}
+			
+			inline void append_column(value_column_t<double>& column, const rowset_block_t& block, size_t index) {
+				append_values<SQLDOUBLE>(column, block, index);
+			}
+			
+			inline void append_column(value_column_t<uint8_t>& column, const rowset_block_t& block, size_t index) {
+				append_values<SQLCHAR>(column, block, index);
+			}
+			
+			//Date and time columns are converted to counts for the whole block first, then wrapped in their chrono types
+			template <typename Count, typename T>
+			void append_counts(value_column_t<T>& column, const rowset_block_t& block, size_t index, const std::vector<Count>& counts) {
+				for(size_t row = 0; row < block.size(); ++row) {
+					const bool valid = !block.is_null(index, row);
+					column.push_back(valid ? T(typename T::duration(counts[row])) : T(), valid);
+				}
+			}
+			
+			inline void append_column(value_column_t<::sqlpp::day_point::_cpp_value_type>& column, const rowset_block_t& block, size_t index) {
+				std::vector<int32_t> days(block.size());
+				days_from_dates(block.values<SQL_DATE_STRUCT>(index), block.size(), days.data());
+				append_counts(column, block, index, days);
+			}
+			
+			inline void append_column(value_column_t<::sqlpp::time_point::_cpp_value_type>& column, const rowset_block_t& block, size_t index) {
+				std::vector<int64_t> microseconds(block.size());
+				microseconds_from_timestamps(block.values<SQL_TIMESTAMP_STRUCT>(index), block.size(), microseconds.data());
+				append_counts(column, block, index, microseconds);
+			}
+			
+			inline void append_column(value_column_t<::sqlpp::time_of_day::_cpp_value_type>& column, const rowset_block_t& block, size_t index) {
+				std::vector<int64_t> microseconds(block.size());
+				microseconds_from_times(block.values<SQL_TIME_STRUCT>(index), block.size(), microseconds.data());
+				for(size_t row = 0; row < block.size(); ++row) {
+					const bool valid = !block.is_null(index, row);
+					column.push_back(std::chrono::microseconds(valid ? microseconds[row] : 0), valid);
+				}
+			}
+			
+			inline void append_column(text_column_t& column, const rowset_block_t& block, size_t index) {
+				for(size_t row = 0; row < block.size(); ++row) {
+					const bool valid = !block.is_null(index, row);
+					column.push_back(block.text(index, row), valid ? block.text_length(index, row) : 0, valid);
+				}
+			}
+		}
+		
+		//! A whole result held column by column, each column is a member named like the selected column
+		template <typename... FieldSpecs>
+		class columnar_result_t : public FieldSpecs::_alias_t::template _member_t<detail::field_storage<FieldSpecs>>... {
+			size_t _size = 0;
+			
+			template <size_t Index>
+			void _append_columns(const rowset_block_t&) {}
+			
+			template <size_t Index, typename FieldSpec, typename... Rest>
+			void _append_columns(const rowset_block_t& block) {
+				using _member = typename FieldSpec::_alias_t::template _member_t<detail::field_storage<FieldSpec>>;
+				detail::append_column(static_cast<_member&>(*this)(), block, Index);
+				_append_columns<Index + 1, Rest...>(block);
+			}
+			
+		public:
+			size_t size() const {
+				return _size;
+			}
+			
+			bool empty() const {
+				return _size == 0;
+			}
+			
+			static std::vector<column_info> columns() {
+				return result_columns<::sqlpp::result_row_t<void, FieldSpecs...>>::get();
+			}
+			
+			//! appends a fetched block
+			void _append(const rowset_block_t& block) {
+				_append_columns<0, FieldSpecs...>(block);
+				_size += block.size();
+			}
+		};
+		
+		template <typename ResultRow>
+		struct columnar_result_of;
+		
+		template <typename Db, typename... FieldSpecs>
+		struct columnar_result_of<::sqlpp::result_row_t<Db, FieldSpecs...>> {
+			using type = columnar_result_t<FieldSpecs...>;
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_COLUMNAR_RESULT_H
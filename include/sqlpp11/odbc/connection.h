@@ -28,6 +28,7 @@
 #ifndef SQLPP11_ODBC_CONNECTION_H
 #define SQLPP11_ODBC_CONNECTION_H
 
+#include <chrono>
 #include <string>
 #include <sstream>
 #include <sqlpp11/connection.h>
@@ -35,9 +36,17 @@
 #include <sqlpp11/serialize.h>
 #include <sqlpp11/type_traits.h>
 #include <sqlpp11/odbc/prepared_statement.h>
+#include <sqlpp11/odbc/arrow.h>
 #include <sqlpp11/odbc/bind_result.h>
+#include <sqlpp11/odbc/binding_plan.h>
+#include <sqlpp11/odbc/columnar_result.h>
+#include <sqlpp11/odbc/pipelined_rowset.h>
 #include <sqlpp11/odbc/connection_config.h>
+#include <sqlpp11/odbc/exception.h>
+#include <sqlpp11/odbc/lazy_result.h>
 #include <sqlpp11/odbc/serializer.h>
+#include <sqlpp11/odbc/statement_statistics.h>
+#include <sqlpp11/odbc/stored_result.h>
 
 #ifdef _WIN32
 #  ifndef WIN32_LEAN_AND_MEAN
@@ -55,15 +64,35 @@ namespace sqlpp {
 	namespace odbc {
 		namespace detail {
 			struct connection_handle_t;
+			struct prepared_statement_handle_t;
+			struct running_state_t;
 		}
 		
+		template <typename Select, typename Column>
+		class in_list_lookup;
+		class temporary_keys_t;
+		struct csv_options;
+		struct csv_import_options;
+		struct csv_import_result;
+		
 		class connection : public sqlpp::connection
 		{
+			template <typename Select, typename Column>
+			friend class in_list_lookup;
+			friend class temporary_keys_t;
+			friend size_t export_csv(connection& db, const std::string& statement, int fd, const csv_options& options);
+			friend csv_import_result import_csv(connection& db, const std::string& table, const std::vector<column_info>& columns, const std::string& path, const csv_import_options& options);
+			
 			std::unique_ptr<detail::connection_handle_t> _handle;
-			bool _transaction_active = false;
+			//The running statement of _handle and of the handles reconnect() replaces it with, see cancel()
+			std::shared_ptr<detail::running_state_t> _running;
 			
 			// direct execution
 			bind_result_t select_impl(const std::string& statement);
+			rowset_t select_rowset_impl(const std::string& statement, const std::vector<column_kind>& kinds, const rowset_config& config);
+			rowset_config rowset_defaults(const rowset_config& config) const;
+			planned_result_t select_planned_impl(const std::string& statement, const detail::binding_plan_view_t& plan, size_t rows);
+			lazy_result_t select_lazy_impl(const std::string& statement, std::vector<column_info> columns);
 			size_t insert_impl(const std::string& statement);
 			size_t update_impl(const std::string& statement);
 			size_t remove_impl(const std::string& statement);
@@ -71,11 +100,20 @@ namespace sqlpp {
 			// prepared execution
 			prepared_statement_t prepare_impl(const std::string& statement);
 			bind_result_t run_prepared_select_impl(prepared_statement_t& prepared_statement);
+			planned_result_t run_planned_impl(prepared_statement_t& prepared_statement, const detail::binding_plan_view_t& plan, size_t rows);
+			rowset_t run_prepared_rowset_impl(prepared_statement_t& prepared_statement, const std::vector<column_kind>& kinds, const rowset_config& config);
 			size_t run_prepared_execute_impl(prepared_statement_t& prepared_statement);
 			size_t run_prepared_insert_impl(prepared_statement_t& prepared_statement);
 			size_t run_prepared_update_impl(prepared_statement_t& prepared_statement);
 			size_t run_prepared_remove_impl(prepared_statement_t& prepared_statement);
 			
+			// prepare and execute, reconnecting and trying once more after a link failure if auto_reconnect allows it
+			bool may_reconnect() const;
+			std::shared_ptr<detail::prepared_statement_handle_t> prepare_statement(const std::string& statement);
+			void execute_statement(detail::prepared_statement_handle_t& prepared);
+			SQLRETURN execute_statement_impl(detail::prepared_statement_handle_t& prepared);
+			size_t execute_impl(const std::string& statement);
+			
 		public:
 			using _prepared_statement_t = prepared_statement_t;
 			using _context_t = serializer_t;
@@ -114,6 +152,73 @@ namespace sqlpp {
 				return select_impl(context.str());
 			}
 			
+			//! select_rowset returns a result which is fetched block by block into column-wise buffers
+			template <typename Select>
+			rowset_t select_rowset(const Select& s, const rowset_config& config = rowset_config()) {
+				_context_t context(*this);
+				serialize(s, context);
+				return select_rowset_impl(context.str(), result_columns<typename Select::template _result_row_t<connection>>::kinds(), config);
+			}
+			
+			//! select_planned returns a result bound and decoded along a binding_plan of its row type
+			// Text values longer than TextLength bytes throw, rows are fetched statement_options::rowset_size at a time unless given.
+			template <size_t TextLength = 255, typename Select>
+			planned_result<typename Select::template _result_row_t<connection>, TextLength> select_planned(const Select& s, size_t rows = 0) {
+				_context_t context(*this);
+				serialize(s, context);
+				using row_t = typename Select::template _result_row_t<connection>;
+				return planned_result<row_t, TextLength>(select_planned_impl(context.str(), binding_plan<row_t, TextLength>::view(), rows));
+			}
+			
+			//! select_lazy returns a result which reads and converts a column only when it is accessed
+			template <typename Select>
+			lazy_result_t select_lazy(const Select& s) {
+				_context_t context(*this);
+				serialize(s, context);
+				return select_lazy_impl(context.str(), result_columns<typename Select::template _result_row_t<connection>>::get());
+			}
+			
+			//! select_lazy for plain SQL, the column types are taken from SQLDescribeCol
+			lazy_result_t select_lazy(const std::string& statement) {
+				return select_lazy_impl(statement, {});
+			}
+			
+			//! select_columnar returns the whole result as one contiguous vector per column, named like the selected columns
+			template <typename Select>
+			typename columnar_result_of<typename Select::template _result_row_t<connection>>::type select_columnar(const Select& s, const rowset_config& config = rowset_config()) {
+				typename columnar_result_of<typename Select::template _result_row_t<connection>>::type result;
+				pipelined_rowset_t rowset = select_pipelined(s, config);
+				while(const rowset_block_t* block = rowset.next()) {
+					result._append(*block);
+				}
+				return result;
+			}
+			
+			//! store fetches the whole result into client memory and releases the statement before it returns
+			// The result knows its exact size and can be indexed and iterated any number of times.
+			// Text values longer than config.max_text_length throw, as with select_rowset.
+			template <typename Select>
+			stored_result<typename Select::template _result_row_t<connection>> store(const Select& s, const rowset_config& config = rowset_config()) {
+				return stored_result<typename Select::template _result_row_t<connection>>(stored_result_t(select_rowset(s, config)));
+			}
+			
+			//! select_pipelined returns the blocks of a rowset, fetched ahead on a background thread if config.prefetch_blocks > 0
+			template <typename Select>
+			pipelined_rowset_t select_pipelined(const Select& s, const rowset_config& config = rowset_config()) {
+				return pipelined_rowset_t(select_rowset(s, config), config.prefetch_blocks);
+			}
+			
+			//! select_arrow streams the result as Arrow record batches, one per fetched block
+			template <
+				typename Select,
+				typename Enable = typename std::enable_if<not std::is_convertible<Select, std::string>::value, void>::type>
+			void select_arrow(const Select& s, ArrowArrayStream* out, const rowset_config& config = rowset_config()) {
+				export_arrow_stream(select_rowset(s, config), result_columns<typename Select::template _result_row_t<connection>>::get(), out, config.prefetch_blocks);
+			}
+			
+			//! select_arrow for plain SQL, the column types are taken from SQLDescribeCol
+			void select_arrow(const std::string& statement, ArrowArrayStream* out, const rowset_config& config = rowset_config());
+			
 			template <typename Select>
 			_prepared_statement_t prepare_select(Select& s) {
 				_context_t context(*this);
@@ -128,6 +233,17 @@ namespace sqlpp {
 				return run_prepared_select_impl(s._prepared_statement);
 			}
 			
+			//! run_planned executes a prepared select and decodes it like select_planned
+			// The columns stay bound to the prepared statement's buffer, so running it again costs SQLExecute and
+			// the fetches. Running it with db(...) in between unbinds them.
+			template <size_t TextLength = 255, typename PreparedSelect>
+			planned_result<typename PreparedSelect::_result_row_t, TextLength> run_planned(const PreparedSelect& s, size_t rows = 0) {
+				s._prepared_statement._reset();
+				s._bind_params();
+				using row_t = typename PreparedSelect::_result_row_t;
+				return planned_result<row_t, TextLength>(run_planned_impl(s._prepared_statement, binding_plan<row_t, TextLength>::view(), rows));
+			}
+			
 			//! insert returns the last auto_incremented id (or zero, if there is none)
 			template <typename Insert>
 			size_t insert(const Insert& i) {
@@ -223,6 +339,10 @@ namespace sqlpp {
 			//! escape given string (does not quote, though)
 			std::string escape(const std::string& s) const;
 			
+			//! options applied to statements prepared from now on (see scoped_statement_options for single statements)
+			const statement_options& get_statement_options() const;
+			void set_statement_options(const statement_options& options);
+			
 			//! call run on the argument
 			template <typename T>
 			auto _run(const T& t, const ::sqlpp::consistent_t&) -> decltype(t._run(*this)) {
@@ -254,16 +374,43 @@ namespace sqlpp {
 				return _prepare(t, sqlpp::prepare_check_t<_serializer_context_t, T>{});
 			}
 			
-			//! start transaction
+			//! start transaction, or a savepoint if one is open already (SAVEPOINT, SAVE TRANSACTION for T-SQL)
 			void start_transaction();
 			
-			//! commit transaction (or throw if the transaction has been finished already)
+			//! commit transaction or release the innermost savepoint (or throw if the transaction has been finished already)
 			void commit_transaction();
 			
-			//! rollback transaction with or without reporting the rollback (or throw if the transaction has been finished
-			// already)
+			//! rollback transaction or to the innermost savepoint with or without reporting the rollback (or throw if the
+			// transaction has been finished already)
 			void rollback_transaction(bool report);
 			
+			//! number of open transaction levels, 0 outside of transactions
+			size_t transaction_depth() const;
+			
+			//! the SQL dialect given in the connection_config
+			ODBC_Type type() const;
+			
+			//! whether the link to the server is up, asks the driver for SQL_ATTR_CONNECTION_DEAD or runs SELECT 1 if it doesn't know it
+			bool is_alive();
+			
+			//! connect again with the original configuration and prepare the statements of this connection on the new one,
+			// the open transaction, if any, is lost
+			void reconnect();
+			
+			//! stop the statement another thread is executing on this connection, which throws query_cancelled there.
+			// Returns false if none is running, also while the connection reconnects.
+			bool cancel();
+			
+			//! start counting executions, time and rows per statement fingerprint (replaces statistics kept before),
+			// the returned registry can be read from other threads
+			std::shared_ptr<statement_statistics_t> enable_statement_statistics(const statement_statistics_config& config = statement_statistics_config());
+			
+			//! stop counting, statistics handed out before stay readable
+			void disable_statement_statistics();
+			
+			//! the registry statements are counted in, nullptr if statistics are disabled
+			std::shared_ptr<statement_statistics_t> statement_statistics() const;
+			
 			//! report a rollback failure (will be called by transactions in case of a rollback failure in the destructor)
 			void report_rollback_failure(const std::string message) noexcept;
 			
@@ -272,9 +419,46 @@ namespace sqlpp {
 			size_t last_insert_id();
 		};
 		
+		//! Runs the statements of a scope with other statement_options, e.g. a timeout for one expensive query
+		class scoped_statement_options {
+			connection& _db;
+			statement_options _previous;
+			
+		public:
+			scoped_statement_options(connection& db, const statement_options& options)
+				: _db(db)
+				, _previous(db.get_statement_options())
+			{
+				_db.set_statement_options(options);
+			}
+			scoped_statement_options(const scoped_statement_options&) = delete;
+			scoped_statement_options& operator=(const scoped_statement_options&) = delete;
+			
+			~scoped_statement_options() {
+				_db.set_statement_options(_previous);
+			}
+		};
+		
+		//! Runs the statements of a scope with a deadline, they throw timeout_expired when it's exceeded (0 waits forever)
+		class scoped_query_timeout : public scoped_statement_options {
+			static statement_options with_timeout(statement_options options, std::chrono::seconds timeout) {
+				options.query_timeout = static_cast<size_t>(timeout.count());
+				return options;
+			}
+			
+		public:
+			scoped_query_timeout(connection& db, std::chrono::seconds timeout)
+				: scoped_statement_options(db, with_timeout(db.get_statement_options(), timeout))
+			{}
+		};
+		
 		inline std::string serializer_t::escape(std::string arg) {
 			return _db.escape(arg);
 		}
+		
+		inline ODBC_Type serializer_t::type() const {
+			return _db.type();
+		}
 	}
 }
 
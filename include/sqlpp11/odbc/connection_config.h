@@ -28,8 +28,11 @@
 #ifndef SQLPP11_ODBC_CONNECTION_CONFIG_H
 #define SQLPP11_ODBC_CONNECTION_CONFIG_H
 
+#include <cstdint>
 #include <string>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace sqlpp {
 	namespace odbc {
@@ -49,6 +52,55 @@ namespace sqlpp {
 			complete_required = 3
 		};
 
+		enum class cursor_type
+		{
+			driver_default,
+			forward_only,
+			static_cursor,
+			keyset_driven,
+			dynamic
+		};
+		
+		//! Statement attributes, set once whenever a statement handle is allocated.
+		// Values left at their defaults are not sent to the driver at all.
+		struct statement_options {
+			//SQL_ATTR_CURSOR_TYPE
+			cursor_type cursor = cursor_type::driver_default;
+			//SQL_ATTR_CONCURRENCY = SQL_CONCUR_READ_ONLY
+			bool read_only = false;
+			//SQL_ATTR_MAX_ROWS, 0 returns all rows
+			size_t max_rows = 0;
+			//SQL_ATTR_QUERY_TIMEOUT in seconds, 0 waits forever
+			size_t query_timeout = 0;
+			//SQL_ATTR_NOSCAN, sqlpp11 never generates ODBC escape sequences, so the driver needn't look for them
+			bool noscan = false;
+			//Rows per block for select_columnar, select_arrow, ... unless rowset_config::rows says otherwise
+			size_t rowset_size = 1024;
+			//Exchange text as UTF-16 (SQL_C_WCHAR) and convert it to/from UTF-8 in the connector,
+			//for drivers whose narrow character set isn't UTF-8 (e.g. SQL Server with NVARCHAR columns)
+			bool wide_text = false;
+			//Further integer valued statement attributes as (attribute, value), e.g. driver specific streaming hints
+			std::vector<std::pair<int32_t, uintptr_t>> attributes;
+		};
+		
+		inline bool operator==(const statement_options& a, const statement_options& b)
+		{
+			return
+				a.cursor == b.cursor &&
+				a.read_only == b.read_only &&
+				a.max_rows == b.max_rows &&
+				a.query_timeout == b.query_timeout &&
+				a.noscan == b.noscan &&
+				a.rowset_size == b.rowset_size &&
+				a.wide_text == b.wide_text &&
+				a.attributes == b.attributes;
+		}
+		
+		inline bool operator!=(const statement_options& a, const statement_options& b)
+		{
+			return !(a == b);
+		}
+
 		struct connection_config {
 			connection_config() : data_source_name(), username(), password(), type(ODBC_Type::TSQL), debug(false) {}
 			connection_config(const connection_config&) = default;
@@ -62,6 +114,12 @@ namespace sqlpp {
 			std::string password;
 			ODBC_Type type;
 			bool debug;
+			//Applied to every statement of the connection
+			statement_options statement;
+			//Keep autocommit off for the whole session, statements outside of transactions are committed with the next commit_transaction
+			bool manual_commit = false;
+			//After a communication link failure (SQLSTATE 08xxx) outside of a transaction, reconnect and run the statement once more
+			bool auto_reconnect = false;
 		};
 
 		inline bool operator==(const connection_config& a, const connection_config& b)
@@ -71,7 +129,10 @@ namespace sqlpp {
 				a.username == b.username &&
 				a.password == b.password &&
 				a.type == b.type &&
-				a.debug == b.debug;
+				a.debug == b.debug &&
+				a.statement == b.statement &&
+				a.manual_commit == b.manual_commit &&
+				a.auto_reconnect == b.auto_reconnect;
 		}
 
 		inline bool operator!=(const connection_config& a, const connection_config& b)
@@ -89,6 +150,12 @@ namespace sqlpp {
 			driver_completion completion;
  			ODBC_Type type;
  			bool debug;
+			//Applied to every statement of the connection
+			statement_options statement;
+			//Keep autocommit off for the whole session, statements outside of transactions are committed with the next commit_transaction
+			bool manual_commit = false;
+			//After a communication link failure (SQLSTATE 08xxx) outside of a transaction, reconnect and run the statement once more
+			bool auto_reconnect = false;
  		};
 
 		inline bool operator==(const driver_connection_config& a, const driver_connection_config& b)
@@ -98,7 +165,10 @@ namespace sqlpp {
 				a.window == b.window &&
 				a.completion == b.completion &&
 				a.type == b.type &&
-				a.debug == b.debug;
+				a.debug == b.debug &&
+				a.statement == b.statement &&
+				a.manual_commit == b.manual_commit &&
+				a.auto_reconnect == b.auto_reconnect;
 		}
 
 		inline bool operator!=(const driver_connection_config& a, const driver_connection_config& b)
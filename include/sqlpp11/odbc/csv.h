@@ -0,0 +1,164 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_CSV_H
+#define SQLPP11_ODBC_CSV_H
+
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <sqlpp11/odbc/connection.h>
+#include <sqlpp11/odbc/result_columns.h>
+#include <sqlpp11/odbc/rowset.h>
+
+namespace sqlpp {
+	namespace odbc {
+		struct csv_options {
+			//'\t' for TSV
+			char delimiter = ',';
+			char quote = '"';
+			//Written unquoted for NULL, empty text is written quoted so the two stay apart
+			std::string null_value;
+			//A first line with the column names
+			bool header = true;
+			//"\r\n" for RFC 4180
+			std::string line_end = "\n";
+			//Bytes formatted before they are written, the memory used doesn't grow with the result
+			size_t buffer_size = 1 << 20;
+			//Fetching, including prefetch_blocks to format one block while the next is fetched
+			rowset_config rowset;
+		};
+		
+		//! Writes the rows of a rowset to fd as CSV, returns the rows written.
+		// Values are formatted straight from the fetched blocks: booleans as 1 and 0, dates as YYYY-MM-DD, timestamps
+		// as YYYY-MM-DD HH:MM:SS with .ffffff if there's a fraction, and doubles with the fewest digits that read back
+		// the same. Text is quoted if it holds the delimiter, the quote or a line break, quotes are doubled.
+		// fd is neither closed nor synced.
+		size_t export_csv(rowset_t rowset, const std::vector<column_info>& columns, int fd, const csv_options& options = csv_options());
+		
+		//! export_csv for plain SQL, the column types are taken from SQLDescribeCol
+		size_t export_csv(connection& db, const std::string& statement, int fd, const csv_options& options = csv_options());
+		
+		template <
+			typename Select,
+			typename Enable = typename std::enable_if<not std::is_convertible<Select, std::string>::value, void>::type>
+		size_t export_csv(connection& db, const Select& s, int fd, const csv_options& options = csv_options()) {
+			return export_csv(db.select_rowset(s, options.rowset), result_columns<typename Select::template _result_row_t<connection>>::get(), fd, options);
+		}
+		
+		namespace detail {
+			//! Opens path for writing, created or truncated, and closes it again
+			class csv_file_t {
+				int _fd;
+				
+			public:
+				explicit csv_file_t(const std::string& path);
+				csv_file_t(const csv_file_t&) = delete;
+				csv_file_t& operator=(const csv_file_t&) = delete;
+				~csv_file_t();
+				
+				int fd() const {
+					return _fd;
+				}
+				
+				//! Closes the file, reporting what close() reports
+				void close();
+			};
+		}
+		
+		//! export_csv into the file at path, which is replaced
+		template <typename Query>
+		size_t export_csv(connection& db, const Query& query, const std::string& path, const csv_options& options = csv_options()) {
+			detail::csv_file_t file(path);
+			const size_t rows = export_csv(db, query, file.fd(), options);
+			file.close();
+			return rows;
+		}
+		
+		struct csv_import_options {
+			//'\t' for TSV
+			char delimiter = ',';
+			char quote = '"';
+			//Unquoted fields equal to it are NULL, quoted ones never are
+			std::string null_value;
+			//The first line names the columns, any of the table's in any order; without it rows hold all of them in order
+			bool header = true;
+			//Rows per SQLExecute, sent as column-wise parameter arrays (one by one if the driver doesn't take arrays)
+			size_t batch_size = 1000;
+			//Rows that may be rejected before import_csv throws, they are listed in the result
+			size_t max_errors = 0;
+			//Parses the next batch while the current one executes on a second thread
+			bool pipeline = true;
+		};
+		
+		struct csv_row_error {
+			//Line the row starts on, 1-based
+			size_t line;
+			std::string message;
+		};
+		
+		struct csv_import_result {
+			//Rows inserted
+			size_t rows = 0;
+			//Rows rejected by the parser or the database, by line
+			std::vector<csv_row_error> errors;
+		};
+		
+		//! Inserts the rows of the CSV file at path into table, whose columns are given.
+		// The file is memory mapped and parsed straight into column-wise parameter arrays of a prepared INSERT,
+		// batch_size rows at a time. Values are read as export_csv writes them: integers, doubles, 1/0 or true/false,
+		// YYYY-MM-DD and YYYY-MM-DD HH:MM:SS[.ffffff] (or with a T). Rows that don't parse or that the database
+		// rejects are skipped and reported, until there are more than max_errors. Rows inserted before a throw stay
+		// inserted, run the import in a transaction to get all or nothing.
+		csv_import_result import_csv(connection& db, const std::string& table, const std::vector<column_info>& columns, const std::string& path, const csv_import_options& options = csv_import_options());
+		
+		namespace detail {
+			template <typename ColumnTuple>
+			struct table_columns;
+			
+			template <typename... Columns>
+			struct table_columns<std::tuple<Columns...>> {
+				static std::vector<column_info> get() {
+					return {column_info{
+						name_of<Columns>::char_ptr(),
+						column_kind_of<value_type_of<Columns>>::value,
+						can_be_null_t<Columns>::value,
+						0,
+						0}...};
+				}
+			};
+		}
+		
+		//! import_csv into a sqlpp11 table
+		template <typename Table>
+		csv_import_result import_csv(connection& db, const Table& /*table*/, const std::string& path, const csv_import_options& options = csv_import_options()) {
+			return import_csv(db, name_of<Table>::char_ptr(), detail::table_columns<typename Table::_column_tuple_t>::get(), path, options);
+		}
+	}
+}
+
+#endif //SQLPP11_ODBC_CSV_H
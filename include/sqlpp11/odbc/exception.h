@@ -0,0 +1,54 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_EXCEPTION_H
+#define SQLPP11_ODBC_EXCEPTION_H
+
+#include <sqlpp11/exception.h>
+
+namespace sqlpp {
+	namespace odbc {
+		//! Thrown when the link to the server failed (SQLSTATE class 08), the connection has to be reconnected before it can be used again
+		class connection_lost : public sqlpp::exception {
+		public:
+			using sqlpp::exception::exception;
+		};
+		
+		//! Thrown when SQL_ATTR_QUERY_TIMEOUT (statement_options::query_timeout) expired, SQLSTATE HYT00 or HYT01
+		class timeout_expired : public sqlpp::exception {
+		public:
+			using sqlpp::exception::exception;
+		};
+		
+		//! Thrown by the statement stopped with connection::cancel or bind_result_t::cancel, SQLSTATE HY008
+		class query_cancelled : public sqlpp::exception {
+		public:
+			using sqlpp::exception::exception;
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_EXCEPTION_H
@@ -0,0 +1,159 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_IN_LIST_H
+#define SQLPP11_ODBC_IN_LIST_H
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sqlpp11/verbatim.h>
+#include <sqlpp11/odbc/connection.h>
+
+namespace sqlpp {
+	namespace odbc {
+		struct in_list_config {
+			//Key counts a statement is prepared for, ascending. Lookups are padded to the next one by repeating
+			// their last key, more keys than the largest one are looked up in chunks of it.
+			std::vector<size_t> buckets = {1, 8, 32, 128, 512};
+			//Fetching the rows of each chunk
+			rowset_config rowset;
+		};
+		
+		namespace detail {
+			//! Index of the smallest bucket holding keys, or of the largest one
+			size_t in_list_bucket(const std::vector<size_t>& buckets, size_t keys);
+			//! Throws if buckets is empty, not ascending or holds a 0
+			void check_in_list_config(const in_list_config& config);
+			//! "column IN (?,?,...)" with arity markers
+			std::string in_list_condition(const std::string& column, size_t arity);
+			
+			inline void bind_in_list_key(prepared_statement_t& prepared, size_t index, const int64_t& key) {
+				prepared._bind_integral_parameter(index, &key, false);
+			}
+			inline void bind_in_list_key(prepared_statement_t& prepared, size_t index, const double& key) {
+				prepared._bind_floating_point_parameter(index, &key, false);
+			}
+			inline void bind_in_list_key(prepared_statement_t& prepared, size_t index, const std::string& key) {
+				prepared._bind_text_parameter(index, &key, false);
+			}
+			inline void bind_in_list_key(prepared_statement_t& prepared, size_t index, const ::sqlpp::chrono::day_point& key) {
+				prepared._bind_date_parameter(index, &key, false);
+			}
+		}
+		
+		//! Looks up the rows of a select by many keys with `column IN (?,...)`, padded to a few fixed arities.
+		// Every key count of a bucket runs the same statement text, so each bucket is prepared once on the client
+		// and planned once by the server, however many differently sized lookups run. The select must not have
+		// a where clause. Rows of all chunks are returned in one stored result, in no particular order; keys
+		// given more than once don't repeat their rows within a chunk.
+		template <typename Select, typename Column>
+		class in_list_lookup {
+		public:
+			using _statement_t = decltype(std::declval<const Select&>().where(::sqlpp::verbatim<::sqlpp::boolean>(std::string())));
+			using _result_row_t = typename _statement_t::template _result_row_t<connection>;
+			using _key_t = typename value_type_of<Column>::_cpp_value_type;
+			
+		private:
+			connection& _db;
+			Select _select;
+			Column _column;
+			in_list_config _config;
+			//One per bucket, prepared when it's first needed
+			std::vector<prepared_statement_t> _statements;
+			size_t _prepared = 0;
+			
+			prepared_statement_t& statement(size_t bucket) {
+				prepared_statement_t& prepared = _statements[bucket];
+				if(!prepared) {
+					serializer_t column(_db);
+					serialize(_column, column);
+					serializer_t context(_db);
+					serialize(_select.where(::sqlpp::verbatim<::sqlpp::boolean>(detail::in_list_condition(column.str(), _config.buckets[bucket]))), context);
+					prepared = _db.prepare_impl(context.str());
+					++_prepared;
+				}
+				return prepared;
+			}
+			
+		public:
+			in_list_lookup(connection& db, Select select, Column column, in_list_config config = in_list_config())
+				: _db(db)
+				, _select(std::move(select))
+				, _column(std::move(column))
+				, _config(std::move(config))
+			{
+				detail::check_in_list_config(_config);
+				_statements.resize(_config.buckets.size());
+			}
+			in_list_lookup(const in_list_lookup&) = delete;
+			in_list_lookup(in_list_lookup&&) = default;
+			in_list_lookup& operator=(const in_list_lookup&) = delete;
+			
+			stored_result<_result_row_t> operator()(const std::vector<_key_t>& keys) {
+				stored_result_t rows(result_columns<_result_row_t>::kinds());
+				each_block(keys, [&rows](const rowset_block_t& block) {
+					rows.append(block);
+				});
+				return stored_result<_result_row_t>(std::move(rows));
+			}
+			
+			//! Runs the lookup and hands every fetched block of rows to callback, before the next one is fetched
+			template <typename Callback>
+			void each_block(const std::vector<_key_t>& keys, Callback&& callback) {
+				const auto kinds = result_columns<_result_row_t>::kinds();
+				for(size_t offset = 0; offset < keys.size();) {
+					const size_t bucket = detail::in_list_bucket(_config.buckets, keys.size() - offset);
+					const size_t arity = _config.buckets[bucket];
+					const size_t count = std::min(arity, keys.size() - offset);
+					prepared_statement_t& prepared = statement(bucket);
+					prepared._reset();
+					for(size_t i = 0; i < arity; ++i) {
+						detail::bind_in_list_key(prepared, i, keys[offset + std::min(i, count - 1)]);
+					}
+					rowset_t rowset = _db.run_prepared_rowset_impl(prepared, kinds, _config.rowset);
+					while(rowset.fetch()) {
+						callback(static_cast<const rowset_block_t&>(rowset));
+					}
+					offset += count;
+				}
+			}
+			
+			//! Statements prepared so far, at most one per bucket
+			size_t prepared() const {
+				return _prepared;
+			}
+		};
+		
+		template <typename Select, typename Column>
+		in_list_lookup<Select, Column> make_in_list_lookup(connection& db, const Select& select, const Column& column, const in_list_config& config = in_list_config()) {
+			return in_list_lookup<Select, Column>(db, select, column, config);
+		}
+	}
+}
+
+#endif //SQLPP11_ODBC_IN_LIST_H
@@ -28,19 +28,35 @@
 #ifndef SQLPP11_ODBC_INSERT_OR_H
 #define SQLPP11_ODBC_INSERT_OR_H
 
+#include <string>
+#include <tuple>
+#include <vector>
 #include <sqlpp11/statement.h>
 #include <sqlpp11/type_traits.h>
 #include <sqlpp11/parameter_list.h>
 #include <sqlpp11/prepared_insert.h>
 #include <sqlpp11/default_value.h>
+#include <sqlpp11/logic.h>
 #include <sqlpp11/noop.h>
 #include <sqlpp11/into.h>
 #include <sqlpp11/insert_value_list.h>
+#include <sqlpp11/odbc/serializer.h>
 
 namespace sqlpp {
 	namespace odbc {
-		struct insert_or_replace_name_t {};
-		struct insert_or_ignore_name_t {};
+		struct insert_or_replace_name_t {
+			static constexpr bool _replace = true;
+		};
+		struct insert_or_ignore_name_t {
+			static constexpr bool _replace = false;
+		};
+
+		namespace detail {
+			//! Rewrites the INSERT serialized since context._statement_begin into the upsert of the connection's dialect:
+			// INSERT OR REPLACE/IGNORE or ON CONFLICT on SQLite, ON CONFLICT on PostgreSQL, ON DUPLICATE KEY UPDATE on MySQL
+			// and MERGE on TSQL. keys are the columns of the unique key the conflict is detected on, if given.
+			void serialize_insert_or(serializer_t& context, bool replace, const std::vector<std::string>& keys);
+		}
 
 		template <typename InsertOrAlternative>
 		struct insert_or_t : public statement_name_t<InsertOrAlternative> {
@@ -70,9 +86,108 @@ namespace sqlpp {
 			};
 		};
 
+		template <typename InsertOrAlternative, typename... Keys>
+		struct on_conflict_data_t {
+			on_conflict_data_t(Keys... keys) : _keys(keys...) {}
+
+			on_conflict_data_t(const on_conflict_data_t&) = default;
+			on_conflict_data_t(on_conflict_data_t&&) = default;
+			on_conflict_data_t& operator=(const on_conflict_data_t&) = default;
+			on_conflict_data_t& operator=(on_conflict_data_t&&) = default;
+			~on_conflict_data_t() = default;
+
+			std::tuple<Keys...> _keys;
+		};
+
+		//! The columns of the unique key a conflict is detected on, PostgreSQL and TSQL need them to replace and TSQL to ignore
+		template <typename InsertOrAlternative, typename... Keys>
+		struct on_conflict_t {
+			using _traits = make_traits<no_value_t>;
+			using _nodes = sqlpp::detail::type_vector<>;
+
+			using _data_t = on_conflict_data_t<InsertOrAlternative, Keys...>;
+
+			template <typename Policies>
+			struct _impl_t {
+				_impl_t() = default;
+				_impl_t(const _data_t& data) : _data(data) {}
+
+				_data_t _data;
+			};
+
+			template <typename Policies>
+			struct _base_t {
+				using _data_t = on_conflict_data_t<InsertOrAlternative, Keys...>;
+
+				template <typename... Args>
+				_base_t(Args&&... args) : on_conflict{std::forward<Args>(args)...} {}
+
+				_impl_t<Policies> on_conflict;
+				_impl_t<Policies>& operator()() { return on_conflict; }
+				const _impl_t<Policies>& operator()() const { return on_conflict; }
+
+				template <typename T>
+				static auto _get_member(T t) -> decltype(t.on_conflict) {
+					return t.on_conflict;
+				}
+
+				using _consistency_check = consistent_t;
+			};
+		};
+
+		template <typename InsertOrAlternative>
+		struct no_on_conflict_data_t {};
+
+		template <typename InsertOrAlternative>
+		struct no_on_conflict_t {
+			using _traits = make_traits<no_value_t, tag::is_noop>;
+			using _nodes = sqlpp::detail::type_vector<>;
+
+			using _data_t = no_on_conflict_data_t<InsertOrAlternative>;
+
+			template <typename Policies>
+			struct _impl_t {
+				_impl_t() = default;
+				_impl_t(const _data_t& data) : _data(data) {}
+
+				_data_t _data;
+			};
+
+			template <typename Policies>
+			struct _base_t {
+				using _data_t = no_on_conflict_data_t<InsertOrAlternative>;
+
+				template <typename... Args>
+				_base_t(Args&&... args) : no_on_conflict{std::forward<Args>(args)...} {}
+
+				_impl_t<Policies> no_on_conflict;
+				_impl_t<Policies>& operator()() { return no_on_conflict; }
+				const _impl_t<Policies>& operator()() const { return no_on_conflict; }
+
+				template <typename T>
+				static auto _get_member(T t) -> decltype(t.no_on_conflict) {
+					return t.no_on_conflict;
+				}
+
+				template <typename Check, typename T>
+				using _new_statement_t = new_statement_t<Check, Policies, no_on_conflict_t, T>;
+
+				using _consistency_check = consistent_t;
+
+				template <typename... Keys>
+				auto on_conflict(Keys... keys) const
+					-> _new_statement_t<consistent_t, on_conflict_t<InsertOrAlternative, Keys...>> {
+					static_assert(sizeof...(Keys) > 0, "at least one column is required in on_conflict()");
+					static_assert(logic::all_t<is_column_t<Keys>::value...>::value, "only columns are allowed in on_conflict()");
+					return {static_cast<const derived_statement_t<Policies>&>(*this),
+						on_conflict_data_t<InsertOrAlternative, Keys...>{keys...}};
+				}
+			};
+		};
+
 		template <typename Database, typename InsertOrAlternative>
 		using blank_insert_or_t =
-			statement_t<Database, insert_or_t<InsertOrAlternative>, no_into_t, no_insert_value_list_t>;
+			statement_t<Database, insert_or_t<InsertOrAlternative>, no_into_t, no_insert_value_list_t, no_on_conflict_t<InsertOrAlternative>>;
 
 		template <typename Database>
 		using blank_insert_or_replace_t = blank_insert_or_t<Database, insert_or_replace_name_t>;
@@ -121,25 +236,49 @@ namespace sqlpp {
 		}
 	}
 
-	template <typename Context>
-	struct serializer_t<Context, odbc::insert_or_replace_name_t> {
+	//Which keywords follow INSERT depends on the dialect and the on_conflict clause, see odbc::detail::serialize_insert_or
+	template <>
+	struct serializer_t<odbc::serializer_t, odbc::insert_or_replace_name_t> {
 		using _serialize_check = consistent_t;
 		using T = odbc::insert_or_replace_name_t;
 
-		static Context& _(const T& t, Context& context) {
-			context << "INSERT OR REPLACE ";
+		static odbc::serializer_t& _(const T& t, odbc::serializer_t& context) {
+			context._statement_begin = context.str().size();
+			context << "INSERT";
 			return context;
 		}
 	};
 
-	template <typename Context>
-	struct serializer_t<Context, odbc::insert_or_ignore_name_t>
-	{
+	template <>
+	struct serializer_t<odbc::serializer_t, odbc::insert_or_ignore_name_t> {
 		using _serialize_check = consistent_t;
 		using T = odbc::insert_or_ignore_name_t;
 
-		static Context& _(const T& t, Context& context) {
-			context << "INSERT OR IGNORE ";
+		static odbc::serializer_t& _(const T& t, odbc::serializer_t& context) {
+			context._statement_begin = context.str().size();
+			context << "INSERT";
+			return context;
+		}
+	};
+
+	template <typename InsertOrAlternative>
+	struct serializer_t<odbc::serializer_t, odbc::no_on_conflict_data_t<InsertOrAlternative>> {
+		using _serialize_check = consistent_t;
+		using T = odbc::no_on_conflict_data_t<InsertOrAlternative>;
+
+		static odbc::serializer_t& _(const T& t, odbc::serializer_t& context) {
+			odbc::detail::serialize_insert_or(context, InsertOrAlternative::_replace, {});
+			return context;
+		}
+	};
+
+	template <typename InsertOrAlternative, typename... Keys>
+	struct serializer_t<odbc::serializer_t, odbc::on_conflict_data_t<InsertOrAlternative, Keys...>> {
+		using _serialize_check = consistent_t;
+		using T = odbc::on_conflict_data_t<InsertOrAlternative, Keys...>;
+
+		static odbc::serializer_t& _(const T& t, odbc::serializer_t& context) {
+			odbc::detail::serialize_insert_or(context, InsertOrAlternative::_replace, {name_of<Keys>::char_ptr()...});
 			return context;
 		}
 	};
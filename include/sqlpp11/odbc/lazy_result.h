@@ -0,0 +1,140 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_LAZY_RESULT_H
+#define SQLPP11_ODBC_LAZY_RESULT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sqlpp11/data_types/day_point.h>
+#include <sqlpp11/data_types/time_point.h>
+#include <sqlpp11/data_types/time_of_day.h>
+#include <sqlpp11/odbc/bind_result.h>
+#include <sqlpp11/odbc/numeric.h>
+#include <sqlpp11/odbc/result_columns.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sqlext.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			struct prepared_statement_handle_t;
+		}
+		
+		//! A result whose columns are fetched and converted only when they are read
+		// Fixed width columns are bound with SQLBindCol, so SQLFetch fills them without further calls.
+		// The others are read with SQLGetData on first access and kept until the next row. Unless the
+		// driver reports SQL_GD_ANY_COLUMN, only the fixed width columns in front of the first text column
+		// are bound, and unless it reports SQL_GD_ANY_ORDER, unbound columns have to be read in increasing
+		// order (reading one again is fine, going back to one that was skipped throws).
+		class lazy_result_t {
+			struct column_t {
+				column_kind kind;
+				std::string name;
+				bool bound;
+				//Read for the current row, bound columns are read by SQLFetch
+				bool read;
+				SQLLEN indicator;
+				//Fixed width values as the driver wrote them
+				union {
+					SQLBIGINT integral;
+					SQLDOUBLE floating_point;
+					SQLCHAR boolean;
+					SQL_DATE_STRUCT date;
+					SQL_TIMESTAMP_STRUCT timestamp;
+					SQL_TIME_STRUCT time;
+				} value;
+				const char* text;
+				size_t length;
+				numeric_t numeric;
+			};
+			
+			std::shared_ptr<detail::prepared_statement_handle_t> _handle;
+			//Does the SQLGetData calls and conversions
+			bind_result_t _result;
+			//Never resized after construction, the driver writes into the bound values
+			std::vector<column_t> _columns;
+			bool _any_order = false;
+			//Last column read with SQLGetData (1-based), 0 if none
+			size_t _position = 0;
+			bool _on_row = false;
+			
+			//! Reads the column for the current row if that hasn't happened yet
+			column_t& column(size_t index);
+			column_t& column(size_t index, column_kind kind);
+			
+		public:
+			lazy_result_t() = default;
+			//! getdata_extensions as reported by SQLGetInfo(SQL_GETDATA_EXTENSIONS)
+			lazy_result_t(const std::shared_ptr<detail::prepared_statement_handle_t>& handle, const std::vector<column_info>& columns, SQLUINTEGER getdata_extensions);
+			lazy_result_t(const lazy_result_t&) = delete;
+			lazy_result_t(lazy_result_t&&) = default;
+			lazy_result_t& operator=(const lazy_result_t&) = delete;
+			lazy_result_t& operator=(lazy_result_t&&) = default;
+			~lazy_result_t();
+			
+			//! Moves to the next row, returns false at the end of the result
+			bool next();
+			
+			size_t column_count() const {
+				return _columns.size();
+			}
+			
+			//! 0-based index of the column with that name (or alias), throws if there is none
+			size_t index(const std::string& name) const;
+			
+			bool is_bound(size_t index) const {
+				return _columns[index].bound;
+			}
+			
+			bool is_null(size_t index);
+			int64_t integral(size_t index);
+			double floating_point(size_t index);
+			bool boolean(size_t index);
+			//! Valid until the next row
+			const char* text(size_t index, size_t* length);
+			std::string text(size_t index);
+			::sqlpp::day_point::_cpp_value_type date(size_t index);
+			::sqlpp::time_point::_cpp_value_type date_time(size_t index);
+			::sqlpp::time_of_day::_cpp_value_type time_of_day(size_t index);
+			numeric_t numeric(size_t index);
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_LAZY_RESULT_H
@@ -0,0 +1,151 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_NUMERIC_H
+#define SQLPP11_ODBC_NUMERIC_H
+
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sqlext.h>
+
+namespace sqlpp {
+	namespace odbc {
+		//! Exact DECIMAL/NUMERIC value: a 128 bit unscaled magnitude, a sign, a precision (digits) and a scale (digits after the point).
+		// The magnitude is kept as two 64 bit halves, SQL_NUMERIC_STRUCT holds it as 16 little endian bytes in val,
+		// which the conversions pack and unpack byte by byte. A negative scale of the struct is folded into the magnitude.
+		// Values exceeding max_precision digits and malformed text throw sqlpp::exception.
+		class numeric_t {
+			uint64_t _low = 0;
+			uint64_t _high = 0;
+			bool _negative = false;
+			uint8_t _precision = 38;
+			uint8_t _scale = 0;
+			
+			//Throws if the value has more than precision digits, widen raises the precision up to max_precision instead
+			void fit(bool widen);
+			
+		public:
+			static constexpr uint8_t max_precision = 38;
+			
+			numeric_t() = default;
+			//! unscaled * 10^-scale, e.g. numeric_t(12345, 2) is 123.45
+			explicit numeric_t(int64_t unscaled, uint8_t scale = 0, uint8_t precision = max_precision);
+			explicit numeric_t(const SQL_NUMERIC_STRUCT& value);
+			
+			//! Parses [+-]digits[.digits], the scale is the number of digits after the point
+			static numeric_t from_string(const std::string& text);
+			//! Parses [+-]digits[.digits], rounding half away from zero to scale digits after the point
+			static numeric_t from_string(const std::string& text, uint8_t scale, uint8_t precision = max_precision);
+			//! Nearest value with scale digits after the point, ties away from zero
+			static numeric_t from_double(double value, uint8_t scale, uint8_t precision = max_precision);
+			
+			std::string to_string() const;
+			double to_double() const;
+			SQL_NUMERIC_STRUCT to_struct() const;
+			
+			//! The same value with another scale, rounded half away from zero when digits are dropped
+			numeric_t rescale(uint8_t scale) const;
+			
+			uint8_t precision() const {
+				return _precision;
+			}
+			
+			uint8_t scale() const {
+				return _scale;
+			}
+			
+			bool is_negative() const {
+				return _negative;
+			}
+			
+			bool is_zero() const {
+				return !_low && !_high;
+			}
+			
+			//! Low and high 64 bits of the unscaled magnitude
+			uint64_t low() const {
+				return _low;
+			}
+			
+			uint64_t high() const {
+				return _high;
+			}
+			
+			//! Sums are exact, the result has the larger scale of both operands
+			numeric_t& operator+=(const numeric_t& rhs);
+			numeric_t& operator-=(const numeric_t& rhs);
+			numeric_t operator-() const;
+			
+			//! Compares values, not representations: 1.50 == 1.5
+			int compare(const numeric_t& rhs) const;
+		};
+		
+		inline numeric_t operator+(numeric_t lhs, const numeric_t& rhs) {
+			return lhs += rhs;
+		}
+		
+		inline numeric_t operator-(numeric_t lhs, const numeric_t& rhs) {
+			return lhs -= rhs;
+		}
+		
+		inline bool operator==(const numeric_t& lhs, const numeric_t& rhs) {
+			return lhs.compare(rhs) == 0;
+		}
+		
+		inline bool operator!=(const numeric_t& lhs, const numeric_t& rhs) {
+			return lhs.compare(rhs) != 0;
+		}
+		
+		inline bool operator<(const numeric_t& lhs, const numeric_t& rhs) {
+			return lhs.compare(rhs) < 0;
+		}
+		
+		inline bool operator>(const numeric_t& lhs, const numeric_t& rhs) {
+			return lhs.compare(rhs) > 0;
+		}
+		
+		inline bool operator<=(const numeric_t& lhs, const numeric_t& rhs) {
+			return lhs.compare(rhs) <= 0;
+		}
+		
+		inline bool operator>=(const numeric_t& lhs, const numeric_t& rhs) {
+			return lhs.compare(rhs) >= 0;
+		}
+	}
+}
+
+#endif //SQLPP11_ODBC_NUMERIC_H
@@ -29,7 +29,19 @@
 #define SQLPP11_ODBC_ODBC_H
 
 #include <sqlpp11/odbc/connection.h>
+#include <sqlpp11/odbc/batched_writer.h>
+#include <sqlpp11/odbc/binding_plan.h>
+#include <sqlpp11/odbc/csv.h>
+#include <sqlpp11/odbc/exception.h>
+#include <sqlpp11/odbc/in_list.h>
+#include <sqlpp11/odbc/coalescing_lookup.h>
+#include <sqlpp11/odbc/temporary_keys.h>
 #include <sqlpp11/odbc/insert_or.h>
+#include <sqlpp11/odbc/lazy_result.h>
+#include <sqlpp11/odbc/stored_result.h>
+#include <sqlpp11/odbc/statement_statistics.h>
+#include <sqlpp11/odbc/thread_local_connection.h>
+#include <sqlpp11/odbc/transcode.h>
 #include <sqlpp11/data_types.h>
 
 #endif //SQLPP11_ODBC_ODBC_H
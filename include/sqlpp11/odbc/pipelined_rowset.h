@@ -0,0 +1,61 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_PIPELINED_ROWSET_H
+#define SQLPP11_ODBC_PIPELINED_ROWSET_H
+
+#include <memory>
+#include <sqlpp11/odbc/rowset.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			struct pipeline_t;
+		}
+		
+		//! Hands out the blocks of a rowset, optionally fetched ahead on a background thread.
+		// With prefetch_blocks > 0 the driver fills up to that many blocks while the caller works on the current one,
+		// so network and driver latency overlap with decoding. With 0 every block is fetched by next() itself.
+		class pipelined_rowset_t {
+			std::unique_ptr<detail::pipeline_t> _pipeline;
+			
+		public:
+			pipelined_rowset_t(rowset_t rowset, size_t prefetch_blocks);
+			pipelined_rowset_t(const pipelined_rowset_t&) = delete;
+			pipelined_rowset_t(pipelined_rowset_t&& rhs);
+			pipelined_rowset_t& operator=(const pipelined_rowset_t&) = delete;
+			pipelined_rowset_t& operator=(pipelined_rowset_t&& rhs);
+			//! Stops fetching ahead and waits for a fetch in progress
+			~pipelined_rowset_t();
+			
+			//! The next block or nullptr at the end of the result. A block stays valid until the next call.
+			// Errors of the background thread are rethrown here.
+			rowset_block_t* next();
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_PIPELINED_ROWSET_H
@@ -46,6 +46,7 @@
 namespace sqlpp {
 	namespace odbc {
 		class connection;
+		class numeric_t;
 		
 		namespace detail {
 			struct prepared_statement_handle_t;
@@ -66,6 +67,11 @@ namespace sqlpp {
 			
 			SQLHSTMT native_handle();
 			
+			//! false for a default constructed statement
+			explicit operator bool() const {
+				return static_cast<bool>(_handle);
+			}
+			
 			bool operator==(const prepared_statement_t& rhs) const {
 				return _handle == rhs._handle;
 			}
@@ -78,6 +84,7 @@ namespace sqlpp {
 			void _bind_date_time_parameter(size_t index, const ::sqlpp::chrono::microsecond_point* value, bool is_null);
 			void _bind_time_parameter(size_t index, const ::sqlpp::chrono::microsecond_point* value, bool is_null);
 			void _bind_timestamp_parameter(size_t index, const SQL_TIMESTAMP_STRUCT* value, bool is_null);
+			void _bind_numeric_parameter(size_t index, const numeric_t* value, bool is_null);
 			
 		};
 		
@@ -0,0 +1,107 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_RESULT_COLUMNS_H
+#define SQLPP11_ODBC_RESULT_COLUMNS_H
+
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sqlpp11/data_types.h>
+#include <sqlpp11/result_row.h>
+#include <sqlpp11/type_traits.h>
+
+namespace sqlpp {
+	namespace odbc {
+		//! How a result column is fetched and stored
+		enum class column_kind {
+			integral,
+			floating_point,
+			boolean,
+			text,
+			date,
+			date_time,
+			time_of_day,
+			//DECIMAL/NUMERIC with digits after the point or more than 18 digits, fetched exactly as numeric_t
+			numeric
+		};
+		
+		struct column_info {
+			std::string name;
+			column_kind kind;
+			bool can_be_null;
+			//Digits and digits after the point of numeric columns
+			unsigned precision;
+			unsigned scale;
+		};
+		
+		namespace detail {
+			template <typename ValueType>
+			struct column_kind_of {
+				static_assert(wrong_t<ValueType>::value, "ODBC error: unsupported value type in result column");
+			};
+			template <>
+			struct column_kind_of<::sqlpp::integral> : std::integral_constant<column_kind, column_kind::integral> {};
+			template <>
+			struct column_kind_of<::sqlpp::floating_point> : std::integral_constant<column_kind, column_kind::floating_point> {};
+			template <>
+			struct column_kind_of<::sqlpp::boolean> : std::integral_constant<column_kind, column_kind::boolean> {};
+			template <>
+			struct column_kind_of<::sqlpp::text> : std::integral_constant<column_kind, column_kind::text> {};
+			template <>
+			struct column_kind_of<::sqlpp::day_point> : std::integral_constant<column_kind, column_kind::date> {};
+			template <>
+			struct column_kind_of<::sqlpp::time_point> : std::integral_constant<column_kind, column_kind::date_time> {};
+			template <>
+			struct column_kind_of<::sqlpp::time_of_day> : std::integral_constant<column_kind, column_kind::time_of_day> {};
+			
+			template <typename FieldSpec>
+			using field_kind = column_kind_of<value_type_of<FieldSpec>>;
+		}
+		
+		//! Names and kinds of the columns of a result row, e.g. result_columns<Select::_result_row_t<connection>>
+		template <typename ResultRow>
+		struct result_columns;
+		
+		template <typename Db, typename... FieldSpecs>
+		struct result_columns<::sqlpp::result_row_t<Db, FieldSpecs...>> {
+			static std::vector<column_info> get() {
+				return {column_info{
+					FieldSpecs::_alias_t::_name_t::char_ptr(),
+					detail::field_kind<FieldSpecs>::value,
+					can_be_null_t<FieldSpecs>::value,
+					0,
+					0}...};
+			}
+			
+			static std::vector<column_kind> kinds() {
+				return {detail::field_kind<FieldSpecs>::value...};
+			}
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_RESULT_COLUMNS_H
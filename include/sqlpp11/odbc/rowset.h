@@ -0,0 +1,181 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_ROWSET_H
+#define SQLPP11_ODBC_ROWSET_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sqlpp11/odbc/numeric.h>
+#include <sqlpp11/odbc/result_columns.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sqlext.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			struct prepared_statement_handle_t;
+		}
+		
+		struct rowset_config {
+			//Rows fetched per SQLFetch, 0 for the connection's statement_options::rowset_size
+			size_t rows = 0;
+			//Longest text value (in bytes) a rowset can hold, longer values throw
+			size_t max_text_length = 8192;
+			//Blocks fetched ahead by a background thread while the caller works on the current one, 0 fetches on the calling thread
+			size_t prefetch_blocks = 0;
+			//Text columns (0-based) fetched as UTF-16 and converted to UTF-8 by the connector, all of them with statement_options::wide_text
+			std::vector<size_t> wide_columns;
+		};
+		
+		//! Rows of a result stored column by column, as fetched by a rowset
+		class rowset_block_t {
+		public:
+			struct column_buffer_t {
+				column_kind kind;
+				SQLSMALLINT c_type;
+				//bytes per value
+				SQLLEN width;
+				std::vector<char> values;
+				std::vector<SQLLEN> indicators;
+				//Precision and scale the driver converts numeric columns to
+				SQLSMALLINT precision;
+				SQLSMALLINT scale;
+			};
+			
+		protected:
+			std::vector<column_buffer_t> _columns;
+			size_t _size = 0;
+			
+		public:
+			rowset_block_t() = default;
+			explicit rowset_block_t(std::vector<column_buffer_t> columns) : _columns(std::move(columns)) {}
+			
+			//! Number of rows in the block
+			size_t size() const {
+				return _size;
+			}
+			
+			size_t column_count() const {
+				return _columns.size();
+			}
+			
+			const column_buffer_t& column(size_t index) const {
+				return _columns[index];
+			}
+			
+			bool is_null(size_t column, size_t row) const {
+				return _columns[column].indicators[row] == SQL_NULL_DATA;
+			}
+			
+			//! Values of a column, T is the C type bound for its kind (SQLBIGINT, SQL_DATE_STRUCT, ...)
+			template <typename T>
+			const T* values(size_t column) const {
+				return reinterpret_cast<const T*>(_columns[column].values.data());
+			}
+			
+			const char* text(size_t column, size_t row) const {
+				return _columns[column].values.data() + row * _columns[column].width;
+			}
+			
+			size_t text_length(size_t column, size_t row) const {
+				return static_cast<size_t>(_columns[column].indicators[row]);
+			}
+			
+			numeric_t numeric(size_t column, size_t row) const {
+				return numeric_t(values<SQL_NUMERIC_STRUCT>(column)[row]);
+			}
+			
+			//! Moves the value buffer of a column out of the block and puts a fresh one of the same size in its place
+			std::vector<char> take_values(size_t column) {
+				std::vector<char> values(_columns[column].values.size());
+				values.swap(_columns[column].values);
+				return values;
+			}
+			
+			void swap(rowset_block_t& rhs) {
+				_columns.swap(rhs._columns);
+				std::swap(_size, rhs._size);
+			}
+		};
+		
+		//! Fetches a result block by block into column-wise bound buffers (SQL_ATTR_ROW_ARRAY_SIZE)
+		// Buffers may be swapped or taken out between fetches, they are bound again as needed.
+		class rowset_t : public rowset_block_t {
+			std::shared_ptr<detail::prepared_statement_handle_t> _handle;
+			//The driver writes the number of fetched rows here, so it must not move with the rowset
+			std::unique_ptr<SQLULEN> _fetched;
+			size_t _capacity = 0;
+			//Buffers the columns are currently bound to
+			std::vector<std::pair<const char*, const SQLLEN*>> _bound;
+			//UTF-16 staging buffers of the text columns fetched as SQL_C_WCHAR, empty for the others
+			std::vector<std::vector<char16_t>> _wide;
+			
+			void bind_column(size_t index);
+			void convert_wide_column(size_t index);
+			
+		public:
+			rowset_t() = default;
+			rowset_t(const std::shared_ptr<detail::prepared_statement_handle_t>& handle, const std::vector<column_kind>& kinds, const rowset_config& config);
+			rowset_t(const rowset_t&) = delete;
+			rowset_t(rowset_t&& rhs) = default;
+			rowset_t& operator=(const rowset_t&) = delete;
+			rowset_t& operator=(rowset_t&& rhs);
+			~rowset_t();
+			
+			//! Fetches the next block, returns false at the end of the result
+			bool fetch();
+			
+			size_t capacity() const {
+				return _capacity;
+			}
+			
+			//! An unbound block with buffers shaped like the ones of this rowset
+			rowset_block_t make_block() const;
+			
+			SQLHSTMT native_handle();
+		};
+		
+		//! Names, kinds and nullability of the columns of an executed statement as reported by SQLDescribeCol
+		std::vector<column_info> describe_columns(SQLHSTMT stmt);
+		//! describe_columns for a statement of the connector, whose description is cached for further executions
+		std::vector<column_info> describe_columns(detail::prepared_statement_handle_t& statement);
+	}
+}
+
+#endif //SQLPP11_ODBC_ROWSET_H
@@ -39,13 +39,17 @@
 #endif
 
 #include <sql.h>
+#include <string>
 #include <sqlpp11/data_types/text/concat.h>
 #include <sqlpp11/insert_value_list.h>
 #include <sqlpp11/connection.h>
+#include <sqlpp11/odbc/connection_config.h>
 
 namespace sqlpp
 {
 	namespace odbc {
+		//Declared here, so _db doesn't name sqlpp::connection when this header is included first
+		class connection;
 		struct serializer_t;
 	}
 	#if ODBCVER < 0x0300
@@ -71,6 +75,9 @@ namespace sqlpp
 			
 			std::string escape(std::string arg);
 			
+			//! the ODBC_Type of the connection, for clauses spelled differently in each dialect
+			ODBC_Type type() const;
+			
 			std::string str() const {
 				return _os.str();
 			}
@@ -86,6 +93,8 @@ namespace sqlpp
 			const connection& _db;
 			std::stringstream _os;
 			size_t _count;
+			//Where the insert_or statement being serialized starts, see insert_or.h
+			std::string::size_type _statement_begin = 0;
 		};
 	}
 	template <typename First, typename... Args>
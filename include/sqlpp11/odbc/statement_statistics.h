@@ -0,0 +1,111 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_STATEMENT_STATISTICS_H
+#define SQLPP11_ODBC_STATEMENT_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sqlpp {
+	namespace odbc {
+		struct statement_statistics_config {
+			//Statements tracked at most, a new one replaces the one executed least often
+			size_t max_statements = 256;
+			//Statements taking longer are passed to slow_statement_log, 0 logs none
+			std::chrono::microseconds slow_threshold = std::chrono::microseconds(0);
+			//Called with the fingerprint of a slow statement, its duration and rows; writes to std::cerr if empty
+			std::function<void(const std::string&, std::chrono::microseconds, size_t)> slow_statement_log;
+		};
+		
+		//! What was recorded for one statement fingerprint
+		struct statement_stats {
+			std::string fingerprint;
+			uint64_t count;
+			//Executions of replaced statements that may be included in count (the Space-Saving error), 0 if none were replaced
+			uint64_t count_error;
+			std::chrono::microseconds total_time;
+			std::chrono::microseconds max_time;
+			//Within a quarter of the true value, durations are kept in logarithmic buckets
+			std::chrono::microseconds p99_time;
+			uint64_t total_rows;
+			uint64_t max_rows;
+		};
+		
+		//! The statement text with literals replaced by ?, lists of them collapsed into one ... and whitespace squeezed,
+		// so executions differing only in their values are counted together and no values are logged
+		std::string statement_fingerprint(const std::string& statement);
+		
+		//! Execution statistics of the statements of a connection, keyed by fingerprint.
+		// Memory is bounded by max_statements: when that many are tracked, the one with the lowest count is replaced,
+		// and the new one starts at that count (Space-Saving), so frequent statements are never lost.
+		// Thread safe, so it can be read while the connection is in use.
+		class statement_statistics_t {
+		public:
+			//Logarithmic duration buckets, 4 per power of two up to 2^36 microseconds
+			static constexpr size_t histogram_buckets = 140;
+			
+		private:
+			struct entry_t {
+				uint64_t count = 0;
+				uint64_t count_error = 0;
+				uint64_t total_time = 0;
+				uint64_t max_time = 0;
+				uint64_t total_rows = 0;
+				uint64_t max_rows = 0;
+				std::array<uint32_t, histogram_buckets> histogram{};
+			};
+			
+			mutable std::mutex _mutex;
+			statement_statistics_config _config;
+			std::unordered_map<std::string, entry_t> _entries;
+			
+			entry_t& entry(const std::string& fingerprint);
+			
+		public:
+			explicit statement_statistics_t(statement_statistics_config config = statement_statistics_config());
+			statement_statistics_t(const statement_statistics_t&) = delete;
+			statement_statistics_t& operator=(const statement_statistics_t&) = delete;
+			
+			//! Counts an execution and logs it if it was slow
+			void record(const std::string& fingerprint, std::chrono::microseconds duration, size_t rows);
+			
+			//! The n statements with the highest total time, slowest first
+			std::vector<statement_stats> top(size_t n) const;
+			
+			size_t size() const;
+			void clear();
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_STATEMENT_STATISTICS_H
@@ -0,0 +1,237 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_STORED_RESULT_H
+#define SQLPP11_ODBC_STORED_RESULT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <sqlpp11/data_types/day_point.h>
+#include <sqlpp11/data_types/time_point.h>
+#include <sqlpp11/data_types/time_of_day.h>
+#include <sqlpp11/odbc/result_columns.h>
+#include <sqlpp11/odbc/rowset.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sqlext.h>
+
+namespace sqlpp {
+	namespace odbc {
+		class numeric_t;
+		
+		//! A whole result held on the client, without a statement handle
+		// Rows are fixed width slots laid out one after another, text values live in a shared heap and
+		// their slots hold offset and length. Values are converted to their C++ types when a row is bound.
+		class stored_result_t {
+			std::vector<column_kind> _kinds;
+			//Byte offset of each column within a row slot
+			std::vector<size_t> _offsets;
+			size_t _row_width = 0;
+			std::vector<char> _slots;
+			//One flag per value, row by row
+			std::vector<bool> _nulls;
+			std::vector<char> _heap;
+			size_t _size = 0;
+			//Row bound by the next call to next()
+			size_t _row = 0;
+			
+			const char* slot(size_t index) const {
+				return _slots.data() + (_row - 1) * _row_width + _offsets[index];
+			}
+			
+			bool null(size_t index) const {
+				return _nulls[(_row - 1) * _kinds.size() + index];
+			}
+			
+		public:
+			stored_result_t() = default;
+			explicit stored_result_t(const std::vector<column_kind>& kinds);
+			//! Drains the rowset, its statement is closed and released when the rowset goes out of scope
+			explicit stored_result_t(rowset_t&& rowset);
+			stored_result_t(const stored_result_t&) = default;
+			stored_result_t(stored_result_t&&) = default;
+			stored_result_t& operator=(const stored_result_t&) = default;
+			stored_result_t& operator=(stored_result_t&&) = default;
+			~stored_result_t() = default;
+			
+			//! Appends the rows of a block, its columns must have the kinds this result was made with
+			void append(const rowset_block_t& block);
+			//! Appends rows first to first + rows - 1 of a block
+			void append(const rowset_block_t& block, size_t first, size_t rows);
+			
+			//! Exact number of rows, unlike bind_result_t::size() it does not depend on SQLRowCount
+			size_t size() const {
+				return _size;
+			}
+			
+			//! Makes row the one bound by the next call to next()
+			void seek(size_t row) {
+				_row = row;
+			}
+			
+			//! Bytes held by the slots and the text heap
+			size_t memory_usage() const {
+				return _slots.capacity() + _heap.capacity() + _nulls.capacity() / 8;
+			}
+			
+			template <typename ResultRow>
+			void next(ResultRow& result_row) {
+				if(_row < _size) {
+					++_row;
+					if(not result_row) {
+						result_row._validate();
+					}
+					result_row._bind(*this);
+				} else {
+					if(result_row) {
+						result_row._invalidate();
+					}
+				}
+			}
+			
+			void _bind_boolean_result(size_t index, signed char* value, bool* is_null);
+			void _bind_floating_point_result(size_t index, double* value, bool* is_null);
+			void _bind_integral_result(size_t index, int64_t* value, bool* is_null);
+			void _bind_text_result(size_t index, const char** text, size_t* len);
+			void _bind_date_result(size_t index, ::sqlpp::day_point::_cpp_value_type* value, bool* is_null);
+			void _bind_date_time_result(size_t index, ::sqlpp::time_point::_cpp_value_type* value, bool* is_null);
+			void _bind_time_of_day_result(size_t index, ::sqlpp::time_of_day::_cpp_value_type* value, bool* is_null);
+			void _bind_timestamp_result(size_t index, SQL_TIMESTAMP_STRUCT* value, bool* is_null);
+			void _bind_numeric_result(size_t index, numeric_t* value, bool* is_null);
+		};
+		
+		//! Rows of a stored_result_t as ResultRow, with random access and any number of passes
+		// All access goes through one row object: operator[] and the iterators rebind it, so a reference
+		// obtained earlier shows the row accessed last. Text fields point into the result and stay valid with it.
+		template <typename ResultRow>
+		class stored_result {
+			stored_result_t _result;
+			ResultRow _result_row;
+			
+		public:
+			class iterator {
+				stored_result* _owner = nullptr;
+				size_t _index = 0;
+				
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = ResultRow;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const ResultRow*;
+				using reference = const ResultRow&;
+				
+				iterator() = default;
+				iterator(stored_result* owner, size_t index) : _owner(owner), _index(index) {}
+				
+				reference operator*() const {
+					return (*_owner)[_index];
+				}
+				
+				pointer operator->() const {
+					return &(*_owner)[_index];
+				}
+				
+				iterator& operator++() {
+					++_index;
+					return *this;
+				}
+				
+				iterator operator++(int) {
+					iterator previous = *this;
+					++_index;
+					return previous;
+				}
+				
+				bool operator==(const iterator& rhs) const {
+					return _owner == rhs._owner && _index == rhs._index;
+				}
+				
+				bool operator!=(const iterator& rhs) const {
+					return !(*this == rhs);
+				}
+			};
+			
+			stored_result() = default;
+			explicit stored_result(stored_result_t result) : _result(std::move(result)) {}
+			stored_result(const stored_result&) = delete;
+			stored_result(stored_result&& rhs) : _result(std::move(rhs._result)) {}
+			stored_result& operator=(const stored_result&) = delete;
+			stored_result& operator=(stored_result&& rhs) {
+				_result = std::move(rhs._result);
+				//The row may point into the text heap we just gave up
+				if(_result_row) {
+					_result_row._invalidate();
+				}
+				return *this;
+			}
+			~stored_result() = default;
+			
+			size_t size() const {
+				return _result.size();
+			}
+			
+			bool empty() const {
+				return _result.size() == 0;
+			}
+			
+			const ResultRow& operator[](size_t index) {
+				_result.seek(index);
+				_result.next(_result_row);
+				return _result_row;
+			}
+			
+			const ResultRow& front() {
+				return (*this)[0];
+			}
+			
+			iterator begin() {
+				return iterator(this, 0);
+			}
+			
+			iterator end() {
+				return iterator(this, size());
+			}
+			
+			const stored_result_t& storage() const {
+				return _result;
+			}
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_STORED_RESULT_H
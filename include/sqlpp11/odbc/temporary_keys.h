@@ -0,0 +1,166 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_TEMPORARY_KEYS_H
+#define SQLPP11_ODBC_TEMPORARY_KEYS_H
+
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <sqlpp11/table.h>
+#include <sqlpp11/char_sequence.h>
+#include <sqlpp11/data_types.h>
+#include <sqlpp11/odbc/connection.h>
+
+namespace sqlpp {
+	namespace odbc {
+		struct temporary_keys_config {
+			//Keys sent per SQLExecute, as an array of parameters (SQL_ATTR_PARAMSET_SIZE)
+			size_t batch_size = 1000;
+			//Width of the key column for text keys, longer keys throw
+			size_t text_length = 255;
+			//Makes the key column the primary key, which helps joins on large sets; the keys must be unique then
+			bool primary_key = false;
+		};
+		
+		//! A table of keys created for this session and dropped again when it goes out of scope
+		// The table is CREATE TEMPORARY TABLE on MySQL and PostgreSQL, CREATE TEMP TABLE on SQLite and a local
+		// temporary table on TSQL, whose name has to start with #. Keys are inserted batch_size at a time as parameter
+		// arrays, one by one if the driver doesn't take them.
+		class temporary_keys_t {
+			connection* _db;
+			std::string _name;
+			size_t _size = 0;
+			
+			void create(const std::string& column, const std::string& type, const temporary_keys_config& config);
+			void drop();
+			
+		public:
+			temporary_keys_t(connection& db, std::string name, const std::string& column, const std::vector<int64_t>& keys, const temporary_keys_config& config);
+			temporary_keys_t(connection& db, std::string name, const std::string& column, const std::vector<std::string>& keys, const temporary_keys_config& config);
+			temporary_keys_t(const temporary_keys_t&) = delete;
+			temporary_keys_t(temporary_keys_t&& rhs);
+			temporary_keys_t& operator=(const temporary_keys_t&) = delete;
+			temporary_keys_t& operator=(temporary_keys_t&&) = delete;
+			//! Drops the table, failures are only reported on std::cerr
+			~temporary_keys_t();
+			
+			size_t size() const {
+				return _size;
+			}
+			
+			const std::string& name() const {
+				return _name;
+			}
+		};
+		
+		//! temporary_keys_t as the sqlpp11 Table, which must have exactly one column, integral or text.
+		// The table can be joined like any other: select(...).from(tab.join(keys.table()).on(tab.id == keys.table().id))
+		template <typename Table>
+		class temporary_keys {
+			using _column_t = typename std::tuple_element<0, typename Table::_column_tuple_t>::type;
+			static_assert(std::tuple_size<typename Table::_column_tuple_t>::value == 1, "temporary_keys tables have exactly one column");
+			
+			temporary_keys_t _keys;
+			Table _table;
+			
+		public:
+			using _key_t = typename value_type_of<_column_t>::_cpp_value_type;
+			
+			temporary_keys(connection& db, const std::vector<_key_t>& keys, const temporary_keys_config& config = temporary_keys_config())
+				: _keys(db, name_of<Table>::char_ptr(), name_of<_column_t>::char_ptr(), keys, config)
+			{}
+			
+			const Table& table() const {
+				return _table;
+			}
+			
+			size_t size() const {
+				return _keys.size();
+			}
+		};
+		
+		namespace temporary_keys_ {
+			struct IntegralId {
+				struct _alias_t {
+					static constexpr const char _literal[] = "id";
+					using _name_t = sqlpp::make_char_sequence<sizeof(_literal), _literal>;
+					template<typename T>
+					struct _member_t {
+						T id;
+						T& operator()() { return id; }
+						const T& operator()() const { return id; }
+					};
+				};
+				using _traits = sqlpp::make_traits<sqlpp::integral, sqlpp::tag::require_insert>;
+			};
+			
+			struct TextId {
+				struct _alias_t {
+					static constexpr const char _literal[] = "id";
+					using _name_t = sqlpp::make_char_sequence<sizeof(_literal), _literal>;
+					template<typename T>
+					struct _member_t {
+						T id;
+						T& operator()() { return id; }
+						const T& operator()() const { return id; }
+					};
+				};
+				using _traits = sqlpp::make_traits<sqlpp::text, sqlpp::tag::require_insert>;
+			};
+		}
+		
+		//! Ready made tables for temporary_keys on MySQL, PostgreSQL and SQLite, TSQL needs its own named #...
+		struct integral_keys : sqlpp::table_t<integral_keys, temporary_keys_::IntegralId> {
+			struct _alias_t {
+				static constexpr const char _literal[] = "sqlpp_keys";
+				using _name_t = sqlpp::make_char_sequence<sizeof(_literal), _literal>;
+				template<typename T>
+				struct _member_t {
+					T sqlpp_keys;
+					T& operator()() { return sqlpp_keys; }
+					const T& operator()() const { return sqlpp_keys; }
+				};
+			};
+		};
+		
+		struct text_keys : sqlpp::table_t<text_keys, temporary_keys_::TextId> {
+			struct _alias_t {
+				static constexpr const char _literal[] = "sqlpp_text_keys";
+				using _name_t = sqlpp::make_char_sequence<sizeof(_literal), _literal>;
+				template<typename T>
+				struct _member_t {
+					T sqlpp_text_keys;
+					T& operator()() { return sqlpp_text_keys; }
+					const T& operator()() const { return sqlpp_text_keys; }
+				};
+			};
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_TEMPORARY_KEYS_H
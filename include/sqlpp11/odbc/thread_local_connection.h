@@ -0,0 +1,91 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_THREAD_LOCAL_CONNECTION_H
+#define SQLPP11_ODBC_THREAD_LOCAL_CONNECTION_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <sqlpp11/odbc/connection.h>
+
+namespace sqlpp {
+	namespace odbc {
+		struct thread_local_connection_config {
+			//Connections open at the same time, 0 for no limit
+			size_t max_connections = 0;
+			//How long a thread waits for a connection to be released once max_connections are open, before it throws
+			std::chrono::milliseconds max_wait = std::chrono::seconds(10);
+		};
+		
+		//! Gives every thread its own connection, opened with the same configuration on the thread's first statement.
+		// A thread's connection is closed when the thread exits or calls release(), which makes room for others when the
+		// number of connections is limited. Prepared statements belong to the connection of the thread that prepared them.
+		// Connections of other threads outlive the thread_local_connection until their thread exits.
+		class thread_local_connection {
+		public:
+			struct state_t;
+			
+		private:
+			std::shared_ptr<state_t> _state;
+			
+		public:
+			thread_local_connection(const connection_config& config, thread_local_connection_config limits = thread_local_connection_config());
+			thread_local_connection(const driver_connection_config& config, thread_local_connection_config limits = thread_local_connection_config());
+			thread_local_connection(const thread_local_connection&) = delete;
+			thread_local_connection& operator=(const thread_local_connection&) = delete;
+			//! Closes the calling thread's connection
+			~thread_local_connection();
+			
+			//! The calling thread's connection, connects if it has none
+			connection& get();
+			
+			template <typename T>
+			auto operator()(const T& t) -> decltype(std::declval<connection&>()(t)) {
+				return get()(t);
+			}
+			
+			template <typename T>
+			auto prepare(const T& t) -> decltype(std::declval<connection&>().prepare(t)) {
+				return get().prepare(t);
+			}
+			
+			size_t execute(const std::string& command) {
+				return get().execute(command);
+			}
+			
+			//! Closes the calling thread's connection, the next statement opens a new one
+			void release();
+			
+			//! Connections open in all threads
+			size_t size() const;
+		};
+	}
+}
+
+#endif //SQLPP11_ODBC_THREAD_LOCAL_CONNECTION_H
@@ -0,0 +1,54 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_TRANSCODE_H
+#define SQLPP11_ODBC_TRANSCODE_H
+
+#include <cstddef>
+#include <string>
+
+//Conversions between UTF-8 and the UTF-16 of SQL_C_WCHAR buffers.
+//Runs of ASCII are converted 8 (UTF-16) or 16 (UTF-8) characters at a time with SSE2 where available,
+//everything else one code point at a time. Unpaired surrogates and invalid UTF-8 become U+FFFD.
+namespace sqlpp {
+	namespace odbc {
+		//! Returned by the transcoders when the output buffer is too small
+		constexpr size_t transcode_overflow = static_cast<size_t>(-1);
+		
+		//! Converts length UTF-16 units to UTF-8, returns the number of bytes written to out or transcode_overflow
+		// A unit never takes more than 3 bytes, so capacity = 3 * length always suffices.
+		size_t utf16_to_utf8(const char16_t* in, size_t length, char* out, size_t capacity);
+		
+		//! Converts length bytes of UTF-8 to UTF-16, returns the number of units written to out or transcode_overflow
+		// A byte never takes more than one unit, so capacity = length always suffices.
+		size_t utf8_to_utf16(const char* in, size_t length, char16_t* out, size_t capacity);
+		
+		std::string utf16_to_utf8(const std::u16string& text);
+		std::u16string utf8_to_utf16(const std::string& text);
+	}
+}
+
+#endif //SQLPP11_ODBC_TRANSCODE_H
@@ -0,0 +1,322 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/arrow.h>
+#include <sqlpp11/odbc/civil_time.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sql.h>
+#include <sqlext.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			struct schema_data_t {
+				std::string format;
+				std::string name;
+				std::vector<ArrowSchema> children;
+				std::vector<ArrowSchema*> child_pointers;
+			};
+			
+			void release_schema(ArrowSchema* schema) {
+				schema_data_t* data = static_cast<schema_data_t*>(schema->private_data);
+				for(ArrowSchema* child : data->child_pointers) {
+					//Consumers may have moved children out, which leaves them released
+					if(child->release) {
+						child->release(child);
+					}
+				}
+				delete data;
+				schema->release = nullptr;
+			}
+			
+			void make_schema(ArrowSchema* out, const std::string& format, const std::string& name, int64_t flags, size_t n_children) {
+				schema_data_t* data = new schema_data_t{format, name, std::vector<ArrowSchema>(n_children), {}};
+				for(ArrowSchema& child : data->children) {
+					std::memset(&child, 0, sizeof(ArrowSchema));
+					data->child_pointers.push_back(&child);
+				}
+				out->format = data->format.c_str();
+				out->name = data->name.c_str();
+				out->metadata = nullptr;
+				out->flags = flags;
+				out->n_children = n_children;
+				out->children = n_children ? data->child_pointers.data() : nullptr;
+				out->dictionary = nullptr;
+				out->release = &release_schema;
+				out->private_data = data;
+			}
+			
+			struct array_data_t {
+				std::vector<std::vector<char>> buffers;
+				std::vector<const void*> buffer_pointers;
+				std::vector<ArrowArray> children;
+				std::vector<ArrowArray*> child_pointers;
+			};
+			
+			void release_array(ArrowArray* array) {
+				array_data_t* data = static_cast<array_data_t*>(array->private_data);
+				for(ArrowArray* child : data->child_pointers) {
+					if(child->release) {
+						child->release(child);
+					}
+				}
+				delete data;
+				array->release = nullptr;
+			}
+			
+			//! The first buffer is the validity bitmap, which is left out (null) when empty
+			void make_array(ArrowArray* out, int64_t length, int64_t null_count, std::vector<std::vector<char>> buffers, size_t n_children) {
+				array_data_t* data = new array_data_t{std::move(buffers), {}, std::vector<ArrowArray>(n_children), {}};
+				for(size_t i = 0; i < data->buffers.size(); ++i) {
+					std::vector<char>& buffer = data->buffers[i];
+					if(i > 0 && buffer.empty()) {
+						//Some consumers reject null data buffers, even for empty values
+						buffer.resize(8);
+					}
+					data->buffer_pointers.push_back(buffer.empty() ? nullptr : buffer.data());
+				}
+				for(ArrowArray& child : data->children) {
+					std::memset(&child, 0, sizeof(ArrowArray));
+					data->child_pointers.push_back(&child);
+				}
+				out->length = length;
+				out->null_count = null_count;
+				out->offset = 0;
+				out->n_buffers = data->buffer_pointers.size();
+				out->n_children = n_children;
+				out->buffers = data->buffer_pointers.data();
+				out->children = n_children ? data->child_pointers.data() : nullptr;
+				out->dictionary = nullptr;
+				out->release = &release_array;
+				out->private_data = data;
+			}
+			
+			std::string format_of(const column_info& column) {
+				switch(column.kind) {
+					case column_kind::numeric: return "d:"+std::to_string(column.precision)+","+std::to_string(column.scale);
+					case column_kind::integral: return "l";
+					case column_kind::floating_point: return "g";
+					case column_kind::boolean: return "b";
+					case column_kind::date: return "tdD";
+					case column_kind::date_time: return "tsu:";
+					case column_kind::time_of_day: return "ttu";
+					default: return "U";
+				}
+			}
+			
+			std::vector<char> validity_of(const rowset_block_t& block, size_t column, int64_t& null_count) {
+				const std::vector<SQLLEN>& indicators = block.column(column).indicators;
+				const size_t length = block.size();
+				null_count = 0;
+				for(size_t row = 0; row < length; ++row) {
+					null_count += indicators[row] == SQL_NULL_DATA;
+				}
+				if(null_count == 0) {
+					return {};
+				}
+				std::vector<char> bits((length + 7) / 8, 0);
+				for(size_t row = 0; row < length; ++row) {
+					if(indicators[row] != SQL_NULL_DATA) {
+						bits[row / 8] |= static_cast<char>(1u << (row % 8));
+					}
+				}
+				return bits;
+			}
+			
+			template <typename T>
+			std::vector<char> make_buffer(size_t length) {
+				return std::vector<char>(length * sizeof(T));
+			}
+			
+			void export_column(rowset_block_t& block, size_t index, ArrowArray* out) {
+				const size_t length = block.size();
+				int64_t null_count = 0;
+				std::vector<std::vector<char>> buffers;
+				buffers.push_back(validity_of(block, index, null_count));
+				switch(block.column(index).kind) {
+					case column_kind::integral:
+					case column_kind::floating_point:
+						//SQLBIGINT and SQLDOUBLE already have the Arrow layout, hand over the bound buffer
+						buffers.push_back(block.take_values(index));
+						break;
+					case column_kind::boolean: {
+						const SQLCHAR* values = block.values<SQLCHAR>(index);
+						std::vector<char> bits((length + 7) / 8, 0);
+						for(size_t row = 0; row < length; ++row) {
+							if(values[row]) {
+								bits[row / 8] |= static_cast<char>(1u << (row % 8));
+							}
+						}
+						buffers.push_back(std::move(bits));
+						break;
+					}
+					case column_kind::date: {
+						//Values of null rows are undefined, both here and in Arrow, so they are converted along with the rest
+						std::vector<char> buffer = make_buffer<int32_t>(length);
+						days_from_dates(block.values<SQL_DATE_STRUCT>(index), length, reinterpret_cast<int32_t*>(buffer.data()));
+						buffers.push_back(std::move(buffer));
+						break;
+					}
+					case column_kind::date_time: {
+						std::vector<char> buffer = make_buffer<int64_t>(length);
+						microseconds_from_timestamps(block.values<SQL_TIMESTAMP_STRUCT>(index), length, reinterpret_cast<int64_t*>(buffer.data()));
+						buffers.push_back(std::move(buffer));
+						break;
+					}
+					case column_kind::time_of_day: {
+						std::vector<char> buffer = make_buffer<int64_t>(length);
+						microseconds_from_times(block.values<SQL_TIME_STRUCT>(index), length, reinterpret_cast<int64_t*>(buffer.data()));
+						buffers.push_back(std::move(buffer));
+						break;
+					}
+					case column_kind::numeric: {
+						//decimal128 is the magnitude of SQL_NUMERIC_STRUCT in two's complement, at the scale the column was bound with
+						const SQL_NUMERIC_STRUCT* values = block.values<SQL_NUMERIC_STRUCT>(index);
+						std::vector<char> buffer = make_buffer<uint64_t>(2 * length);
+						uint64_t* words = reinterpret_cast<uint64_t*>(buffer.data());
+						for(size_t row = 0; row < length; ++row) {
+							uint64_t low = 0, high = 0;
+							for(int i = 7; i >= 0; --i) {
+								low = low << 8 | values[row].val[i];
+								high = high << 8 | values[row].val[i + 8];
+							}
+							if(values[row].sign == 0) {
+								low = ~low + 1;
+								high = ~high + (low == 0);
+							}
+							words[2 * row] = low;
+							words[2 * row + 1] = high;
+						}
+						buffers.push_back(std::move(buffer));
+						break;
+					}
+					case column_kind::text: {
+						//Bound text is padded to a fixed width, Arrow wants it back to back
+						std::vector<char> offset_buffer = make_buffer<int64_t>(length + 1);
+						int64_t* offsets = reinterpret_cast<int64_t*>(offset_buffer.data());
+						offsets[0] = 0;
+						for(size_t row = 0; row < length; ++row) {
+							offsets[row + 1] = offsets[row] + (block.is_null(index, row) ? 0 : block.text_length(index, row));
+						}
+						std::vector<char> chars(offsets[length]);
+						for(size_t row = 0; row < length; ++row) {
+							std::memcpy(chars.data() + offsets[row], block.text(index, row), offsets[row + 1] - offsets[row]);
+						}
+						buffers.push_back(std::move(offset_buffer));
+						buffers.push_back(std::move(chars));
+						break;
+					}
+				}
+				make_array(out, length, null_count, std::move(buffers), 0);
+			}
+			
+			struct stream_data_t {
+				pipelined_rowset_t rowset;
+				std::vector<column_info> columns;
+				std::string error;
+			};
+			
+			int get_schema(ArrowArrayStream* stream, ArrowSchema* out) {
+				stream_data_t* data = static_cast<stream_data_t*>(stream->private_data);
+				try {
+					make_schema(out, "+s", "", 0, data->columns.size());
+					for(size_t i = 0; i < data->columns.size(); ++i) {
+						const column_info& column = data->columns[i];
+						make_schema(out->children[i], format_of(column), column.name, column.can_be_null ? ARROW_FLAG_NULLABLE : 0, 0);
+					}
+					return 0;
+				} catch(const std::exception& e) {
+					if(out->release) {
+						out->release(out);
+					}
+					data->error = e.what();
+					return ENOMEM;
+				}
+			}
+			
+			int get_next(ArrowArrayStream* stream, ArrowArray* out) {
+				stream_data_t* data = static_cast<stream_data_t*>(stream->private_data);
+				std::memset(out, 0, sizeof(ArrowArray));
+				try {
+					rowset_block_t* block = data->rowset.next();
+					if(!block) {
+						//End of stream
+						return 0;
+					}
+					make_array(out, block->size(), 0, {std::vector<char>()}, data->columns.size());
+					for(size_t i = 0; i < data->columns.size(); ++i) {
+						export_column(*block, i, out->children[i]);
+					}
+					return 0;
+				} catch(const std::exception& e) {
+					if(out->release) {
+						out->release(out);
+					}
+					data->error = e.what();
+					return EIO;
+				}
+			}
+			
+			const char* get_last_error(ArrowArrayStream* stream) {
+				stream_data_t* data = static_cast<stream_data_t*>(stream->private_data);
+				return data->error.empty() ? nullptr : data->error.c_str();
+			}
+			
+			void release_stream(ArrowArrayStream* stream) {
+				delete static_cast<stream_data_t*>(stream->private_data);
+				stream->release = nullptr;
+			}
+		}
+		
+		void export_arrow_stream(rowset_t rowset, const std::vector<column_info>& columns, ArrowArrayStream* out, size_t prefetch_blocks) {
+			if(columns.size() != rowset.column_count()) {
+				throw sqlpp::exception("ODBC error: rowset has "+std::to_string(rowset.column_count())+" columns, but "+std::to_string(columns.size())+" are described");
+			}
+			out->get_schema = &get_schema;
+			out->get_next = &get_next;
+			out->get_last_error = &get_last_error;
+			out->release = &release_stream;
+			out->private_data = new stream_data_t{pipelined_rowset_t(std::move(rowset), prefetch_blocks), columns, std::string()};
+		}
+	}
+}
@@ -0,0 +1,126 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <utility>
+#include <sqlpp11/odbc/batched_writer.h>
+
+namespace sqlpp {
+	namespace odbc {
+		batched_writer::batched_writer(connection& db, batched_writer_config config)
+			: _db(db)
+			, _config(std::move(config))
+		{
+		}
+		
+		batched_writer::~batched_writer() {
+			try {
+				flush();
+			} catch(const std::exception&) {
+				//Reported by flush
+			}
+		}
+		
+		void batched_writer::begin() {
+			if(_open) {
+				return;
+			}
+			_db.start_transaction();
+			_open = true;
+			_pending = 0;
+			_started = std::chrono::steady_clock::now();
+		}
+		
+		void batched_writer::written() {
+			++_pending;
+			if(_pending >= _config.max_statements || std::chrono::steady_clock::now() - _started >= _config.max_delay) {
+				flush();
+			}
+		}
+		
+		void batched_writer::abort(const std::string& error) {
+			if(!_open) {
+				return;
+			}
+			batch_result result{_pending, false, error};
+			_open = false;
+			_pending = 0;
+			try {
+				_db.rollback_transaction(false);
+			} catch(const std::exception& e) {
+				_db.report_rollback_failure(std::string("batch rollback failed: ")+e.what());
+			}
+			report(result);
+		}
+		
+		void batched_writer::report(const batch_result& result) {
+			if(!_config.on_batch) {
+				return;
+			}
+			try {
+				_config.on_batch(result);
+			} catch(const std::exception& e) {
+				std::cerr << "ODBC error: batched_writer::on_batch threw: " << e.what() << std::endl;
+			}
+		}
+		
+		size_t batched_writer::execute(const std::string& command) {
+			begin();
+			try {
+				const size_t affected = _db.execute(command);
+				written();
+				return affected;
+			} catch(const std::exception& e) {
+				abort(e.what());
+				throw;
+			}
+		}
+		
+		void batched_writer::flush() {
+			if(!_open) {
+				return;
+			}
+			const size_t statements = _pending;
+			try {
+				_db.commit_transaction();
+			} catch(const std::exception& e) {
+				abort(e.what());
+				throw;
+			}
+			_open = false;
+			_pending = 0;
+			report(batch_result{statements, true, std::string()});
+		}
+		
+		bool batched_writer::flush_if_due() {
+			if(!_open || std::chrono::steady_clock::now() - _started < _config.max_delay) {
+				return false;
+			}
+			flush();
+			return true;
+		}
+	}
+}
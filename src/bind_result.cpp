@@ -25,10 +25,15 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <string>
 #include <vector>
 #include <sqlpp11/exception.h>
 #include <sqlpp11/odbc/bind_result.h>
+#include <sqlpp11/odbc/civil_time.h>
+#include <sqlpp11/odbc/numeric.h>
+#include <sqlpp11/odbc/transcode.h>
 
 #ifdef _WIN32
 #  ifndef WIN32_LEAN_AND_MEAN
@@ -99,24 +104,75 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding text result at index " << index << std::endl;
 			}
 			assert(len);
-			SQLLEN ind(0);
-			*value = new char[256];
-			
-			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_CHAR,(SQLPOINTER) *value, 256, &ind))) {
-				throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_CHAR): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
-			}
-			if(ind == SQL_NULL_DATA || ind == SQL_NO_TOTAL || ind < 0) {
-				*len = 0;
-			} else {
-				*len = ind;
-			}
-			if(ind > 256) {
-				delete[] *value;
-				*value = new char[ind];
-				if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_CHAR,(SQLPOINTER) *value, ind, &ind))) {
+			if(_handle->wide_text) {
+				_bind_wide_text_result(index, value, len);
+				return;
+			}
+			//The buffer belongs to the statement handle and stays valid until the next row is fetched.
+			//It starts out large enough for the column's octet length, so most values take a single SQLGetData.
+			std::string& buffer = _handle->text_result(index);
+			buffer.resize(std::max<size_t>(buffer.capacity(), initial_text_length(index)));
+			size_t size = 0;
+			for(;;) {
+				SQLLEN ind(0);
+				const size_t available = buffer.size() - size;
+				const SQLRETURN rc = SQLGetData(_handle->stmt, index+1, SQL_C_CHAR, &buffer[size], available, &ind);
+				if(rc == SQL_NO_DATA) {
+					break;
+				}
+				if(!SQL_SUCCEEDED(rc)) {
 					throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_CHAR): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 				}
+				if(ind == SQL_NULL_DATA) {
+					*value = nullptr;
+					*len = 0;
+					return;
+				}
+				if(ind != SQL_NO_TOTAL && static_cast<size_t>(ind) < available) {
+					size += ind;
+					break;
+				}
+				//Truncated, continue after the characters we got (the last byte is the null terminator)
+				size += available - 1;
+				buffer.resize(ind == SQL_NO_TOTAL ? buffer.size() * 2 : size + (ind - (available - 1)) + 1);
 			}
+			*value = buffer.data();
+			*len = size;
+		}
+		
+		void bind_result_t::_bind_wide_text_result(size_t index, const char** value, size_t* len) {
+			static_assert(sizeof(SQLWCHAR) == sizeof(char16_t), "SQL_C_WCHAR buffers are read as UTF-16");
+			std::u16string& wide = _handle->wide_result;
+			wide.resize(std::max<size_t>(wide.capacity(), initial_text_length(index)));
+			size_t size = 0;
+			for(;;) {
+				SQLLEN ind(0);
+				const size_t available = wide.size() - size;
+				const SQLRETURN rc = SQLGetData(_handle->stmt, index+1, SQL_C_WCHAR, &wide[size], available * sizeof(char16_t), &ind);
+				if(rc == SQL_NO_DATA) {
+					break;
+				}
+				if(!SQL_SUCCEEDED(rc)) {
+					throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_WCHAR): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+				}
+				if(ind == SQL_NULL_DATA) {
+					*value = nullptr;
+					*len = 0;
+					return;
+				}
+				//The indicator counts bytes, not characters
+				if(ind != SQL_NO_TOTAL && static_cast<size_t>(ind) / sizeof(char16_t) < available) {
+					size += ind / sizeof(char16_t);
+					break;
+				}
+				size += available - 1;
+				wide.resize(ind == SQL_NO_TOTAL ? wide.size() * 2 : size + (ind / sizeof(char16_t) - (available - 1)) + 1);
+			}
+			std::string& buffer = _handle->text_result(index);
+			buffer.resize(3 * size);
+			buffer.resize(utf16_to_utf8(wide.data(), size, &buffer[0], buffer.size()));
+			*value = buffer.data();
+			*len = buffer.size();
 		}
 		
 		void bind_result_t::_bind_date_result(size_t index, ::sqlpp::day_point::_cpp_value_type* value, bool* is_null) {
@@ -130,7 +186,7 @@ namespace sqlpp {
 			}
 			*is_null = (ind == SQL_NULL_DATA);
 			if(!*is_null) {
-				*value = ::sqlpp::day_point::_cpp_value_type( ::date::year(date_struct.year) / date_struct.month / date_struct.day );
+				*value = ::sqlpp::day_point::_cpp_value_type(::sqlpp::chrono::days(days_from_civil(date_struct.year, date_struct.month, date_struct.day)));
 			}
 		}
 		
@@ -141,17 +197,12 @@ namespace sqlpp {
 			
 			SQL_TIMESTAMP_STRUCT timestamp_struct = {0};
 			SQLLEN ind(0);
-			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_TYPE_TIMESTAMP, &timestamp_struct, /*std::max(*/sizeof(SQL_TIMESTAMP_STRUCT)/*,22)*/, nullptr))) {
+			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_TYPE_TIMESTAMP, &timestamp_struct, sizeof(SQL_TIMESTAMP_STRUCT), &ind))) {
 				throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_TYPE_TIMESTAMP): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
 			*is_null = (ind == SQL_NULL_DATA);
 			if(!*is_null) {
-				*value = ::sqlpp::day_point::_cpp_value_type(::date::year(timestamp_struct.year) / timestamp_struct.month / timestamp_struct.day);
-				*value += 
-					std::chrono::hours(timestamp_struct.hour) +
-					std::chrono::minutes(timestamp_struct.minute) +
-					std::chrono::seconds(timestamp_struct.second) +
-					std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(timestamp_struct.fraction));
+				*value = ::sqlpp::time_point::_cpp_value_type(std::chrono::microseconds(microseconds_from_timestamp(timestamp_struct)));
 			}
 		}
 		void bind_result_t::_bind_timestamp_result(size_t index, SQL_TIMESTAMP_STRUCT* value, bool* is_null) {
@@ -160,7 +211,7 @@ namespace sqlpp {
 			}
 			
 			SQLLEN ind(0);
-			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_TYPE_TIMESTAMP, value, /*std::max(*/sizeof(SQL_TIMESTAMP_STRUCT)/*,22)*/, nullptr))) {
+			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_TYPE_TIMESTAMP, value, sizeof(SQL_TIMESTAMP_STRUCT), &ind))) {
 				throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_TYPE_TIMESTAMP): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
 			*is_null = (ind == SQL_NULL_DATA);
@@ -172,18 +223,57 @@ namespace sqlpp {
 			
 			SQL_TIME_STRUCT time_struct = {0};
 			SQLLEN ind(0);
-			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_TYPE_TIME, &time_struct, sizeof(SQL_TIME_STRUCT), nullptr))) {
+			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_C_TYPE_TIME, &time_struct, sizeof(SQL_TIME_STRUCT), &ind))) {
 				throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_TYPE_TIME): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
 			*is_null = (ind == SQL_NULL_DATA);
 			if(!*is_null) {
-				*value = 
-					std::chrono::hours{time_struct.hour} +
-					std::chrono::minutes{time_struct.minute} +
-					std::chrono::seconds{time_struct.second};
+				*value = std::chrono::microseconds(microseconds_from_time(time_struct));
+			}
+		}
+		
+		void bind_result_t::_bind_numeric_result(size_t index, numeric_t* value, bool* is_null) {
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: binding numeric result at index " << index << std::endl;
+			}
+			
+			//Fetch at the precision and scale of the column, SQL_C_NUMERIC alone would use the driver's default scale
+			//The ARD record stays set up for the next rows and executions, until the columns are unbound
+			const detail::result_column_t& column = result_column(index);
+			if(!column.numeric_descriptor) {
+				detail::set_numeric_descriptor(_handle->stmt, SQL_ATTR_APP_ROW_DESC, index+1,
+					static_cast<SQLSMALLINT>(std::min<SQLULEN>(column.size ? column.size : numeric_t::max_precision, numeric_t::max_precision)), column.digits, nullptr);
+				_handle->columns[index].numeric_descriptor = true;
+			}
+			SQL_NUMERIC_STRUCT numeric_struct = {0};
+			SQLLEN ind(0);
+			if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, SQL_ARD_TYPE, &numeric_struct, sizeof(SQL_NUMERIC_STRUCT), &ind))) {
+				throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+",SQL_C_NUMERIC): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+			}
+			*is_null = (ind == SQL_NULL_DATA);
+			if(!*is_null) {
+				*value = numeric_t(numeric_struct);
 			}
 		}
 		
+		const detail::result_column_t& bind_result_t::result_column(size_t index) {
+			const std::vector<detail::result_column_t>& columns = detail::describe_result(*_handle);
+			if(index >= columns.size()) {
+				throw sqlpp::exception("ODBC error: result has "+std::to_string(columns.size())+" columns, can't bind column "+std::to_string(index+1));
+			}
+			return columns[index];
+		}
+		
+		size_t bind_result_t::initial_text_length(size_t index) {
+			//Bigger columns (TEXT, BLOB, ...) report sizes up to gigabytes, their values are read piecewise
+			const size_t max_initial_length = 65536;
+			const SQLLEN octet_length = result_column(index).octet_length;
+			if(octet_length > 0 && static_cast<size_t>(octet_length) < max_initial_length) {
+				return static_cast<size_t>(octet_length) + 1;
+			}
+			return 256;
+		}
+		
 		bool bind_result_t::next_impl() {
 			if(_handle->debug) {
 				std::cerr << "ODBC debug: accessing next row handle at " << _handle.get() << std::endl;
@@ -198,7 +288,7 @@ namespace sqlpp {
 				case SQL_SUCCESS:
 					return true;
 				case SQL_ERROR:
-					throw sqlpp::exception("ODBC error: couldn't SQLFetch(returned SQL_ERROR): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+					detail::throw_error("ODBC error: couldn't SQLFetch(returned SQL_ERROR): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT), detail::sqlstate(_handle->stmt, SQL_HANDLE_STMT));
 				case SQL_INVALID_HANDLE:
 					throw sqlpp::exception("ODBC error: couldn't SQLFetch(returned SQL_INVALID_HANDLE): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 				default:
@@ -216,5 +306,15 @@ namespace sqlpp {
 			}
 			return ret;
 		}
+		
+		void bind_result_t::cancel() {
+			if(!_handle) {
+				return;
+			}
+			//SQLCancel is the one function that may be called while another thread uses the statement
+			if(!SQL_SUCCEEDED(SQLCancel(_handle->stmt))) {
+				throw sqlpp::exception("ODBC error: couldn't SQLCancel: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+			}
+		}
 	}
 }
@@ -0,0 +1,169 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/binding_plan.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sql.h>
+#include <sqlext.h>
+#include "detail/prepared_statement_handle.h"
+#include "detail/connection_handle.h"
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			void set_statement_attribute(SQLHSTMT stmt, SQLINTEGER attribute, SQLPOINTER value, const char* name) {
+				if(!SQL_SUCCEEDED(SQLSetStmtAttr(stmt, attribute, value, 0))) {
+					throw sqlpp::exception(std::string("ODBC error: couldn't SQLSetStmtAttr(")+name+"): "+detail::odbc_error(stmt, SQL_HANDLE_STMT));
+				}
+			}
+		}
+		
+		planned_result_t::planned_result_t(const std::shared_ptr<detail::prepared_statement_handle_t>& handle, const detail::binding_plan_view_t& plan, size_t rows, bool keep_binding)
+			: _handle(handle)
+			, _plan(plan)
+		{
+			const std::shared_ptr<detail::result_binding_t>& kept = _handle->result_binding;
+			if(keep_binding && kept && kept->offsets == _plan.offsets && kept->row_size == _plan.row_size && kept->requested_rows == rows) {
+				if(_handle->debug) {
+					std::cerr << "ODBC debug: Reusing bound planned result buffer, handle at " << _handle.get() << std::endl;
+				}
+				_binding = kept;
+				return;
+			}
+			//Columns bound along another plan are replaced
+			detail::release_result_binding(*_handle);
+			_binding = std::make_shared<detail::result_binding_t>();
+			_binding->offsets = _plan.offsets;
+			_binding->row_size = _plan.row_size;
+			_binding->requested_rows = rows;
+			_binding->capacity = rows;
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: Constructing planned result of " << rows << " rows of " << _plan.row_size << " bytes, using handle at " << _handle.get() << std::endl;
+			}
+			const size_t count = detail::describe_result(*_handle).size();
+			if(count != _plan.column_count) {
+				throw sqlpp::exception("ODBC error: result has "+std::to_string(count)+" columns, expected "+std::to_string(_plan.column_count));
+			}
+			set_statement_attribute(_handle->stmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)_plan.row_size, "SQL_ATTR_ROW_BIND_TYPE");
+			set_statement_attribute(_handle->stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)rows, "SQL_ATTR_ROW_ARRAY_SIZE");
+			//Drivers may lower the rowset size (01S02 Option value changed)
+			SQLULEN capacity = 0;
+			if(SQL_SUCCEEDED(SQLGetStmtAttr(_handle->stmt, SQL_ATTR_ROW_ARRAY_SIZE, &capacity, 0, nullptr)) && capacity > 0) {
+				_binding->capacity = std::min<size_t>(rows, capacity);
+			}
+			set_statement_attribute(_handle->stmt, SQL_ATTR_ROWS_FETCHED_PTR, &_binding->fetched, "SQL_ATTR_ROWS_FETCHED_PTR");
+			std::vector<char>& buffer = _binding->buffer;
+			buffer.resize(_binding->capacity * _plan.row_size);
+			//Bound once, the buffer never moves
+			for(size_t i = 0; i < _plan.column_count; ++i) {
+				if(!SQL_SUCCEEDED(SQLBindCol(_handle->stmt, i+1, _plan.c_types[i], &buffer[_plan.offsets[i]], _plan.widths[i],
+					reinterpret_cast<SQLLEN*>(&buffer[_plan.indicator_offsets[i]])))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLBindCol("+std::to_string(i+1)+"): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+				}
+			}
+			if(keep_binding) {
+				_handle->result_binding = _binding;
+			}
+		}
+		
+		planned_result_t::~planned_result_t() {
+			if(!_handle) {
+				return;
+			}
+			SQLFreeStmt(_handle->stmt, SQL_CLOSE);
+			if(_handle->result_binding == _binding) {
+				//Kept for the next execution
+				return;
+			}
+			//Leave the statement as we found it, so it can be executed and fetched row by row again
+			detail::unbind_columns(*_handle);
+			SQLSetStmtAttr(_handle->stmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+			SQLSetStmtAttr(_handle->stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+			SQLSetStmtAttr(_handle->stmt, SQL_ATTR_ROWS_FETCHED_PTR, nullptr, 0);
+		}
+		
+		size_t planned_result_t::capacity() const {
+			return _binding ? _binding->capacity : 0;
+		}
+		
+		bool planned_result_t::fetch() {
+			_row = _end = nullptr;
+			if(_done) {
+				return false;
+			}
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: fetching planned rows, handle at " << _handle.get() << std::endl;
+			}
+			SQLRETURN rc;
+			while((rc = SQLFetch(_handle->stmt)) == SQL_STILL_EXECUTING){}
+			switch(rc) {
+				case SQL_NO_DATA:
+					_done = true;
+					return false;
+				case SQL_SUCCESS:
+				case SQL_SUCCESS_WITH_INFO:
+					break;
+				default:
+					detail::throw_error("ODBC error: couldn't SQLFetch planned rows: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT, rc), detail::sqlstate(_handle->stmt, SQL_HANDLE_STMT));
+			}
+			const size_t fetched = static_cast<size_t>(_binding->fetched);
+			_row = _binding->buffer.data();
+			_end = _row + fetched * _plan.row_size;
+			for(size_t i = 0; i < _plan.column_count; ++i) {
+				if(_plan.c_types[i] != SQL_C_CHAR) {
+					continue;
+				}
+				for(const char* row = _row; row != _end; row += _plan.row_size) {
+					SQLLEN ind;
+					std::memcpy(&ind, row + _plan.indicator_offsets[i], sizeof(ind));
+					if(ind == SQL_NO_TOTAL || ind >= static_cast<SQLLEN>(_plan.widths[i])) {
+						throw sqlpp::exception("ODBC error: text in column "+std::to_string(i+1)+" is longer than "+
+							std::to_string(_plan.widths[i] - 1)+" bytes, raise the TextLength of the binding plan");
+					}
+				}
+			}
+			if(rc == SQL_SUCCESS_WITH_INFO) {
+				std::cerr << "ODBC warning: SQLFetch returned info "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT) << std::endl;
+			}
+			return fetched > 0;
+		}
+	}
+}
@@ -0,0 +1,61 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sqlpp11/odbc/civil_time.h>
+
+namespace sqlpp {
+	namespace odbc {
+		void days_from_dates(const SQL_DATE_STRUCT* dates, size_t count, int32_t* days) {
+			for(size_t i = 0; i < count; ++i) {
+				days[i] = days_from_civil(dates[i].year, dates[i].month, dates[i].day);
+			}
+		}
+		
+		void microseconds_from_timestamps(const SQL_TIMESTAMP_STRUCT* timestamps, size_t count, int64_t* microseconds) {
+			for(size_t i = 0; i < count; ++i) {
+				microseconds[i] = microseconds_from_timestamp(timestamps[i]);
+			}
+		}
+		
+		void microseconds_from_times(const SQL_TIME_STRUCT* times, size_t count, int64_t* microseconds) {
+			for(size_t i = 0; i < count; ++i) {
+				microseconds[i] = microseconds_from_time(times[i]);
+			}
+		}
+		
+		void dates_from_days(const int32_t* days, size_t count, SQL_DATE_STRUCT* dates) {
+			for(size_t i = 0; i < count; ++i) {
+				dates[i] = civil_from_days(days[i]);
+			}
+		}
+		
+		void timestamps_from_microseconds(const int64_t* microseconds, size_t count, SQL_TIMESTAMP_STRUCT* timestamps) {
+			for(size_t i = 0; i < count; ++i) {
+				timestamps[i] = timestamp_from_microseconds(microseconds[i]);
+			}
+		}
+	}
+}
@@ -30,6 +30,7 @@
 #include <sqlpp11/exception.h>
 #include <sqlpp11/functions.h>
 #include <sqlpp11/odbc/connection.h>
+#include <sqlpp11/odbc/exception.h>
 #include "detail/prepared_statement_handle.h"
 #include "detail/connection_handle.h"
 
@@ -46,10 +47,39 @@
 namespace sqlpp {
 	namespace odbc {
 		namespace {
-			void execute_statement(SQLHSTMT stmt) {
-				if(!SQL_SUCCEEDED(SQLExecute(stmt))) {
-					throw sqlpp::exception("ODBC error: couldn't SQLExecute: "+detail::odbc_error(stmt, SQL_HANDLE_STMT));
+			std::shared_ptr<detail::prepared_statement_handle_t> odbc_prepare(detail::connection_handle_t& handle, const std::string& statement) {
+				if(handle.debug) {
+					std::cerr << "ODBC debug: Preparing: " << statement << std::endl;
 				}
+				SQLHSTMT stmt;
+				if(!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, handle.dbc, &stmt))) {
+					detail::throw_error("ODBC error: couldn't SQLAllocHandle(SQL_HANDLE_STMT): "+detail::odbc_error(handle.dbc, SQL_HANDLE_DBC), detail::sqlstate(handle.dbc, SQL_HANDLE_DBC));
+				}
+				std::shared_ptr<detail::prepared_statement_handle_t> ret = std::make_shared<detail::prepared_statement_handle_t>(stmt, handle.debug, handle.options.wide_text);
+				ret->statement = statement;
+				handle.apply_statement_options(stmt);
+				if(!SQL_SUCCEEDED(SQLPrepare(stmt, make_sqlchar(statement), statement.length()))) {
+					detail::throw_error("ODBC error: couldn't SQLPrepare " + statement + ": "+detail::odbc_error(stmt, SQL_HANDLE_STMT), detail::sqlstate(stmt, SQL_HANDLE_STMT));
+				}
+				return ret;
+			}
+			
+			SQLRETURN odbc_execute(detail::connection_handle_t& handle, detail::prepared_statement_handle_t& prepared) {
+				if(!prepared) {
+					throw sqlpp::exception("ODBC error: the statement couldn't be prepared again after reconnecting");
+				}
+				handle.restore_autocommit();
+				//A prepared select may still have the cursor of its previous execution open
+				SQLFreeStmt(prepared.stmt, SQL_CLOSE);
+				SQLRETURN rc;
+				{
+					detail::running_statement_t running(handle, prepared.stmt);
+					rc = SQLExecute(prepared.stmt);
+				}
+				if(!SQL_SUCCEEDED(rc)) {
+					detail::throw_error("ODBC error: couldn't SQLExecute: "+detail::odbc_error(prepared.stmt, SQL_HANDLE_STMT), detail::sqlstate(prepared.stmt, SQL_HANDLE_STMT));
+				}
+				return rc;
 			}
 			size_t odbc_affected(SQLHSTMT stmt) {
 				SQLLEN ret;
@@ -59,46 +89,55 @@ namespace sqlpp {
 				return ret;
 			}
 			
-			void set_autocommit(SQLHDBC dbc) {
-				if(!SQL_SUCCEEDED(SQLSetConnectAttr(dbc, SQL_ATTR_AUTOCOMMIT, SQLPOINTER(SQL_TRUE), 0))) {
-					throw sqlpp::exception("ODBC error: Could not set AUTOCOMMIT to TRUE ("+detail::odbc_error(dbc, SQL_HANDLE_DBC)+')');
+			void set_manual_commit(detail::connection_handle_t& handle, bool manual_commit) {
+				if(manual_commit) {
+					handle.set_autocommit(false);
+					handle.manual_commit = true;
 				}
 			}
-		}
-		std::shared_ptr<detail::prepared_statement_handle_t> prepare_statement(detail::connection_handle_t& handle, const std::string& statement) {
-			if(handle.debug) {
-				std::cerr << "ODBC debug: Preparing: " << statement << std::endl;
+			
+			//! Nested transactions are savepoints named after their level
+			std::string savepoint_name(size_t depth) {
+				return "sqlpp_savepoint_"+std::to_string(depth);
 			}
-			SQLHSTMT stmt;
-			SQLAllocHandle(SQL_HANDLE_STMT, handle.dbc, &stmt);
-			std::shared_ptr<detail::prepared_statement_handle_t> ret = std::make_shared<detail::prepared_statement_handle_t>(stmt, handle.debug);
-			if(SQL_SUCCEEDED(SQLPrepare(stmt, make_sqlchar(statement), statement.length()))){
-				return ret;
-			} else {
-				throw sqlpp::exception("ODBC error: couldn't SQLPrepare " + statement + ": "+detail::odbc_error(stmt, SQL_HANDLE_STMT));
+			
+			//! SQLEndTran, throwing connection_lost if the link failed
+			void end_transaction(detail::connection_handle_t& handle, SQLSMALLINT completion) {
+				if(!SQL_SUCCEEDED(SQLEndTran(SQL_HANDLE_DBC, handle.dbc, completion))) {
+					detail::throw_error(std::string("ODBC error: Could not SQLEndTran ")+(completion == SQL_COMMIT ? "COMMIT" : "ROLLBACK")+'('+detail::odbc_error(handle.dbc, SQL_HANDLE_DBC)+')', detail::sqlstate(handle.dbc, SQL_HANDLE_DBC));
+				}
+			}
+			
+			void connect_dsn(detail::connection_handle_t& handle, const connection_config& config) {
+				if(handle.debug) {
+					std::cerr << "ODBC debug: connecting to DSN: " << config.data_source_name << std::endl;
+				}
+				if(!SQL_SUCCEEDED(SQLConnect(handle.dbc,
+					make_sqlchar(config.data_source_name), config.data_source_name.length(),
+					config.username.empty() ? nullptr : make_sqlchar(config.username), config.username.length(),
+					config.password.empty() ? nullptr : make_sqlchar(config.password), config.password.length())))
+				{
+					std::string err = detail::odbc_error(handle.dbc, SQL_HANDLE_DBC);
+					//Free and nullify so we don't try to disconnect
+					if(handle.dbc) {
+						auto d = handle.dbc;
+						handle.dbc = nullptr;
+						SQLFreeHandle(SQL_HANDLE_DBC, d);
+					}
+					throw sqlpp::exception("ODBC error: couldn't SQLConnect("+config.data_source_name+"): "+err);
+				}
 			}
 		}
 
 		connection::connection(const connection_config& config)
 			: _handle(new detail::connection_handle_t(config.debug, config.type))
+			, _running(_handle->running)
 		{
-			if(_handle->debug) {
-				std::cerr << "ODBC debug: connecting to DSN: " << config.data_source_name << std::endl;
-			}
-			if(!SQL_SUCCEEDED(SQLConnect(_handle->dbc,
-				make_sqlchar(config.data_source_name), config.data_source_name.length(),
-				config.username.empty() ? nullptr : make_sqlchar(config.username), config.username.length(),
-				config.password.empty() ? nullptr : make_sqlchar(config.password), config.password.length())))
-			{
-				std::string err = detail::odbc_error(_handle->dbc, SQL_HANDLE_DBC);
-				//Free and nullify so we don't try to disconnect
-				if(_handle->dbc) {
-					auto d = _handle->dbc;
-					_handle->dbc = nullptr;
-					SQLFreeHandle(SQL_HANDLE_DBC, d);
-				}
-				throw sqlpp::exception("ODBC error: couldn't SQLConnect("+config.data_source_name+"): "+err);
-			}
+			_handle->options = config.statement;
+			_handle->auto_reconnect = config.auto_reconnect;
+			_handle->connect = [config](detail::connection_handle_t& handle) { connect_dsn(handle, config); };
+			_handle->connect(*_handle);
+			set_manual_commit(*_handle, config.manual_commit);
 		}
 
 		connection::~connection() {}
@@ -146,28 +185,231 @@ namespace sqlpp {
 			}
 			return out_size;
 		}
+		//! Reconnects use the connection string the driver completed the first time, without prompting
+		static std::function<void(detail::connection_handle_t&)> reconnect_driver(const driver_connection_config& config, const std::string& completed) {
+			driver_connection_config again = config;
+			if(!completed.empty()) {
+				again.connection = completed;
+			}
+			again.window = nullptr;
+			again.completion = driver_completion::no_prompt;
+			return [again](detail::connection_handle_t& handle) { connect_driver(handle, again, nullptr, 0); };
+		}
 		connection::connection(const driver_connection_config& config)
 			: _handle(new detail::connection_handle_t(config.debug, config.type))
+			, _running(_handle->running)
 		{
+			_handle->options = config.statement;
+			_handle->auto_reconnect = config.auto_reconnect;
 			connect_driver(*_handle, config, nullptr, 0);
+			_handle->connect = reconnect_driver(config, std::string());
+			set_manual_commit(*_handle, config.manual_commit);
 		}
 		connection::connection(const driver_connection_config& config, std::string& out_connection, size_t out_max)
 			: _handle(new detail::connection_handle_t(config.debug, config.type))
+			, _running(_handle->running)
 		{
+			_handle->options = config.statement;
+			_handle->auto_reconnect = config.auto_reconnect;
 			out_connection.resize(out_max, '\0');
 			out_connection.resize(connect_driver(*_handle, config, make_sqlchar(out_connection), out_max), '\0');
+			_handle->connect = reconnect_driver(config, out_connection);
+			set_manual_commit(*_handle, config.manual_commit);
+		}
+		
+		bool connection::may_reconnect() const {
+			//Inside a transaction the statements before the failure are lost, so is everything since the last commit with manual_commit
+			return _handle->auto_reconnect && _handle->transaction_depth == 0 && !_handle->manual_commit;
+		}
+		
+		std::shared_ptr<detail::prepared_statement_handle_t> connection::prepare_statement(const std::string& statement) {
+			std::shared_ptr<detail::prepared_statement_handle_t> ret;
+			try {
+				ret = odbc_prepare(*_handle, statement);
+			} catch(const connection_lost&) {
+				if(!may_reconnect()) {
+					throw;
+				}
+				reconnect();
+				ret = odbc_prepare(*_handle, statement);
+			}
+			_handle->register_statement(ret);
+			return ret;
+		}
+		
+		void connection::execute_statement(detail::prepared_statement_handle_t& prepared) {
+			auto statistics = _handle->statistics;
+			if(!statistics) {
+				execute_statement_impl(prepared);
+				return;
+			}
+			const auto start = std::chrono::steady_clock::now();
+			const SQLRETURN rc = execute_statement_impl(prepared);
+			const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+			if(prepared.fingerprint.empty()) {
+				prepared.fingerprint = statement_fingerprint(prepared.statement);
+			}
+			//Drivers may not know the row count of a select, -1 then. SQLRowCount would clear the diagnostics of
+			// SQL_SUCCESS_WITH_INFO, which the caller may still read (e.g. failed parameter sets), so those count no rows
+			SQLLEN rows = 0;
+			if(rc == SQL_SUCCESS_WITH_INFO || !SQL_SUCCEEDED(SQLRowCount(prepared.stmt, &rows)) || rows < 0) {
+				rows = 0;
+			}
+			statistics->record(prepared.fingerprint, duration, static_cast<size_t>(rows));
+		}
+		
+		SQLRETURN connection::execute_statement_impl(detail::prepared_statement_handle_t& prepared) {
+			try {
+				return odbc_execute(*_handle, prepared);
+			} catch(const connection_lost&) {
+				if(!may_reconnect()) {
+					throw;
+				}
+				//Prepares this statement again, along with the others of the connection
+				reconnect();
+				return odbc_execute(*_handle, prepared);
+			}
+		}
+		
+		bool connection::is_alive() {
+			SQLUINTEGER dead = SQL_CD_TRUE;
+			if(SQL_SUCCEEDED(SQLGetConnectAttr(_handle->dbc, SQL_ATTR_CONNECTION_DEAD, &dead, 0, nullptr))) {
+				return dead == SQL_CD_FALSE;
+			}
+			//Drivers before ODBC 3.5 don't know SQL_ATTR_CONNECTION_DEAD, every ODBC_Type accepts this as the cheapest round trip
+			try {
+				_handle->exec_direct("SELECT 1");
+				return true;
+			} catch(const sqlpp::exception&) {
+				return false;
+			}
+		}
+		
+		bool connection::cancel() {
+			//Not through _handle, reconnect() may be replacing it on the executing thread
+			return _running->cancel();
+		}
+		
+		std::shared_ptr<statement_statistics_t> connection::enable_statement_statistics(const statement_statistics_config& config) {
+			_handle->statistics = std::make_shared<statement_statistics_t>(config);
+			return _handle->statistics;
+		}
+		
+		void connection::disable_statement_statistics() {
+			_handle->statistics.reset();
+		}
+		
+		std::shared_ptr<statement_statistics_t> connection::statement_statistics() const {
+			return _handle->statistics;
+		}
+		
+		void connection::reconnect() {
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: Reconnecting" << std::endl;
+			}
+			std::unique_ptr<detail::connection_handle_t> handle(new detail::connection_handle_t(_handle->debug, _handle->type));
+			handle->options = _handle->options;
+			handle->auto_reconnect = _handle->auto_reconnect;
+			handle->connect = _handle->connect;
+			handle->statistics = _handle->statistics;
+			handle->running = _handle->running;
+			handle->connect(*handle);
+			set_manual_commit(*handle, _handle->manual_commit);
+			//The old statement handles are freed before their connection is
+			for(const auto& weak : _handle->statements) {
+				if(auto statement = weak.lock()) {
+					try {
+						detail::reprepare(*handle, *statement);
+						handle->statements.push_back(statement);
+					} catch(const sqlpp::exception& e) {
+						std::cerr << "ODBC warning: " << e.what() << std::endl;
+					}
+				}
+			}
+			_handle = std::move(handle);
 		}
 
 		bind_result_t connection::select_impl(const std::string& statement) {
-			auto prepared = prepare_statement(*_handle, statement);
+			auto prepared = prepare_statement(statement);
 			if(!prepared || !*prepared) {
 				throw sqlpp::exception("ODBC error: Could not store result set");
 			}
-			execute_statement(prepared->stmt);
+			execute_statement(*prepared);
 			return bind_result_t(prepared);
 		}
 		
+		rowset_t connection::select_rowset_impl(const std::string& statement, const std::vector<column_kind>& kinds, const rowset_config& config) {
+			auto prepared = prepare_statement(statement);
+			if(!prepared || !*prepared) {
+				throw sqlpp::exception("ODBC error: Could not store result set");
+			}
+			execute_statement(*prepared);
+			return rowset_t(prepared, kinds, rowset_defaults(config));
+		}
+		
+		planned_result_t connection::select_planned_impl(const std::string& statement, const detail::binding_plan_view_t& plan, size_t rows) {
+			auto prepared = prepare_statement(statement);
+			if(!prepared || !*prepared) {
+				throw sqlpp::exception("ODBC error: Could not store result set");
+			}
+			execute_statement(*prepared);
+			return planned_result_t(prepared, plan, rows ? rows : _handle->options.rowset_size);
+		}
+		
+		planned_result_t connection::run_planned_impl(prepared_statement_t& prepared_statement, const detail::binding_plan_view_t& plan, size_t rows) {
+			execute_statement(*prepared_statement._handle);
+			return planned_result_t(prepared_statement._handle, plan, rows ? rows : _handle->options.rowset_size, true);
+		}
+		
+		rowset_t connection::run_prepared_rowset_impl(prepared_statement_t& prepared_statement, const std::vector<column_kind>& kinds, const rowset_config& config) {
+			detail::release_result_binding(*prepared_statement._handle);
+			execute_statement(*prepared_statement._handle);
+			return rowset_t(prepared_statement._handle, kinds, rowset_defaults(config));
+		}
+		
+		lazy_result_t connection::select_lazy_impl(const std::string& statement, std::vector<column_info> columns) {
+			auto prepared = prepare_statement(statement);
+			if(!prepared || !*prepared) {
+				throw sqlpp::exception("ODBC error: Could not store result set");
+			}
+			execute_statement(*prepared);
+			if(columns.empty()) {
+				columns = describe_columns(*prepared);
+			}
+			//Drivers that don't know the info type support neither extension
+			SQLUINTEGER getdata_extensions = 0;
+			if(!SQL_SUCCEEDED(SQLGetInfo(_handle->dbc, SQL_GETDATA_EXTENSIONS, &getdata_extensions, sizeof(getdata_extensions), nullptr))) {
+				getdata_extensions = 0;
+			}
+			return lazy_result_t(prepared, columns, getdata_extensions);
+		}
+		
+		rowset_config connection::rowset_defaults(const rowset_config& config) const {
+			rowset_config ret = config;
+			if(ret.rows == 0) {
+				ret.rows = _handle->options.rowset_size;
+			}
+			return ret;
+		}
+		
+		void connection::select_arrow(const std::string& statement, ArrowArrayStream* out, const rowset_config& config) {
+			auto prepared = prepare_statement(statement);
+			if(!prepared || !*prepared) {
+				throw sqlpp::exception("ODBC error: Could not store result set");
+			}
+			execute_statement(*prepared);
+			const std::vector<column_info> columns = describe_columns(*prepared);
+			std::vector<column_kind> kinds;
+			for(const column_info& column : columns) {
+				kinds.push_back(column.kind);
+			}
+			export_arrow_stream(rowset_t(prepared, kinds, rowset_defaults(config)), columns, out, config.prefetch_blocks);
+		}
+		
 		bind_result_t connection::run_prepared_select_impl(prepared_statement_t& prepared_statement) {
+			//bind_result_t reads with SQLGetData, which doesn't work on bound columns
+			detail::release_result_binding(*prepared_statement._handle);
+			execute_statement(*prepared_statement._handle);
 			return {prepared_statement._handle};
 		}
 		namespace last_insert_id_ {
@@ -179,7 +421,7 @@ namespace sqlpp {
 				case ODBC_Type::MySQL:
 					statement = "SELECT LAST_INSERT_ID()"; break;
 				case ODBC_Type::TSQL:
-					statement = "SELECT SCOPE_IDENTITY"; break;
+					statement = "SELECT SCOPE_IDENTITY()"; break;
 				case ODBC_Type::SQLite3:
 					statement = "SELECT last_insert_rowid()"; break;
 				case ODBC_Type::PostgreSQL:
@@ -187,8 +429,8 @@ namespace sqlpp {
 				default:
 					throw sqlpp::exception("Can't get last insert id for ODBC_Type "+std::to_string(static_cast<int>(_handle->type)));
 			}
-			auto prepared_statement = prepare_statement(*_handle, statement);
-			execute_statement(prepared_statement->stmt);
+			auto prepared_statement = prepare_statement(statement);
+			execute_statement(*prepared_statement);
 			int64_t ret;
 			bool is_null;
 			bind_result_t result(prepared_statement);
@@ -206,49 +448,68 @@ namespace sqlpp {
 		
 		
 		size_t connection::insert_impl(const std::string& statement) {
-			auto prepared = prepare_statement(*_handle, statement);
-			execute_statement(prepared->stmt);
+			auto prepared = prepare_statement(statement);
+			execute_statement(*prepared);
 			
 			return last_insert_id();
 		}
 		
 		prepared_statement_t connection::prepare_impl(const std::string& statement) {
-			return prepared_statement_t(prepare_statement(*_handle, statement));
+			return prepared_statement_t(prepare_statement(statement));
 		}
 		
 		size_t connection::run_prepared_insert_impl(prepared_statement_t& prepared_statement) {
-			execute_statement(prepared_statement.native_handle());
+			execute_statement(*prepared_statement._handle);
 			return last_insert_id();
 		}
 		
 		size_t connection::run_prepared_execute_impl(prepared_statement_t& prepared_statement) {
-			execute_statement(prepared_statement.native_handle());
+			execute_statement(*prepared_statement._handle);
 			return odbc_affected(prepared_statement.native_handle());
 		}
 		
 		size_t connection::execute(const std::string& statement) {
-			return _handle->exec_direct(statement);
+			if(auto statistics = _handle->statistics) {
+				const auto start = std::chrono::steady_clock::now();
+				const size_t rows = execute_impl(statement);
+				statistics->record(statement_fingerprint(statement),
+					std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start), rows);
+				return rows;
+			}
+			return execute_impl(statement);
+		}
+		
+		size_t connection::execute_impl(const std::string& statement) {
+			try {
+				return _handle->exec_direct(statement);
+			} catch(const connection_lost&) {
+				if(!may_reconnect()) {
+					throw;
+				}
+				reconnect();
+				return _handle->exec_direct(statement);
+			}
 		}
 		
 		size_t connection::update_impl(const std::string& statement) {
-			auto prepared = prepare_statement(*_handle, statement);
-			execute_statement(prepared->stmt);
+			auto prepared = prepare_statement(statement);
+			execute_statement(*prepared);
 			return odbc_affected(prepared->stmt);
 		}
 		
 		size_t connection::run_prepared_update_impl(prepared_statement_t& prepared_statement) {
-			execute_statement(prepared_statement.native_handle());
+			execute_statement(*prepared_statement._handle);
 			return odbc_affected(prepared_statement.native_handle());
 		}
 		
 		size_t connection::remove_impl(const std::string& statement) {
-			auto prepared = prepare_statement(*_handle, statement);
-			execute_statement(prepared->stmt);
+			auto prepared = prepare_statement(statement);
+			execute_statement(*prepared);
 			return odbc_affected(prepared->stmt);
 		}
 		
 		size_t connection::run_prepared_remove_impl(prepared_statement_t& prepared_statement) {
-			execute_statement(prepared_statement.native_handle());
+			execute_statement(*prepared_statement._handle);
 			return odbc_affected(prepared_statement.native_handle());
 		}
 		
@@ -270,45 +531,83 @@ namespace sqlpp {
 			return t;
 		}
 		
+		const statement_options& connection::get_statement_options() const {
+			return _handle->options;
+		}
+		
+		void connection::set_statement_options(const statement_options& options) {
+			_handle->options = options;
+		}
+		
 		void connection::start_transaction() {
-			if(_transaction_active) {
-				throw sqlpp::exception("ODBC error: Cannot have more than one open transaction per connection");
-			}
 			if(_handle->debug) {
-				std::cerr << "ODBC debug: Beginning Transaction\n";
+				std::cerr << "ODBC debug: Beginning Transaction (level " << _handle->transaction_depth + 1 << ")\n";
 			}
-			if(!SQL_SUCCEEDED(SQLSetConnectAttr(_handle->dbc, SQL_ATTR_AUTOCOMMIT, SQLPOINTER(SQL_FALSE), 0))) {
-				throw sqlpp::exception("ODBC error: Could not set AUTOCOMMIT to FALSE ("+detail::odbc_error(_handle->dbc, SQL_HANDLE_DBC)+')');
+			if(_handle->transaction_depth > 0) {
+				_handle->exec_direct((_handle->type == ODBC_Type::TSQL ? "SAVE TRANSACTION " : "SAVEPOINT ")+savepoint_name(_handle->transaction_depth));
+			} else {
+				_handle->set_autocommit(false);
 			}
-			_transaction_active = true;
+			++_handle->transaction_depth;
 		}
 		
 		void connection::commit_transaction() {
-			if(not _transaction_active) {
+			if(_handle->transaction_depth == 0) {
 				throw sqlpp::exception("ODBC error: Cannot commit a finished or failed transaction");
 			}
 			if(_handle->debug) {
-				std::cerr << "ODBC debug: Committing Transaction\n";
+				std::cerr << "ODBC debug: Committing Transaction (level " << _handle->transaction_depth << ")\n";
 			}
-			if(!SQL_SUCCEEDED(SQLEndTran(SQL_HANDLE_DBC, _handle->dbc, SQL_COMMIT))) {
-				throw sqlpp::exception("ODBC error: Could not SQLEndTran COMMIT("+detail::odbc_error(_handle->dbc, SQL_HANDLE_DBC)+')');
+			try {
+				if(_handle->transaction_depth > 1) {
+					//T-SQL savepoints can't be released, they end with the outermost transaction
+					if(_handle->type != ODBC_Type::TSQL) {
+						_handle->exec_direct("RELEASE SAVEPOINT "+savepoint_name(_handle->transaction_depth - 1));
+					}
+				} else {
+					end_transaction(*_handle, SQL_COMMIT);
+				}
+			} catch(const connection_lost&) {
+				//The server rolled back the whole transaction
+				_handle->transaction_depth = 0;
+				throw;
 			}
-			set_autocommit(_handle->dbc);
-			_transaction_active = false;
+			//Autocommit is switched back on by the next statement outside of a transaction, if any
+			--_handle->transaction_depth;
 		}
 		
 		void connection::rollback_transaction(bool report) {
-			if(not _transaction_active) {
+			if(_handle->transaction_depth == 0) {
 				throw sqlpp::exception("ODBC error: Cannot rollback a finished or failed transaction");
 			}
 			if(report || _handle->debug) {
-				std::cerr << "ODBC warning: Rolling back unfinished transaction" << std::endl;
+				std::cerr << "ODBC warning: Rolling back unfinished transaction (level " << _handle->transaction_depth << ")" << std::endl;
 			}
-			if(!SQL_SUCCEEDED(SQLEndTran(SQL_HANDLE_DBC, _handle->dbc, SQL_ROLLBACK))) {
-				throw sqlpp::exception("ODBC error: Could not SQLEndTran ROLLBACK("+detail::odbc_error(_handle->dbc, SQL_HANDLE_DBC)+')');
+			try {
+				if(_handle->transaction_depth > 1) {
+					const std::string savepoint = savepoint_name(_handle->transaction_depth - 1);
+					if(_handle->type == ODBC_Type::TSQL) {
+						_handle->exec_direct("ROLLBACK TRANSACTION "+savepoint);
+					} else {
+						_handle->exec_direct("ROLLBACK TO SAVEPOINT "+savepoint);
+						_handle->exec_direct("RELEASE SAVEPOINT "+savepoint);
+					}
+				} else {
+					end_transaction(*_handle, SQL_ROLLBACK);
+				}
+			} catch(const connection_lost&) {
+				_handle->transaction_depth = 0;
+				throw;
 			}
-			set_autocommit(_handle->dbc);
-			_transaction_active = false;
+			--_handle->transaction_depth;
+		}
+		
+		size_t connection::transaction_depth() const {
+			return _handle->transaction_depth;
+		}
+		
+		ODBC_Type connection::type() const {
+			return _handle->type;
 		}
 		
 		void connection::report_rollback_failure(const std::string message) noexcept {
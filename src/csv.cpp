@@ -0,0 +1,1160 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/csv.h>
+#include <sqlpp11/odbc/numeric.h>
+#include <sqlpp11/odbc/pipelined_rowset.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#  include <io.h>
+#  include <sys/stat.h>
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SQLPP11_ODBC_SSE2
+#  include <emmintrin.h>
+#endif
+
+#include <fcntl.h>
+#include <sql.h>
+#include <sqlext.h>
+#include "detail/prepared_statement_handle.h"
+#include "detail/connection_handle.h"
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			const char digit_pairs[] =
+				"00010203040506070809"
+				"10111213141516171819"
+				"20212223242526272829"
+				"30313233343536373839"
+				"40414243444546474849"
+				"50515253545556575859"
+				"60616263646566676869"
+				"70717273747576777879"
+				"80818283848586878889"
+				"90919293949596979899";
+			
+			char* put_two_digits(char* out, unsigned value) {
+				std::memcpy(out, digit_pairs + 2 * value, 2);
+				return out + 2;
+			}
+			
+			char* put_integral(char* out, int64_t value) {
+				uint64_t magnitude = static_cast<uint64_t>(value);
+				if(value < 0) {
+					*out++ = '-';
+					magnitude = 0 - magnitude;
+				}
+				char digits[20];
+				char* const end = digits + sizeof(digits);
+				char* begin = end;
+				while(magnitude >= 100) {
+					begin -= 2;
+					put_two_digits(begin, static_cast<unsigned>(magnitude % 100));
+					magnitude /= 100;
+				}
+				if(magnitude >= 10) {
+					begin -= 2;
+					put_two_digits(begin, static_cast<unsigned>(magnitude));
+				} else {
+					*--begin = static_cast<char>('0' + magnitude);
+				}
+				std::memcpy(out, begin, static_cast<size_t>(end - begin));
+				return out + (end - begin);
+			}
+			
+			//! The shortest of %.15g, %.16g and %.17g that reads back as value, C++11 has no std::to_chars
+			char* put_floating_point(char* out, double value) {
+				if(std::isnan(value)) {
+					std::memcpy(out, "NaN", 3);
+					return out + 3;
+				}
+				if(std::isinf(value)) {
+					const char* text = value < 0 ? "-Infinity" : "Infinity";
+					const size_t length = std::strlen(text);
+					std::memcpy(out, text, length);
+					return out + length;
+				}
+				int length = 0;
+				for(int precision = 15; precision <= 17; ++precision) {
+					length = std::snprintf(out, 32, "%.*g", precision, value);
+					if(std::strtod(out, nullptr) == value) {
+						break;
+					}
+				}
+				return out + length;
+			}
+			
+			char* put_date(char* out, int year, unsigned month, unsigned day) {
+				if(year >= 0 && year < 10000) {
+					out = put_two_digits(out, static_cast<unsigned>(year / 100));
+					out = put_two_digits(out, static_cast<unsigned>(year % 100));
+				} else {
+					out = put_integral(out, year);
+				}
+				*out++ = '-';
+				out = put_two_digits(out, month % 100);
+				*out++ = '-';
+				return put_two_digits(out, day % 100);
+			}
+			
+			char* put_time(char* out, unsigned hour, unsigned minute, unsigned second) {
+				out = put_two_digits(out, hour % 100);
+				*out++ = ':';
+				out = put_two_digits(out, minute % 100);
+				*out++ = ':';
+				return put_two_digits(out, second % 100);
+			}
+			
+			void write_all(int fd, const char* data, size_t size) {
+				while(size > 0) {
+#ifdef _WIN32
+					const int written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+					const ssize_t written = ::write(fd, data, size);
+#endif
+					if(written < 0) {
+						if(errno == EINTR) {
+							continue;
+						}
+						throw sqlpp::exception("ODBC error: couldn't write CSV: "+std::string(std::strerror(errno)));
+					}
+					data += written;
+					size -= static_cast<size_t>(written);
+				}
+			}
+			
+			//! Formats into one buffer, which is written once it holds buffer_size bytes
+			class csv_writer_t {
+				int _fd;
+				const csv_options& _options;
+				std::vector<char> _buffer;
+				size_t _used = 0;
+				
+				//! Room for at least bytes more, the buffer only grows past buffer_size for a row longer than that
+				char* reserve(size_t bytes) {
+					if(_used + bytes > _buffer.size()) {
+						_buffer.resize(std::max(2 * _buffer.size(), _used + bytes));
+					}
+					return _buffer.data() + _used;
+				}
+				
+				void commit(const char* end) {
+					_used = static_cast<size_t>(end - _buffer.data());
+				}
+				
+				bool needs_quotes(const char* text, size_t length) const {
+					if(length == 0) {
+						return true;
+					}
+					for(size_t i = 0; i < length; ++i) {
+						const char c = text[i];
+						if(c == _options.delimiter || c == _options.quote || c == '\n' || c == '\r') {
+							return true;
+						}
+					}
+					return false;
+				}
+				
+			public:
+				csv_writer_t(int fd, const csv_options& options)
+					: _fd(fd)
+					, _options(options)
+					, _buffer(std::max<size_t>(options.buffer_size, 4096) + 4096)
+				{}
+				
+				void append(const char* data, size_t length) {
+					char* out = reserve(length);
+					std::memcpy(out, data, length);
+					commit(out + length);
+				}
+				
+				void delimiter() {
+					*reserve(1) = _options.delimiter;
+					++_used;
+				}
+				
+				void line_end() {
+					append(_options.line_end.data(), _options.line_end.size());
+					if(_used >= _options.buffer_size) {
+						flush();
+					}
+				}
+				
+				void text(const char* text, size_t length) {
+					if(!needs_quotes(text, length)) {
+						append(text, length);
+						return;
+					}
+					//Every character a doubled quote at worst
+					char* out = reserve(2 * length + 2);
+					*out++ = _options.quote;
+					for(size_t i = 0; i < length; ++i) {
+						if(text[i] == _options.quote) {
+							*out++ = _options.quote;
+						}
+						*out++ = text[i];
+					}
+					*out++ = _options.quote;
+					commit(out);
+				}
+				
+				void value(const rowset_block_t& block, size_t column, size_t row) {
+					if(block.is_null(column, row)) {
+						append(_options.null_value.data(), _options.null_value.size());
+						return;
+					}
+					switch(block.column(column).kind) {
+						case column_kind::integral:
+							commit(put_integral(reserve(20), block.values<SQLBIGINT>(column)[row]));
+							break;
+						case column_kind::floating_point:
+							commit(put_floating_point(reserve(32), block.values<SQLDOUBLE>(column)[row]));
+							break;
+						case column_kind::boolean:
+							*reserve(1) = block.values<SQLCHAR>(column)[row] ? '1' : '0';
+							++_used;
+							break;
+						case column_kind::text:
+							text(block.text(column, row), block.text_length(column, row));
+							break;
+						case column_kind::date: {
+							const SQL_DATE_STRUCT& date = block.values<SQL_DATE_STRUCT>(column)[row];
+							commit(put_date(reserve(32), date.year, date.month, date.day));
+							break;
+						}
+						case column_kind::date_time: {
+							const SQL_TIMESTAMP_STRUCT& timestamp = block.values<SQL_TIMESTAMP_STRUCT>(column)[row];
+							char* out = put_date(reserve(48), timestamp.year, timestamp.month, timestamp.day);
+							*out++ = ' ';
+							out = put_time(out, timestamp.hour, timestamp.minute, timestamp.second);
+							//fraction counts nanoseconds, the connector keeps microseconds
+							const unsigned microseconds = static_cast<unsigned>(timestamp.fraction / 1000);
+							if(microseconds) {
+								*out++ = '.';
+								out = put_two_digits(out, microseconds / 10000 % 100);
+								out = put_two_digits(out, microseconds / 100 % 100);
+								out = put_two_digits(out, microseconds % 100);
+							}
+							commit(out);
+							break;
+						}
+						case column_kind::time_of_day: {
+							const SQL_TIME_STRUCT& time = block.values<SQL_TIME_STRUCT>(column)[row];
+							commit(put_time(reserve(16), time.hour, time.minute, time.second));
+							break;
+						}
+						case column_kind::numeric: {
+							const std::string text = block.numeric(column, row).to_string();
+							append(text.data(), text.size());
+							break;
+						}
+					}
+				}
+				
+				void flush() {
+					write_all(_fd, _buffer.data(), _used);
+					_used = 0;
+				}
+			};
+		}
+		
+		size_t export_csv(rowset_t rowset, const std::vector<column_info>& columns, int fd, const csv_options& options) {
+			csv_writer_t out(fd, options);
+			if(options.header) {
+				for(size_t i = 0; i < columns.size(); ++i) {
+					if(i) {
+						out.delimiter();
+					}
+					out.text(columns[i].name.data(), columns[i].name.size());
+				}
+				out.line_end();
+			}
+			size_t rows = 0;
+			pipelined_rowset_t blocks(std::move(rowset), options.rowset.prefetch_blocks);
+			while(rowset_block_t* block = blocks.next()) {
+				const size_t count = block->size();
+				const size_t width = block->column_count();
+				for(size_t row = 0; row < count; ++row) {
+					for(size_t column = 0; column < width; ++column) {
+						if(column) {
+							out.delimiter();
+						}
+						out.value(*block, column, row);
+					}
+					out.line_end();
+				}
+				rows += count;
+			}
+			out.flush();
+			return rows;
+		}
+		
+		size_t export_csv(connection& db, const std::string& statement, int fd, const csv_options& options) {
+			auto prepared = db.prepare_statement(statement);
+			if(!prepared || !*prepared) {
+				throw sqlpp::exception("ODBC error: Could not store result set");
+			}
+			db.execute_statement(*prepared);
+			const std::vector<column_info> columns = describe_columns(*prepared);
+			std::vector<column_kind> kinds;
+			for(const column_info& column : columns) {
+				kinds.push_back(column.kind);
+			}
+			return export_csv(rowset_t(prepared, kinds, db.rowset_defaults(options.rowset)), columns, fd, options);
+		}
+		
+		namespace detail {
+			csv_file_t::csv_file_t(const std::string& path) {
+#ifdef _WIN32
+				_fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+				_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#endif
+				if(_fd < 0) {
+					throw sqlpp::exception("ODBC error: couldn't open "+path+" for CSV: "+std::string(std::strerror(errno)));
+				}
+			}
+			
+			csv_file_t::~csv_file_t() {
+				if(_fd >= 0) {
+#ifdef _WIN32
+					_close(_fd);
+#else
+					::close(_fd);
+#endif
+				}
+			}
+			
+			void csv_file_t::close() {
+#ifdef _WIN32
+				const int result = _close(_fd);
+#else
+				const int result = ::close(_fd);
+#endif
+				_fd = -1;
+				if(result != 0) {
+					throw sqlpp::exception("ODBC error: couldn't close CSV file: "+std::string(std::strerror(errno)));
+				}
+			}
+		}
+		
+		namespace {
+			//! A file mapped read-only into memory, the pages are read by the OS as the parser gets to them
+			class mapped_file_t {
+				const char* _data = nullptr;
+				size_t _size = 0;
+#ifdef _WIN32
+				HANDLE _file = INVALID_HANDLE_VALUE;
+				HANDLE _mapping = nullptr;
+#endif
+				
+			public:
+				explicit mapped_file_t(const std::string& path) {
+#ifdef _WIN32
+					_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+					if(_file == INVALID_HANDLE_VALUE) {
+						throw sqlpp::exception("ODBC error: couldn't open "+path+" for import_csv");
+					}
+					LARGE_INTEGER size;
+					if(!GetFileSizeEx(_file, &size)) {
+						CloseHandle(_file);
+						throw sqlpp::exception("ODBC error: couldn't get the size of "+path);
+					}
+					_size = static_cast<size_t>(size.QuadPart);
+					if(_size > 0) {
+						_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+						_data = _mapping ? static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+						if(!_data) {
+							if(_mapping) {
+								CloseHandle(_mapping);
+							}
+							CloseHandle(_file);
+							throw sqlpp::exception("ODBC error: couldn't map "+path+" into memory");
+						}
+					}
+#else
+					const int fd = ::open(path.c_str(), O_RDONLY);
+					if(fd < 0) {
+						throw sqlpp::exception("ODBC error: couldn't open "+path+" for import_csv: "+std::string(std::strerror(errno)));
+					}
+					struct stat info;
+					if(fstat(fd, &info) != 0) {
+						const int error = errno;
+						::close(fd);
+						throw sqlpp::exception("ODBC error: couldn't get the size of "+path+": "+std::string(std::strerror(error)));
+					}
+					_size = static_cast<size_t>(info.st_size);
+					if(_size > 0) {
+						void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+						if(data == MAP_FAILED) {
+							const int error = errno;
+							::close(fd);
+							throw sqlpp::exception("ODBC error: couldn't map "+path+" into memory: "+std::string(std::strerror(error)));
+						}
+						madvise(data, _size, MADV_SEQUENTIAL);
+						_data = static_cast<const char*>(data);
+					}
+					::close(fd);
+#endif
+				}
+				
+				mapped_file_t(const mapped_file_t&) = delete;
+				mapped_file_t& operator=(const mapped_file_t&) = delete;
+				
+				~mapped_file_t() {
+#ifdef _WIN32
+					if(_data) {
+						UnmapViewOfFile(_data);
+					}
+					if(_mapping) {
+						CloseHandle(_mapping);
+					}
+					CloseHandle(_file);
+#else
+					if(_data) {
+						munmap(const_cast<char*>(_data), _size);
+					}
+#endif
+				}
+				
+				const char* data() const {
+					return _data;
+				}
+				
+				size_t size() const {
+					return _size;
+				}
+			};
+			
+			//! The first delimiter, '\n' or '\r' in [pos, end), or end
+			const char* find_field_end(const char* pos, const char* end, char delimiter) {
+#ifdef SQLPP11_ODBC_SSE2
+				const __m128i delimiters = _mm_set1_epi8(delimiter);
+				const __m128i line_feeds = _mm_set1_epi8('\n');
+				const __m128i carriage_returns = _mm_set1_epi8('\r');
+				while(end - pos >= 16) {
+					const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+					const int found = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, delimiters),
+						_mm_or_si128(_mm_cmpeq_epi8(chars, line_feeds), _mm_cmpeq_epi8(chars, carriage_returns))));
+					if(found) {
+#ifdef _MSC_VER
+						unsigned long index;
+						_BitScanForward(&index, static_cast<unsigned long>(found));
+						return pos + index;
+#else
+						return pos + __builtin_ctz(static_cast<unsigned>(found));
+#endif
+					}
+					pos += 16;
+				}
+#endif
+				while(pos < end && *pos != delimiter && *pos != '\n' && *pos != '\r') {
+					++pos;
+				}
+				return pos;
+			}
+			
+			struct field_t {
+				const char* data;
+				size_t length;
+				bool quoted;
+			};
+			
+			//! Splits the mapped file into rows of fields. Unquoted fields and quoted ones without doubled quotes point
+			// into the file, the others into storage of the parser that is reused for the next row.
+			class csv_parser_t {
+				const char* _pos;
+				const char* _end;
+				char _delimiter;
+				char _quote;
+				size_t _line = 1;
+				size_t _row_line = 1;
+				std::string _error;
+				std::deque<std::string> _unquoted;
+				size_t _unquoted_used = 0;
+				
+				std::string& unquoted() {
+					if(_unquoted_used == _unquoted.size()) {
+						_unquoted.emplace_back();
+					}
+					std::string& text = _unquoted[_unquoted_used++];
+					text.clear();
+					return text;
+				}
+				
+				void skip_line() {
+					const char* line_end = static_cast<const char*>(std::memchr(_pos, '\n', static_cast<size_t>(_end - _pos)));
+					_pos = line_end ? line_end + 1 : _end;
+					++_line;
+				}
+				
+				field_t quoted_field() {
+					const char* begin = ++_pos;
+					std::string* text = nullptr;
+					while(true) {
+						const char* quote = static_cast<const char*>(std::memchr(_pos, _quote, static_cast<size_t>(_end - _pos)));
+						if(!quote) {
+							throw sqlpp::exception("ODBC error: quoted field starting on line "+std::to_string(_row_line)+" is not closed");
+						}
+						_line += static_cast<size_t>(std::count(_pos, quote, '\n'));
+						if(quote + 1 < _end && quote[1] == _quote) {
+							if(!text) {
+								text = &unquoted();
+							}
+							text->append(_pos, quote + 1);
+							_pos = quote + 2;
+							continue;
+						}
+						field_t field = {begin, static_cast<size_t>(quote - begin), true};
+						if(text) {
+							text->append(_pos, quote);
+							field.data = text->data();
+							field.length = text->size();
+						}
+						_pos = quote + 1;
+						return field;
+					}
+				}
+				
+			public:
+				csv_parser_t(const char* data, size_t size, const csv_import_options& options)
+					: _pos(data)
+					, _end(data + size)
+					, _delimiter(options.delimiter)
+					, _quote(options.quote)
+				{}
+				
+				//! Fields of the next row, false at the end of the input. If error() isn't empty, the row is malformed.
+				bool next_row(std::vector<field_t>& fields) {
+					fields.clear();
+					_error.clear();
+					_unquoted_used = 0;
+					if(_pos >= _end) {
+						return false;
+					}
+					_row_line = _line;
+					while(true) {
+						if(_pos < _end && *_pos == _quote) {
+							fields.push_back(quoted_field());
+							if(_pos < _end && *_pos != _delimiter && *_pos != '\n' && *_pos != '\r') {
+								_error = "unexpected characters after the quoted field "+std::to_string(fields.size());
+								skip_line();
+								return true;
+							}
+						} else {
+							const char* end = find_field_end(_pos, _end, _delimiter);
+							fields.push_back(field_t{_pos, static_cast<size_t>(end - _pos), false});
+							_pos = end;
+						}
+						if(_pos >= _end) {
+							return true;
+						}
+						if(*_pos == _delimiter) {
+							++_pos;
+							continue;
+						}
+						if(*_pos == '\r') {
+							++_pos;
+						}
+						if(_pos < _end && *_pos == '\n') {
+							++_pos;
+						}
+						++_line;
+						return true;
+					}
+				}
+				
+				//! Line the last row started on
+				size_t line() const {
+					return _row_line;
+				}
+				
+				const std::string& error() const {
+					return _error;
+				}
+			};
+			
+			bool read_digits(const char*& pos, const char* end, size_t count, unsigned& value) {
+				if(static_cast<size_t>(end - pos) < count) {
+					return false;
+				}
+				value = 0;
+				for(size_t i = 0; i < count; ++i, ++pos) {
+					if(*pos < '0' || *pos > '9') {
+						return false;
+					}
+					value = value * 10 + static_cast<unsigned>(*pos - '0');
+				}
+				return true;
+			}
+			
+			bool read_char(const char*& pos, const char* end, char c) {
+				if(pos < end && *pos == c) {
+					++pos;
+					return true;
+				}
+				return false;
+			}
+			
+			bool parse_integral(const char* pos, const char* end, int64_t& value) {
+				const bool negative = pos < end && *pos == '-';
+				if(pos < end && (*pos == '-' || *pos == '+')) {
+					++pos;
+				}
+				if(pos == end) {
+					return false;
+				}
+				const uint64_t limit = negative ? UINT64_C(9223372036854775808) : UINT64_C(9223372036854775807);
+				uint64_t magnitude = 0;
+				for(; pos < end; ++pos) {
+					if(*pos < '0' || *pos > '9') {
+						return false;
+					}
+					const unsigned digit = static_cast<unsigned>(*pos - '0');
+					if(magnitude > (limit - digit) / 10) {
+						return false;
+					}
+					magnitude = magnitude * 10 + digit;
+				}
+				value = static_cast<int64_t>(negative ? 0 - magnitude : magnitude);
+				return true;
+			}
+			
+			bool parse_floating_point(const char* pos, const char* end, double& value) {
+				char text[64];
+				const size_t length = static_cast<size_t>(end - pos);
+				if(length == 0 || length >= sizeof(text)) {
+					return false;
+				}
+				std::memcpy(text, pos, length);
+				text[length] = '\0';
+				char* parsed;
+				value = std::strtod(text, &parsed);
+				return parsed == text + length;
+			}
+			
+			bool parse_boolean(const char* pos, const char* end, SQLCHAR& value) {
+				const std::string text(pos, end);
+				if(text == "1" || text == "true" || text == "TRUE" || text == "t") {
+					value = 1;
+				} else if(text == "0" || text == "false" || text == "FALSE" || text == "f") {
+					value = 0;
+				} else {
+					return false;
+				}
+				return true;
+			}
+			
+			bool parse_date(const char*& pos, const char* end, SQL_DATE_STRUCT& date) {
+				unsigned year, month, day;
+				if(!read_digits(pos, end, 4, year) || !read_char(pos, end, '-') || !read_digits(pos, end, 2, month) ||
+					!read_char(pos, end, '-') || !read_digits(pos, end, 2, day) || month < 1 || month > 12 || day < 1 || day > 31) {
+					return false;
+				}
+				date.year = static_cast<SQLSMALLINT>(year);
+				date.month = static_cast<SQLUSMALLINT>(month);
+				date.day = static_cast<SQLUSMALLINT>(day);
+				return true;
+			}
+			
+			//! HH:MM:SS with an optional fraction of up to 9 digits, in nanoseconds
+			bool parse_time(const char*& pos, const char* end, SQL_TIME_STRUCT& time, SQLUINTEGER& fraction) {
+				unsigned hour, minute, second;
+				if(!read_digits(pos, end, 2, hour) || !read_char(pos, end, ':') || !read_digits(pos, end, 2, minute) ||
+					!read_char(pos, end, ':') || !read_digits(pos, end, 2, second) || hour > 23 || minute > 59 || second > 60) {
+					return false;
+				}
+				time.hour = static_cast<SQLUSMALLINT>(hour);
+				time.minute = static_cast<SQLUSMALLINT>(minute);
+				time.second = static_cast<SQLUSMALLINT>(second);
+				fraction = 0;
+				if(read_char(pos, end, '.')) {
+					unsigned digits = 0;
+					for(; pos < end && *pos >= '0' && *pos <= '9'; ++pos, ++digits) {
+						if(digits < 9) {
+							fraction = fraction * 10 + static_cast<SQLUINTEGER>(*pos - '0');
+						}
+					}
+					if(digits == 0) {
+						return false;
+					}
+					for(; digits < 9; ++digits) {
+						fraction *= 10;
+					}
+				}
+				return true;
+			}
+			
+			bool parse_timestamp(const char* pos, const char* end, SQL_TIMESTAMP_STRUCT& timestamp) {
+				SQL_DATE_STRUCT date;
+				if(!parse_date(pos, end, date)) {
+					return false;
+				}
+				timestamp.year = date.year;
+				timestamp.month = date.month;
+				timestamp.day = date.day;
+				SQL_TIME_STRUCT time = {0, 0, 0};
+				timestamp.fraction = 0;
+				if(pos < end && (*pos == ' ' || *pos == 'T') && !parse_time(++pos, end, time, timestamp.fraction)) {
+					return false;
+				}
+				timestamp.hour = time.hour;
+				timestamp.minute = time.minute;
+				timestamp.second = time.second;
+				return pos == end;
+			}
+			
+			//! Bytes per value in a parameter array, 0 for the kinds sent as text, whose width depends on the batch
+			size_t parameter_width(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return sizeof(SQLBIGINT);
+					case column_kind::floating_point: return sizeof(SQLDOUBLE);
+					case column_kind::boolean: return sizeof(SQLCHAR);
+					case column_kind::date: return sizeof(SQL_DATE_STRUCT);
+					case column_kind::date_time: return sizeof(SQL_TIMESTAMP_STRUCT);
+					case column_kind::time_of_day: return sizeof(SQL_TIME_STRUCT);
+					default: return 0;
+				}
+			}
+			
+			const char* kind_name(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return "an integer";
+					case column_kind::floating_point: return "a number";
+					case column_kind::boolean: return "a boolean";
+					case column_kind::date: return "a date";
+					case column_kind::date_time: return "a timestamp";
+					case column_kind::time_of_day: return "a time";
+					default: return "text";
+				}
+			}
+			
+			//! A column of a batch, laid out as the parameter array it is bound as
+			struct batch_column_t {
+				column_kind kind;
+				//Bytes per value, for text the longest value of the batch and its terminator once the batch is packed
+				size_t width;
+				std::vector<char> values;
+				std::vector<SQLLEN> indicators;
+				//Text as parsed, one value after another, copied into values by pack()
+				std::string heap;
+				std::vector<size_t> offsets;
+				size_t longest = 0;
+			};
+			
+			struct batch_t {
+				std::vector<batch_column_t> columns;
+				//Line each row starts on
+				std::vector<size_t> lines;
+				size_t rows = 0;
+				std::vector<csv_row_error> errors;
+				
+				batch_t(const std::vector<column_info>& infos, size_t capacity) {
+					for(const column_info& info : infos) {
+						batch_column_t column;
+						column.kind = info.kind;
+						column.width = parameter_width(info.kind);
+						column.values.resize(capacity * column.width);
+						column.indicators.resize(capacity);
+						columns.push_back(std::move(column));
+					}
+				}
+				
+				void clear() {
+					lines.clear();
+					rows = 0;
+					errors.clear();
+					for(batch_column_t& column : columns) {
+						if(!parameter_width(column.kind)) {
+							column.heap.clear();
+							column.offsets.clear();
+							column.longest = 0;
+						}
+					}
+				}
+				
+				//! Drops the text of a row that didn't parse
+				void discard_row() {
+					for(batch_column_t& column : columns) {
+						if(column.offsets.size() > rows) {
+							column.heap.resize(column.offsets[rows]);
+							column.offsets.resize(rows);
+						}
+					}
+				}
+				
+				//! Lays the text columns out at the width of their longest value
+				void pack() {
+					for(batch_column_t& column : columns) {
+						if(parameter_width(column.kind)) {
+							continue;
+						}
+						column.width = column.longest + 1;
+						column.values.resize(rows * column.width);
+						for(size_t row = 0; row < rows; ++row) {
+							char* value = column.values.data() + row * column.width;
+							if(column.indicators[row] == SQL_NULL_DATA) {
+								*value = '\0';
+								continue;
+							}
+							const size_t length = static_cast<size_t>(column.indicators[row]);
+							std::memcpy(value, column.heap.data() + column.offsets[row], length);
+							value[length] = '\0';
+						}
+					}
+				}
+			};
+			
+			//! Parses the fields of a row into the next row of the batch, returns what's wrong with them if they don't parse
+			std::string parse_row(batch_t& batch, const std::vector<field_t>& fields, const std::vector<column_info>& columns, const std::string& null_value) {
+				if(fields.size() != columns.size()) {
+					return "expected "+std::to_string(columns.size())+" fields, found "+std::to_string(fields.size());
+				}
+				const size_t row = batch.rows;
+				for(size_t i = 0; i < fields.size(); ++i) {
+					batch_column_t& column = batch.columns[i];
+					const field_t& field = fields[i];
+					const char* begin = field.data;
+					const char* end = field.data + field.length;
+					SQLLEN& indicator = column.indicators[row];
+					const bool text = !parameter_width(column.kind);
+					if(text) {
+						column.offsets.push_back(column.heap.size());
+					}
+					if(!field.quoted && field.length == null_value.size() && std::equal(begin, end, null_value.begin())) {
+						indicator = SQL_NULL_DATA;
+						continue;
+					}
+					indicator = static_cast<SQLLEN>(column.width);
+					char* value = column.values.data() + row * column.width;
+					bool parsed = true;
+					switch(column.kind) {
+						case column_kind::integral: {
+							int64_t integral;
+							if((parsed = parse_integral(begin, end, integral))) {
+								const SQLBIGINT bigint = integral;
+								std::memcpy(value, &bigint, sizeof(bigint));
+							}
+							break;
+						}
+						case column_kind::floating_point: {
+							double number;
+							if((parsed = parse_floating_point(begin, end, number))) {
+								std::memcpy(value, &number, sizeof(number));
+							}
+							break;
+						}
+						case column_kind::boolean:
+							parsed = parse_boolean(begin, end, *reinterpret_cast<SQLCHAR*>(value));
+							break;
+						case column_kind::date: {
+							SQL_DATE_STRUCT date;
+							if((parsed = parse_date(begin, end, date) && begin == end)) {
+								std::memcpy(value, &date, sizeof(date));
+							}
+							break;
+						}
+						case column_kind::date_time: {
+							SQL_TIMESTAMP_STRUCT timestamp;
+							if((parsed = parse_timestamp(begin, end, timestamp))) {
+								std::memcpy(value, &timestamp, sizeof(timestamp));
+							}
+							break;
+						}
+						case column_kind::time_of_day: {
+							SQL_TIME_STRUCT time;
+							SQLUINTEGER fraction;
+							if((parsed = parse_time(begin, end, time, fraction) && begin == end)) {
+								std::memcpy(value, &time, sizeof(time));
+							}
+							break;
+						}
+						case column_kind::text:
+						case column_kind::numeric:
+							column.heap.append(field.data, field.length);
+							column.longest = std::max(column.longest, field.length);
+							indicator = static_cast<SQLLEN>(field.length);
+							break;
+					}
+					if(!parsed) {
+						batch.discard_row();
+						return "column "+columns[i].name+": '"+std::string(field.data, field.length)+"' is not "+kind_name(column.kind);
+					}
+				}
+				++batch.rows;
+				return std::string();
+			}
+			
+			//! Parses rows into the batch until it holds batch_size of them (including the ones that didn't parse) or the input ends
+			void parse_batch(csv_parser_t& parser, batch_t& batch, const std::vector<column_info>& columns, const csv_import_options& options) {
+				batch.clear();
+				std::vector<field_t> fields;
+				while(batch.rows + batch.errors.size() < options.batch_size && parser.next_row(fields)) {
+					if(!parser.error().empty()) {
+						batch.errors.push_back(csv_row_error{parser.line(), parser.error()});
+						continue;
+					}
+					//Blank lines
+					if(fields.size() == 1 && fields.front().length == 0 && !fields.front().quoted) {
+						continue;
+					}
+					const size_t line = parser.line();
+					std::string error = parse_row(batch, fields, columns, options.null_value);
+					if(error.empty()) {
+						batch.lines.push_back(line);
+					} else {
+						batch.errors.push_back(csv_row_error{line, std::move(error)});
+					}
+				}
+				batch.pack();
+			}
+			
+			//! Binds the columns of a batch to the prepared INSERT and executes it, as parameter arrays if the driver takes them
+			class inserter_t {
+				detail::prepared_statement_handle_t& _prepared;
+				std::function<void()> _execute;
+				const std::vector<column_info>& _columns;
+				bool _arrays = false;
+				std::vector<SQLUSMALLINT> _status;
+				SQLULEN _processed = 0;
+				
+				void bind(batch_t& batch, size_t first) {
+					for(size_t i = 0; i < batch.columns.size(); ++i) {
+						batch_column_t& column = batch.columns[i];
+						SQLSMALLINT c_type = SQL_C_CHAR;
+						SQLSMALLINT sql_type = SQL_VARCHAR;
+						SQLULEN size = std::max<size_t>(column.width - 1, 1);
+						SQLSMALLINT digits = 0;
+						switch(column.kind) {
+							case column_kind::integral: c_type = SQL_C_SBIGINT; sql_type = SQL_BIGINT; size = 19; break;
+							case column_kind::floating_point: c_type = SQL_C_DOUBLE; sql_type = SQL_DOUBLE; size = 15; break;
+							case column_kind::boolean: c_type = SQL_C_BIT; sql_type = SQL_BIT; size = 1; break;
+							case column_kind::date: c_type = SQL_C_TYPE_DATE; sql_type = SQL_TYPE_DATE; size = 10; break;
+							case column_kind::date_time: c_type = SQL_C_TYPE_TIMESTAMP; sql_type = SQL_TYPE_TIMESTAMP; size = 29; digits = 9; break;
+							case column_kind::time_of_day: c_type = SQL_C_TYPE_TIME; sql_type = SQL_TYPE_TIME; size = 8; break;
+							case column_kind::text: break;
+							case column_kind::numeric:
+								sql_type = SQL_NUMERIC;
+								if(_columns[i].precision) {
+									size = _columns[i].precision;
+									digits = static_cast<SQLSMALLINT>(_columns[i].scale);
+								}
+								break;
+						}
+						const SQLRETURN rc = _prepared.bind_parameter(i, c_type, sql_type, size, digits,
+							column.values.data() + first * column.width, static_cast<SQLLEN>(column.width), column.indicators.data() + first);
+						if(!SQL_SUCCEEDED(rc)) {
+							throw sqlpp::exception("ODBC error: couldn't bind column "+_columns[i].name+" for import_csv: "+detail::odbc_error(_prepared.stmt, SQL_HANDLE_STMT));
+						}
+					}
+				}
+				
+			public:
+				inserter_t(detail::prepared_statement_handle_t& prepared, std::function<void()> execute, const std::vector<column_info>& columns, size_t batch_size)
+					: _prepared(prepared)
+					, _execute(std::move(execute))
+					, _columns(columns)
+					, _status(batch_size)
+				{
+					_arrays = batch_size > 1 && detail::set_parameter_array(_prepared, batch_size, _status.data(), &_processed) > 1;
+					if(!_arrays) {
+						detail::set_parameter_array(_prepared, 1, nullptr, nullptr);
+					}
+				}
+				inserter_t(const inserter_t&) = delete;
+				inserter_t& operator=(const inserter_t&) = delete;
+				
+				//! Inserts the rows of the batch and returns how many went in, the rejected ones are added to its errors
+				size_t insert(batch_t& batch) {
+					size_t inserted = 0;
+					//Set when the driver failed an array without telling which rows, they are then retried one at a time
+					bool single = !_arrays;
+					for(size_t first = 0; first < batch.rows;) {
+						size_t sets = single ? 1 : batch.rows - first;
+						bind(batch, first);
+						if(_arrays) {
+							//The driver may take fewer sets than the batch has left, the rest goes with the next execution
+							sets = detail::set_parameter_array(_prepared, sets, _status.data(), &_processed);
+							std::fill(_status.begin(), _status.end(), static_cast<SQLUSMALLINT>(SQL_PARAM_UNUSED));
+							_processed = 0;
+						}
+						try {
+							_execute();
+							if(!_arrays) {
+								++inserted;
+								++first;
+								continue;
+							}
+							//SQL_SUCCESS_WITH_INFO may still come with failed sets, drivers that don't count processed sets ran all of them
+							const size_t processed = _processed == 0 ? sets : std::min<size_t>(_processed, sets);
+							std::string message;
+							for(size_t i = 0; i < processed; ++i) {
+								if(_status[i] == SQL_PARAM_ERROR) {
+									if(message.empty()) {
+										message = "ODBC error: the driver rejected the row: "+detail::odbc_error(_prepared.stmt, SQL_HANDLE_STMT);
+									}
+									batch.errors.push_back(csv_row_error{batch.lines[first + i], message});
+								} else {
+									++inserted;
+								}
+							}
+							first += processed;
+						} catch(const sqlpp::exception& e) {
+							if(sets == 1) {
+								batch.errors.push_back(csv_row_error{batch.lines[first], e.what()});
+								++first;
+								continue;
+							}
+							const size_t processed = std::min<size_t>(_processed, sets);
+							if(processed == 0) {
+								single = true;
+								continue;
+							}
+							//Rows up to the processed ones ran, without status only the last of them is known to have failed
+							const bool reported = std::find(_status.begin(), _status.begin() + processed, static_cast<SQLUSMALLINT>(SQL_PARAM_ERROR)) != _status.begin() + processed;
+							for(size_t i = 0; i < processed; ++i) {
+								if(_status[i] == SQL_PARAM_ERROR || (!reported && i + 1 == processed)) {
+									batch.errors.push_back(csv_row_error{batch.lines[first + i], e.what()});
+								} else {
+									++inserted;
+								}
+							}
+							first += processed;
+						}
+					}
+					return inserted;
+				}
+			};
+			
+			bool same_name(const std::string& lhs, const std::string& rhs) {
+				return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](char l, char r) {
+					return std::tolower(static_cast<unsigned char>(l)) == std::tolower(static_cast<unsigned char>(r));
+				});
+			}
+		}
+		
+		csv_import_result import_csv(connection& db, const std::string& table, const std::vector<column_info>& columns, const std::string& path, const csv_import_options& options) {
+			if(options.batch_size == 0) {
+				throw sqlpp::exception("ODBC error: csv_import_options::batch_size must be above 0");
+			}
+			mapped_file_t file(path);
+			csv_parser_t parser(file.data(), file.size(), options);
+			//The table's columns in the order of the fields
+			std::vector<column_info> targets;
+			if(options.header) {
+				std::vector<field_t> fields;
+				if(!parser.next_row(fields)) {
+					return csv_import_result();
+				}
+				if(!parser.error().empty()) {
+					throw sqlpp::exception("ODBC error: CSV header of "+path+": "+parser.error());
+				}
+				for(const field_t& field : fields) {
+					const std::string name(field.data, field.length);
+					auto column = std::find_if(columns.begin(), columns.end(), [&name](const column_info& info) {
+						return same_name(info.name, name);
+					});
+					if(column == columns.end()) {
+						throw sqlpp::exception("ODBC error: "+name+" of the CSV header is not a column of "+table);
+					}
+					targets.push_back(*column);
+				}
+			} else {
+				targets = columns;
+			}
+			std::string statement = "INSERT INTO " + table + " (";
+			std::string markers;
+			for(size_t i = 0; i < targets.size(); ++i) {
+				statement += (i ? ", " : "") + targets[i].name;
+				markers += i ? ", ?" : "?";
+			}
+			statement += ") VALUES (" + markers + ")";
+			
+			auto prepared = db.prepare_statement(statement);
+			inserter_t inserter(*prepared, [&db, &prepared]() {
+				db.execute_statement(*prepared);
+			}, targets, options.batch_size);
+			//One batch is parsed while the other one is inserted
+			batch_t batches[2] = {batch_t(targets, options.batch_size), batch_t(targets, options.batch_size)};
+			csv_import_result result;
+			size_t current = 0;
+			parse_batch(parser, batches[current], targets, options);
+			while(batches[current].rows > 0 || !batches[current].errors.empty()) {
+				batch_t& inserting = batches[current];
+				batch_t& parsing = batches[1 - current];
+				if(options.pipeline) {
+					std::future<size_t> inserted = std::async(std::launch::async, [&inserter, &inserting]() {
+						return inserter.insert(inserting);
+					});
+					parse_batch(parser, parsing, targets, options);
+					result.rows += inserted.get();
+				} else {
+					result.rows += inserter.insert(inserting);
+					parse_batch(parser, parsing, targets, options);
+				}
+				std::stable_sort(inserting.errors.begin(), inserting.errors.end(), [](const csv_row_error& lhs, const csv_row_error& rhs) {
+					return lhs.line < rhs.line;
+				});
+				result.errors.insert(result.errors.end(), inserting.errors.begin(), inserting.errors.end());
+				if(result.errors.size() > options.max_errors) {
+					const csv_row_error& error = result.errors[options.max_errors];
+					throw sqlpp::exception("ODBC error: import_csv stopped at line "+std::to_string(error.line)+" of "+path+": "+error.message);
+				}
+				current = 1 - current;
+			}
+			return result;
+		}
+	}
+}
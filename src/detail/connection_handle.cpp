@@ -26,12 +26,17 @@
  */
 
 #include "connection_handle.h"
+#include "prepared_statement_handle.h"
+#include <sqlpp11/odbc/exception.h>
 #include <sqlpp11/odbc/prepared_statement.h>
 #include <sqlext.h>
 #include <sqltypes.h>
 #include <sqlpp11/exception.h>
+#include <algorithm>
+#include <iostream>
 #include <vector>
 #include <memory>
+#include <sstream>
 
 namespace sqlpp {
 	namespace odbc {
@@ -94,12 +99,80 @@ namespace sqlpp {
 				return ret;
 			}
 			
+			std::string sqlstate(SQLHANDLE handle, SQLSMALLINT handle_type) {
+				SQLCHAR state[6] = {};
+				SQLINTEGER native_error;
+				SQLSMALLINT length;
+				if(!SQL_SUCCEEDED(SQLGetDiagRec(handle_type, handle, 1, state, &native_error, nullptr, 0, &length))) {
+					return std::string();
+				}
+				return reinterpret_cast<const char*>(state);
+			}
+			
+			void throw_error(const std::string& message, const std::string& sqlstate) {
+				if(sqlstate.compare(0, 2, "08") == 0) {
+					throw connection_lost(message);
+				} else if(sqlstate == "HYT00" || sqlstate == "HYT01") {
+					throw timeout_expired(message);
+				} else if(sqlstate == "HY008") {
+					throw query_cancelled(message);
+				}
+				throw sqlpp::exception(message);
+			}
+			
+			void set_numeric_descriptor(SQLHSTMT stmt, SQLINTEGER descriptor, SQLSMALLINT record, SQLSMALLINT precision, SQLSMALLINT scale, SQLPOINTER data) {
+				SQLHDESC desc = nullptr;
+				if(!SQL_SUCCEEDED(SQLGetStmtAttr(stmt, descriptor, &desc, 0, nullptr))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLGetStmtAttr(application descriptor): "+odbc_error(stmt, SQL_HANDLE_STMT));
+				}
+				//Setting any field but SQL_DESC_DATA_PTR unbinds the record, so the data pointer goes last
+				if(!SQL_SUCCEEDED(SQLSetDescField(desc, record, SQL_DESC_TYPE, (SQLPOINTER)SQL_C_NUMERIC, 0)) ||
+					!SQL_SUCCEEDED(SQLSetDescField(desc, record, SQL_DESC_PRECISION, (SQLPOINTER)(SQLLEN)precision, 0)) ||
+					!SQL_SUCCEEDED(SQLSetDescField(desc, record, SQL_DESC_SCALE, (SQLPOINTER)(SQLLEN)scale, 0)) ||
+					(data && !SQL_SUCCEEDED(SQLSetDescField(desc, record, SQL_DESC_DATA_PTR, data, 0)))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLSetDescField("+std::to_string(record)+", SQL_C_NUMERIC): "+odbc_error(desc, SQL_HANDLE_DESC));
+				}
+			}
+			
+			namespace {
+				//! Sets the array attributes on a statement handle, returns the sets the driver took
+				size_t apply_parameter_array(SQLHSTMT stmt, size_t size, SQLUSMALLINT* status, SQLULEN* processed) {
+					size_t sets = 1;
+					if(size > 1
+						&& SQL_SUCCEEDED(SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER)SQL_PARAM_BIND_BY_COLUMN, 0))
+						&& SQL_SUCCEEDED(SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)(SQLULEN)size, 0))) {
+						sets = size;
+						//Drivers may lower the number of sets (01S02 Option value changed)
+						SQLULEN capacity = 0;
+						if(SQL_SUCCEEDED(SQLGetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, &capacity, 0, nullptr)) && capacity > 0) {
+							sets = std::min<size_t>(size, capacity);
+						}
+					} else {
+						SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, 0);
+					}
+					if(!SQL_SUCCEEDED(SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_STATUS_PTR, status, 0)) ||
+						!SQL_SUCCEEDED(SQLSetStmtAttr(stmt, SQL_ATTR_PARAMS_PROCESSED_PTR, processed, 0))) {
+						throw sqlpp::exception("ODBC error: couldn't set SQL_ATTR_PARAM_STATUS_PTR or SQL_ATTR_PARAMS_PROCESSED_PTR: "+odbc_error(stmt, SQL_HANDLE_STMT));
+					}
+					return sets;
+				}
+			}
+			
+			size_t set_parameter_array(prepared_statement_handle_t& statement, size_t size, SQLUSMALLINT* status, SQLULEN* processed) {
+				statement.parameter_array.size = apply_parameter_array(statement.stmt, size, status, processed);
+				statement.parameter_array.status = status;
+				statement.parameter_array.processed = processed;
+				return statement.parameter_array.size;
+			}
+			
 			connection_handle_t::connection_handle_t(bool _debug, ODBC_Type _type)
 				: env(nullptr)
 				, dbc(nullptr)
 				, debug(_debug)
 				, type(_type)
+				, running(std::make_shared<running_state_t>())
 			{
+				running->debug = debug;
 				if(!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &env)) || env == nullptr) {
 					throw sqlpp::exception("ODBC error: couldn't SQLAllocHandle(SQL_HANDLE_ENV)");
 				}else if(!SQL_SUCCEEDED(SQLSetEnvAttr(env, SQL_ATTR_ODBC_VERSION, (SQLPOINTER)SQL_OV_ODBC3, 0))) {
@@ -119,16 +192,92 @@ namespace sqlpp {
 				}
 			}
 
+			void connection_handle_t::apply_statement_options(SQLHSTMT stmt) {
+				std::vector<std::pair<SQLINTEGER, SQLULEN>> attributes;
+				switch(options.cursor) {
+					case cursor_type::forward_only:
+						attributes.emplace_back(SQL_ATTR_CURSOR_TYPE, SQL_CURSOR_FORWARD_ONLY);
+						break;
+					case cursor_type::static_cursor:
+						attributes.emplace_back(SQL_ATTR_CURSOR_TYPE, SQL_CURSOR_STATIC);
+						break;
+					case cursor_type::keyset_driven:
+						attributes.emplace_back(SQL_ATTR_CURSOR_TYPE, SQL_CURSOR_KEYSET_DRIVEN);
+						break;
+					case cursor_type::dynamic:
+						attributes.emplace_back(SQL_ATTR_CURSOR_TYPE, SQL_CURSOR_DYNAMIC);
+						break;
+					default:
+						break;
+				}
+				if(options.read_only) {
+					attributes.emplace_back(SQL_ATTR_CONCURRENCY, SQL_CONCUR_READ_ONLY);
+				}
+				if(options.max_rows) {
+					attributes.emplace_back(SQL_ATTR_MAX_ROWS, options.max_rows);
+				}
+				if(options.query_timeout) {
+					attributes.emplace_back(SQL_ATTR_QUERY_TIMEOUT, options.query_timeout);
+				}
+				if(options.noscan) {
+					attributes.emplace_back(SQL_ATTR_NOSCAN, SQL_NOSCAN_ON);
+				}
+				for(const auto& attribute : options.attributes) {
+					attributes.emplace_back(attribute.first, attribute.second);
+				}
+				for(const auto& attribute : attributes) {
+					if(debug) {
+						std::cerr << "ODBC debug: SQLSetStmtAttr(" << attribute.first << ", " << attribute.second << ')' << std::endl;
+					}
+					//SQL_SUCCESS_WITH_INFO means the driver substituted a similar value (01S02), which is fine
+					if(!SQL_SUCCEEDED(SQLSetStmtAttr(stmt, attribute.first, reinterpret_cast<SQLPOINTER>(attribute.second), 0))) {
+						throw sqlpp::exception("ODBC error: couldn't SQLSetStmtAttr("+std::to_string(attribute.first)+", "+std::to_string(attribute.second)+"): "+odbc_error(stmt, SQL_HANDLE_STMT));
+					}
+				}
+			}
+
+			void connection_handle_t::set_autocommit(bool on) {
+				if(autocommit == on) {
+					return;
+				}
+				if(debug) {
+					std::cerr << "ODBC debug: Setting AUTOCOMMIT to " << (on ? "TRUE" : "FALSE") << std::endl;
+				}
+				if(!SQL_SUCCEEDED(SQLSetConnectAttr(dbc, SQL_ATTR_AUTOCOMMIT, on ? SQLPOINTER(SQL_AUTOCOMMIT_ON) : SQLPOINTER(SQL_AUTOCOMMIT_OFF), 0))) {
+					throw_error(std::string("ODBC error: Could not set AUTOCOMMIT to ")+(on ? "TRUE" : "FALSE")+" ("+odbc_error(dbc, SQL_HANDLE_DBC)+')', sqlstate(dbc, SQL_HANDLE_DBC));
+				}
+				autocommit = on;
+			}
+			
+			void connection_handle_t::restore_autocommit() {
+				if(!autocommit && !manual_commit && transaction_depth == 0) {
+					set_autocommit(true);
+				}
+			}
+			
 			size_t connection_handle_t::exec_direct(const std::string& statement) {
+				restore_autocommit();
 				SQLHSTMT stmt;
 				if(!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, dbc, &stmt))) {
-					throw sqlpp::exception("ODBC error: could SQLAllocHandle(SQL_HANDLE_STMT): "+odbc_error(stmt, SQL_HANDLE_STMT));
+					throw_error("ODBC error: couldn't SQLAllocHandle(SQL_HANDLE_STMT): "+odbc_error(dbc, SQL_HANDLE_DBC), sqlstate(dbc, SQL_HANDLE_DBC));
+				}
+				try {
+					apply_statement_options(stmt);
+				} catch(...) {
+					SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+					throw;
+				}
+				SQLRETURN rc;
+				{
+					running_statement_t running(*this, stmt);
+					rc = SQLExecDirect(stmt, make_sqlchar(statement), statement.length());
 				}
-				auto rc = SQLExecDirect(stmt, make_sqlchar(statement), statement.length());
 				std::string err;
+				std::string state;
 				SQLLEN ret = 0;
 				if(!(SQL_SUCCEEDED(rc) || rc == SQL_NO_DATA)){
 					err = "ODBC error: couldn't SQLExecDirect("+statement+"): "+odbc_error(stmt, SQL_HANDLE_STMT, rc);
+					state = sqlstate(stmt, SQL_HANDLE_STMT);
 				} else {
 					rc = SQLRowCount(stmt, &ret);
 					if(!SQL_SUCCEEDED(rc)) {
@@ -140,10 +289,139 @@ namespace sqlpp {
 				}
 				stmt = nullptr;
 				if(!SQL_SUCCEEDED(rc)) {
-					throw sqlpp::exception(err);
+					throw_error(err, state);
 				}
 				return ret;
 			}
+			
+			void connection_handle_t::register_statement(const std::shared_ptr<prepared_statement_handle_t>& statement) {
+				if(statements.size() == statements.capacity()) {
+					//Drop the statements that are gone before growing
+					statements.erase(std::remove_if(statements.begin(), statements.end(),
+						[](const std::weak_ptr<prepared_statement_handle_t>& s) { return s.expired(); }), statements.end());
+				}
+				statements.push_back(statement);
+			}
+			
+			bool running_state_t::cancel() {
+				std::lock_guard<std::mutex> lock(mutex);
+				if(!stmt) {
+					return false;
+				}
+				if(debug) {
+					std::cerr << "ODBC debug: Cancelling the running statement" << std::endl;
+				}
+				if(!SQL_SUCCEEDED(SQLCancel(stmt))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLCancel: "+odbc_error(stmt, SQL_HANDLE_STMT));
+				}
+				return true;
+			}
+			
+			std::vector<result_column_t> describe_result(SQLHSTMT stmt) {
+				SQLSMALLINT count = 0;
+				if(!SQL_SUCCEEDED(SQLNumResultCols(stmt, &count))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLNumResultCols: "+odbc_error(stmt, SQL_HANDLE_STMT));
+				}
+				std::vector<result_column_t> columns(count);
+				for(SQLUSMALLINT i = 1; i <= count; ++i) {
+					result_column_t& column = columns[i-1];
+					column.name.resize(256);
+					SQLSMALLINT name_length = 0;
+					SQLRETURN rc = SQLDescribeCol(stmt, i, reinterpret_cast<SQLCHAR*>(&column.name[0]), column.name.size(), &name_length,
+						&column.sql_type, &column.size, &column.digits, &column.nullable);
+					if(SQL_SUCCEEDED(rc) && static_cast<size_t>(name_length) >= column.name.size()) {
+						column.name.resize(name_length + 1);
+						rc = SQLDescribeCol(stmt, i, reinterpret_cast<SQLCHAR*>(&column.name[0]), column.name.size(), &name_length, nullptr, nullptr, nullptr, nullptr);
+					}
+					if(!SQL_SUCCEEDED(rc)) {
+						throw sqlpp::exception("ODBC error: couldn't SQLDescribeCol("+std::to_string(i)+"): "+odbc_error(stmt, SQL_HANDLE_STMT));
+					}
+					column.name.resize(name_length);
+					//Optional, some drivers don't report it
+					if(!SQL_SUCCEEDED(SQLColAttribute(stmt, i, SQL_DESC_OCTET_LENGTH, nullptr, 0, nullptr, &column.octet_length)) || column.octet_length < 0) {
+						column.octet_length = 0;
+					}
+				}
+				return columns;
+			}
+			
+			const std::vector<result_column_t>& describe_result(prepared_statement_handle_t& statement) {
+				if(!statement.described) {
+					if(statement.debug) {
+						std::cerr << "ODBC debug: describing result columns, handle at " << &statement << std::endl;
+					}
+					statement.columns = describe_result(statement.stmt);
+					//No columns may also mean the driver can't describe the statement yet, so that isn't kept
+					statement.described = !statement.columns.empty();
+				}
+				return statement.columns;
+			}
+			
+			void unbind_columns(prepared_statement_handle_t& statement) {
+				SQLFreeStmt(statement.stmt, SQL_UNBIND);
+				for(result_column_t& column : statement.columns) {
+					column.numeric_descriptor = false;
+				}
+			}
+			
+			void release_result_binding(prepared_statement_handle_t& statement) {
+				if(!statement.result_binding) {
+					return;
+				}
+				statement.result_binding.reset();
+				unbind_columns(statement);
+				SQLSetStmtAttr(statement.stmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+				SQLSetStmtAttr(statement.stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+				SQLSetStmtAttr(statement.stmt, SQL_ATTR_ROWS_FETCHED_PTR, nullptr, 0);
+			}
+			
+			void reprepare(connection_handle_t& handle, prepared_statement_handle_t& statement) {
+				if(handle.debug) {
+					std::cerr << "ODBC debug: Preparing again: " << statement.statement << std::endl;
+				}
+				if(statement.stmt) {
+					SQLFreeHandle(SQL_HANDLE_STMT, statement.stmt);
+					statement.stmt = nullptr;
+				}
+				SQLHSTMT stmt;
+				if(!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, handle.dbc, &stmt))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLAllocHandle(SQL_HANDLE_STMT): "+odbc_error(handle.dbc, SQL_HANDLE_DBC));
+				}
+				try {
+					handle.apply_statement_options(stmt);
+					if(!SQL_SUCCEEDED(SQLPrepare(stmt, make_sqlchar(statement.statement), statement.statement.length()))) {
+						throw sqlpp::exception("ODBC error: couldn't SQLPrepare "+statement.statement+": "+odbc_error(stmt, SQL_HANDLE_STMT));
+					}
+					for(size_t i = 0; i < statement.bindings.size(); ++i) {
+						const parameter_binding_t& binding = statement.bindings[i];
+						if(binding.c_type == 0) {
+							continue;
+						}
+						if(!SQL_SUCCEEDED(SQLBindParameter(stmt, i+1, SQL_PARAM_INPUT, binding.c_type, binding.sql_type, binding.size, binding.digits, binding.value, binding.length, binding.indicator))) {
+							throw sqlpp::exception("ODBC error: couldn't bind parameter "+std::to_string(i+1)+" again: "+odbc_error(stmt, SQL_HANDLE_STMT));
+						}
+						if(binding.c_type == SQL_C_NUMERIC) {
+							set_numeric_descriptor(stmt, SQL_ATTR_APP_PARAM_DESC, i+1, binding.size, binding.digits, binding.value);
+						}
+					}
+					const parameter_array_t& arrays = statement.parameter_array;
+					if(arrays.size > 1 || arrays.status || arrays.processed) {
+						//The caller's buffers hold that many sets, executing fewer would silently skip the rest
+						if(apply_parameter_array(stmt, arrays.size, arrays.status, arrays.processed) != arrays.size) {
+							throw sqlpp::exception("ODBC error: couldn't set up parameter arrays of "+std::to_string(arrays.size)+" sets again for "+statement.statement);
+						}
+					}
+				} catch(...) {
+					SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+					throw;
+				}
+				statement.stmt = stmt;
+				//The driver on the other end may describe the columns differently
+				statement.described = false;
+				statement.columns.clear();
+				//Bound on the old statement
+				statement.result_binding.reset();
+			}
 
 		}
 	}
@@ -39,7 +39,13 @@
 #endif
 
 #include <sql.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <sqlpp11/odbc/connection_config.h>
+#include <sqlpp11/odbc/statement_statistics.h>
+#include "prepared_statement_handle.h"
 
 //I wish ODBC used const SQLCHAR* when it won't be modified
 inline SQLCHAR* make_sqlchar(const std::string& str)
@@ -55,11 +61,41 @@ namespace sqlpp {
 	namespace odbc {
 		
 		namespace detail {
+			struct prepared_statement_handle_t;
+			
+			//! The statement executing right now on a connection, cancel() is called from other threads.
+			// Shared by the handles a connection goes through when it reconnects, so cancelling never touches a replaced one.
+			struct running_state_t {
+				std::mutex mutex;
+				SQLHSTMT stmt = nullptr;
+				bool debug = false;
+				
+				//! SQLCancel on the running statement, false if there is none
+				bool cancel();
+			};
+			
 			struct connection_handle_t {
 				SQLHENV env;
 				SQLHDBC dbc;
 				bool debug;
 				ODBC_Type type;
+				statement_options options;
+				//SQL_ATTR_AUTOCOMMIT as last set, so it's only switched when that changes something
+				bool autocommit = true;
+				//Autocommit stays off for the whole session, see connection_config::manual_commit
+				bool manual_commit = false;
+				//Open transaction levels, the ones above the first are savepoints
+				size_t transaction_depth = 0;
+				//Reconnect and retry once when the link fails outside of a transaction, see connection_config::auto_reconnect
+				bool auto_reconnect = false;
+				//Connects dbc like the constructor of the connection did, used again by connection::reconnect
+				std::function<void(connection_handle_t&)> connect;
+				//Statements prepared on this connection, prepared again on the new one when it's reconnected
+				std::vector<std::weak_ptr<prepared_statement_handle_t>> statements;
+				//The statement executing right now, see running_state_t
+				std::shared_ptr<running_state_t> running;
+				//Executions are counted here when set, see connection::enable_statement_statistics
+				std::shared_ptr<statement_statistics_t> statistics;
 				
 				connection_handle_t(bool _debug, ODBC_Type _type);
 				~connection_handle_t();
@@ -69,10 +105,62 @@ namespace sqlpp {
 				connection_handle_t& operator=(connection_handle_t&&) = delete;
 				
 				size_t exec_direct(const std::string& statement);
+				void set_autocommit(bool on);
+				//! Switches autocommit back on after a transaction, called before statements are executed.
+				// Left off in between, so back to back transactions don't switch it twice each.
+				void restore_autocommit();
+				//! Sets the statement_options that differ from the driver defaults on a new statement handle
+				void apply_statement_options(SQLHSTMT stmt);
+				void register_statement(const std::shared_ptr<prepared_statement_handle_t>& statement);
+			};
+			
+			//! Marks a statement as running on its connection while it's executed, so it can be cancelled
+			class running_statement_t {
+				std::shared_ptr<running_state_t> _state;
+				
+			public:
+				running_statement_t(connection_handle_t& handle, SQLHSTMT stmt) : _state(handle.running) {
+					std::lock_guard<std::mutex> lock(_state->mutex);
+					_state->stmt = stmt;
+				}
+				running_statement_t(const running_statement_t&) = delete;
+				running_statement_t& operator=(const running_statement_t&) = delete;
+				
+				~running_statement_t() {
+					std::lock_guard<std::mutex> lock(_state->mutex);
+					_state->stmt = nullptr;
+				}
 			};
 			
 			std::string odbc_error(SQLHANDLE handle, SQLSMALLINT handle_type);
 			std::string odbc_error(SQLHANDLE handle, SQLSMALLINT handle_type, SQLRETURN return_code);
+			//! SQLSTATE of the first diagnostic record of the handle, empty if there is none
+			std::string sqlstate(SQLHANDLE handle, SQLSMALLINT handle_type);
+			//! Throws connection_lost (class 08), timeout_expired (HYT00, HYT01), query_cancelled (HY008) or sqlpp::exception
+			[[noreturn]] void throw_error(const std::string& message, const std::string& sqlstate);
+			
+			//! Columns of the result of an executed statement
+			std::vector<result_column_t> describe_result(SQLHSTMT stmt);
+			//! Columns of the statement's result, queried once and cached in the statement (it has to be executed the first time)
+			const std::vector<result_column_t>& describe_result(prepared_statement_handle_t& statement);
+			
+			//! SQLFreeStmt(SQL_UNBIND), which also drops the ARD records bind_result_t set up for numeric columns
+			void unbind_columns(prepared_statement_handle_t& statement);
+			
+			//! Unbinds the columns a planned result left bound for the next execution, so they can be fetched with SQLGetData again
+			void release_result_binding(prepared_statement_handle_t& statement);
+			
+			//! Binds the statement's parameters as column-wise arrays of up to size sets, size 1 with null pointers turns them off again.
+			// Returns the sets the driver took, which may be fewer than asked for; reprepare sets them up again on a new connection.
+			size_t set_parameter_array(prepared_statement_handle_t& statement, size_t size, SQLUSMALLINT* status, SQLULEN* processed);
+			
+			//! Prepares the statement's text on another connection and binds the parameters that were bound before.
+			// The old statement handle is freed, if that fails the statement is left without one.
+			void reprepare(connection_handle_t& handle, prepared_statement_handle_t& statement);
+			
+			//! Sets precision and scale of a SQL_C_NUMERIC record in an application descriptor (SQL_ATTR_APP_ROW_DESC or SQL_ATTR_APP_PARAM_DESC).
+			// SQLBindCol and SQLBindParameter leave them at driver defaults, usually a scale of 0.
+			void set_numeric_descriptor(SQLHSTMT stmt, SQLINTEGER descriptor, SQLSMALLINT record, SQLSMALLINT precision, SQLSMALLINT scale, SQLPOINTER data);
 		}
 	}
 }
@@ -39,14 +39,96 @@
 #endif
 
 #include <sql.h>
+#include <sqlext.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace sqlpp {
 	namespace odbc {
 		namespace detail {
+			//! Storage for a bound parameter, the driver reads it when the statement is executed
+			struct parameter_buffer_t {
+				SQLLEN indicator;
+				union {
+					SQL_DATE_STRUCT date;
+					SQL_TIME_STRUCT time;
+					SQL_TIMESTAMP_STRUCT timestamp;
+					SQL_NUMERIC_STRUCT numeric;
+				};
+			};
+			
+			//! Arguments of a SQLBindParameter call, replayed when the statement is prepared again on a new connection
+			struct parameter_binding_t {
+				SQLSMALLINT c_type = 0;
+				SQLSMALLINT sql_type = 0;
+				SQLULEN size = 0;
+				SQLSMALLINT digits = 0;
+				SQLPOINTER value = nullptr;
+				SQLLEN length = 0;
+				SQLLEN* indicator = nullptr;
+			};
+			
+			//! Parameters bound as column-wise arrays, see set_parameter_array
+			struct parameter_array_t {
+				//SQL_ATTR_PARAMSET_SIZE as the driver took it, 1 when the parameters aren't arrays
+				size_t size = 1;
+				//SQL_ATTR_PARAM_STATUS_PTR and SQL_ATTR_PARAMS_PROCESSED_PTR
+				SQLUSMALLINT* status = nullptr;
+				SQLULEN* processed = nullptr;
+			};
+			
+			//! A result column as SQLDescribeCol and SQLColAttribute report it
+			struct result_column_t {
+				std::string name;
+				SQLSMALLINT sql_type = 0;
+				SQLULEN size = 0;
+				SQLSMALLINT digits = 0;
+				//Bytes a value takes in the driver's character set, 0 if it doesn't say
+				SQLLEN octet_length = 0;
+				SQLSMALLINT nullable = SQL_NULLABLE_UNKNOWN;
+				//Set once bind_result_t set up the column's ARD record for SQL_C_NUMERIC, see unbind_columns
+				bool numeric_descriptor = false;
+			};
+			
+			//! Result columns bound row-wise by a planned_result_t, see binding_plan
+			struct result_binding_t {
+				//The plan the columns were bound along (its offsets are static, so they identify it) and the rows asked for
+				const size_t* offsets = nullptr;
+				size_t row_size = 0;
+				size_t requested_rows = 0;
+				//Rows per SQLFetch, drivers may allow fewer than requested
+				size_t capacity = 0;
+				std::vector<char> buffer;
+				//SQL_ATTR_ROWS_FETCHED_PTR
+				SQLULEN fetched = 0;
+			};
+			
 			struct prepared_statement_handle_t {
 				SQLHSTMT stmt;
 				bool debug;
-				prepared_statement_handle_t(SQLHSTMT statement, bool debug_) : stmt(statement), debug(debug_) {}
+				//The prepared text, see connection::reconnect
+				std::string statement;
+				//statement_fingerprint of the statement, computed when statistics first count it
+				std::string fingerprint;
+				//Indexed like the parameters, c_type is 0 for the ones not bound
+				std::vector<parameter_binding_t> bindings;
+				//Replayed by reprepare along with the bindings
+				parameter_array_t parameter_array;
+				//deques, so growing them doesn't move buffers that were already handed out
+				std::deque<parameter_buffer_t> parameters;
+				std::deque<std::string> text_results;
+				//Text exchanged as SQL_C_WCHAR, see statement_options::wide_text
+				bool wide_text;
+				std::deque<std::u16string> wide_parameters;
+				std::u16string wide_result;
+				//Result metadata, queried by describe_result the first time it's needed and kept for later executions
+				bool described = false;
+				std::vector<result_column_t> columns;
+				//Columns that stay bound between executions, see connection::run_planned
+				std::shared_ptr<result_binding_t> result_binding;
+				prepared_statement_handle_t(SQLHSTMT statement, bool debug_, bool wide_text_ = false) : stmt(statement), debug(debug_), wide_text(wide_text_) {}
 				
 				prepared_statement_handle_t(const prepared_statement_handle_t&) = delete;
 				prepared_statement_handle_t(prepared_statement_handle_t&&) = default;
@@ -60,6 +142,43 @@ namespace sqlpp {
 				}
 				
 				bool operator!() const { return !stmt; }
+				
+				parameter_buffer_t& parameter(size_t index) {
+					if(parameters.size() <= index) {
+						parameters.resize(index + 1);
+					}
+					return parameters[index];
+				}
+				
+				std::string& text_result(size_t index) {
+					if(text_results.size() <= index) {
+						text_results.resize(index + 1);
+					}
+					return text_results[index];
+				}
+				
+				std::u16string& wide_parameter(size_t index) {
+					if(wide_parameters.size() <= index) {
+						wide_parameters.resize(index + 1);
+					}
+					return wide_parameters[index];
+				}
+				
+				//! SQLBindParameter for an input parameter at the 0-based index, which is remembered for reprepare
+				SQLRETURN bind_parameter(size_t index, SQLSMALLINT c_type, SQLSMALLINT sql_type, SQLULEN size, SQLSMALLINT digits, SQLPOINTER value, SQLLEN length, SQLLEN* indicator) {
+					if(bindings.size() <= index) {
+						bindings.resize(index + 1);
+					}
+					parameter_binding_t& binding = bindings[index];
+					binding.c_type = c_type;
+					binding.sql_type = sql_type;
+					binding.size = size;
+					binding.digits = digits;
+					binding.value = value;
+					binding.length = length;
+					binding.indicator = indicator;
+					return SQLBindParameter(stmt, index+1, SQL_PARAM_INPUT, c_type, sql_type, size, digits, value, length, indicator);
+				}
 			};
 		}
 	}
@@ -0,0 +1,64 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/in_list.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			size_t in_list_bucket(const std::vector<size_t>& buckets, size_t keys) {
+				for(size_t i = 0; i < buckets.size(); ++i) {
+					if(buckets[i] >= keys) {
+						return i;
+					}
+				}
+				return buckets.size() - 1;
+			}
+			
+			void check_in_list_config(const in_list_config& config) {
+				if(config.buckets.empty()) {
+					throw sqlpp::exception("ODBC error: in_list_config needs at least one bucket");
+				}
+				for(size_t i = 0; i < config.buckets.size(); ++i) {
+					if(config.buckets[i] == 0 || (i > 0 && config.buckets[i] <= config.buckets[i-1])) {
+						throw sqlpp::exception("ODBC error: in_list_config buckets must be ascending and above 0");
+					}
+				}
+			}
+			
+			std::string in_list_condition(const std::string& column, size_t arity) {
+				std::string ret = column + " IN (";
+				ret.reserve(ret.size() + 2 * arity);
+				for(size_t i = 0; i < arity; ++i) {
+					ret += i ? ",?" : "?";
+				}
+				return ret + ")";
+			}
+		}
+	}
+}
@@ -0,0 +1,176 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/connection.h>
+#include <sqlpp11/odbc/insert_or.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			std::string trim(const std::string& str) {
+				const size_t begin = str.find_first_not_of(" \t\n");
+				if(begin == std::string::npos) {
+					return std::string();
+				}
+				return str.substr(begin, str.find_last_not_of(" \t\n") - begin + 1);
+			}
+			
+			std::vector<std::string> split_columns(const std::string& list) {
+				std::vector<std::string> ret;
+				size_t begin = 0;
+				while(begin <= list.size()) {
+					size_t end = list.find(',', begin);
+					if(end == std::string::npos) {
+						end = list.size();
+					}
+					const std::string column = trim(list.substr(begin, end - begin));
+					if(!column.empty()) {
+						ret.push_back(column);
+					}
+					begin = end + 1;
+				}
+				return ret;
+			}
+			
+			//! "a = <prefix>a, b = <prefix>b"
+			std::string assignments(const std::vector<std::string>& columns, const std::string& prefix, const std::string& suffix) {
+				std::string ret;
+				for(const auto& column : columns) {
+					if(!ret.empty()) {
+						ret += ", ";
+					}
+					ret += column + " = " + prefix + column + suffix;
+				}
+				return ret;
+			}
+			
+			std::string join(const std::vector<std::string>& columns, const std::string& prefix) {
+				std::string ret;
+				for(const auto& column : columns) {
+					if(!ret.empty()) {
+						ret += ", ";
+					}
+					ret += prefix + column;
+				}
+				return ret;
+			}
+			
+			//! ON CONFLICT clause of PostgreSQL and SQLite
+			std::string on_conflict(const std::vector<std::string>& keys, const std::vector<std::string>& updated, bool replace) {
+				std::string ret = " ON CONFLICT";
+				if(!keys.empty()) {
+					ret += " (" + join(keys, std::string()) + ")";
+				}
+				if(replace && !updated.empty()) {
+					return ret + " DO UPDATE SET " + assignments(updated, "excluded.", std::string());
+				}
+				return ret + " DO NOTHING";
+			}
+		}
+		
+		namespace detail {
+			void serialize_insert_or(serializer_t& context, bool replace, const std::vector<std::string>& keys) {
+				const std::string serialized = context.str();
+				//INSERT INTO table (columns) VALUES(values), or VALUES (values),(values) for several rows
+				const std::string insert = serialized.substr(context._statement_begin);
+				const size_t into = insert.find("INTO");
+				const size_t open = insert.find('(', into);
+				const size_t close = insert.find(')', open);
+				const size_t values = insert.find("VALUES", close);
+				if(into == std::string::npos || open == std::string::npos || close == std::string::npos || values == std::string::npos) {
+					throw sqlpp::exception("ODBC error: insert_or_replace and insert_or_ignore need the inserted columns and values");
+				}
+				const std::string table = trim(insert.substr(into + 4, open - into - 4));
+				const std::vector<std::string> columns = split_columns(insert.substr(open + 1, close - open - 1));
+				if(columns.empty()) {
+					throw sqlpp::exception("ODBC error: insert_or_replace and insert_or_ignore need at least one column");
+				}
+				//Columns overwritten when the row exists, the inserted ones that aren't part of the key
+				std::vector<std::string> updated;
+				std::copy_if(columns.begin(), columns.end(), std::back_inserter(updated), [&keys](const std::string& column) {
+					return std::find(keys.begin(), keys.end(), column) == keys.end();
+				});
+				
+				std::string upsert;
+				switch(context.type()) {
+					case ODBC_Type::SQLite3:
+						if(keys.empty()) {
+							upsert = (replace ? "INSERT OR REPLACE" : "INSERT OR IGNORE") + insert.substr(6);
+						} else {
+							//Since SQLite 3.24, unlike OR REPLACE it keeps the row and the columns not inserted
+							upsert = insert + on_conflict(keys, updated, replace);
+						}
+						break;
+					case ODBC_Type::PostgreSQL:
+						if(replace && keys.empty()) {
+							throw sqlpp::exception("ODBC error: insert_or_replace needs the conflicting columns on PostgreSQL, see on_conflict");
+						}
+						upsert = insert + on_conflict(keys, updated, replace);
+						break;
+					case ODBC_Type::MySQL: {
+						//Any unique key conflicts, keys aren't named. Ignoring sets a column to itself, as INSERT IGNORE would
+						// also turn other errors into warnings
+						upsert = insert + " ON DUPLICATE KEY UPDATE ";
+						if(replace && !updated.empty()) {
+							upsert += assignments(updated, "VALUES(", ")");
+						} else {
+							upsert += assignments({keys.empty() ? columns.front() : keys.front()}, std::string(), std::string());
+						}
+						break;
+					}
+					case ODBC_Type::TSQL: {
+						if(keys.empty()) {
+							throw sqlpp::exception("ODBC error: insert_or_replace and insert_or_ignore need the conflicting columns on TSQL, see on_conflict");
+						}
+						std::string match;
+						for(const auto& key : keys) {
+							if(std::find(columns.begin(), columns.end(), key) == columns.end()) {
+								throw sqlpp::exception("ODBC error: the conflicting column " + key + " isn't inserted");
+							}
+							match += (match.empty() ? "t." : " AND t.") + key + " = s." + key;
+						}
+						//HOLDLOCK keeps the range locked between matching and inserting, so concurrent MERGEs can't both insert
+						upsert = "MERGE INTO " + table + " WITH (HOLDLOCK) AS t USING (" + trim(insert.substr(values)) + ") AS s (" +
+							join(columns, std::string()) + ") ON " + match;
+						if(replace && !updated.empty()) {
+							upsert += " WHEN MATCHED THEN UPDATE SET " + assignments(updated, "s.", std::string());
+						}
+						upsert += " WHEN NOT MATCHED THEN INSERT (" + join(columns, std::string()) + ") VALUES (" + join(columns, "s.") + ");";
+						break;
+					}
+					default:
+						throw sqlpp::exception("ODBC error: insert_or isn't supported for ODBC_Type "+std::to_string(static_cast<int>(context.type())));
+				}
+				context._os.str(std::string());
+				context._os.clear();
+				context << serialized.substr(0, context._statement_begin) << upsert;
+			}
+		}
+	}
+}
@@ -0,0 +1,249 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/civil_time.h>
+#include <sqlpp11/odbc/lazy_result.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sql.h>
+#include <sqlext.h>
+#include "detail/prepared_statement_handle.h"
+#include "detail/connection_handle.h"
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			bool is_fixed_width(column_kind kind) {
+				return kind != column_kind::text && kind != column_kind::numeric;
+			}
+			
+			SQLSMALLINT c_type_of(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return SQL_C_SBIGINT;
+					case column_kind::floating_point: return SQL_C_DOUBLE;
+					case column_kind::boolean: return SQL_C_BIT;
+					case column_kind::date: return SQL_C_TYPE_DATE;
+					case column_kind::date_time: return SQL_C_TYPE_TIMESTAMP;
+					default: return SQL_C_TYPE_TIME;
+				}
+			}
+			
+			const char* name_of(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return "integral";
+					case column_kind::floating_point: return "floating_point";
+					case column_kind::boolean: return "boolean";
+					case column_kind::text: return "text";
+					case column_kind::date: return "date";
+					case column_kind::date_time: return "date_time";
+					case column_kind::time_of_day: return "time_of_day";
+					default: return "numeric";
+				}
+			}
+		}
+		
+		lazy_result_t::lazy_result_t(const std::shared_ptr<detail::prepared_statement_handle_t>& handle, const std::vector<column_info>& columns, SQLUINTEGER getdata_extensions)
+			: _handle(handle)
+			, _result(handle)
+			, _any_order(getdata_extensions & SQL_GD_ANY_ORDER)
+		{
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: Constructing lazy result, using handle at " << _handle.get() << std::endl;
+			}
+			_columns.resize(columns.size());
+			//Without SQL_GD_ANY_COLUMN, SQLGetData only works on columns after the last bound one
+			bool bind = true;
+			for(size_t i = 0; i < columns.size(); ++i) {
+				column_t& column = _columns[i];
+				column.kind = columns[i].kind;
+				column.name = columns[i].name;
+				column.bound = false;
+				column.read = false;
+				if(!is_fixed_width(column.kind)) {
+					bind = bind && (getdata_extensions & SQL_GD_ANY_COLUMN);
+					continue;
+				}
+				if(!bind) {
+					continue;
+				}
+				if(!SQL_SUCCEEDED(SQLBindCol(_handle->stmt, i+1, c_type_of(column.kind), &column.value, sizeof(column.value), &column.indicator))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLBindCol("+std::to_string(i+1)+"): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+				}
+				column.bound = true;
+				column.read = true;
+			}
+		}
+		
+		lazy_result_t::~lazy_result_t() {
+			if(!_handle) {
+				return;
+			}
+			//Leave the statement as we found it, the bound buffers go away with us
+			SQLFreeStmt(_handle->stmt, SQL_CLOSE);
+			detail::unbind_columns(*_handle);
+		}
+		
+		bool lazy_result_t::next() {
+			if(!_handle) {
+				return false;
+			}
+			for(column_t& column : _columns) {
+				column.read = column.bound;
+			}
+			_position = 0;
+			_on_row = _result.next_impl();
+			return _on_row;
+		}
+		
+		size_t lazy_result_t::index(const std::string& name) const {
+			for(size_t i = 0; i < _columns.size(); ++i) {
+				if(_columns[i].name == name) {
+					return i;
+				}
+			}
+			throw sqlpp::exception("ODBC error: result has no column named "+name);
+		}
+		
+		lazy_result_t::column_t& lazy_result_t::column(size_t index) {
+			if(!_on_row) {
+				throw sqlpp::exception("ODBC error: lazy result is not on a row, call next() first");
+			}
+			if(index >= _columns.size()) {
+				throw sqlpp::exception("ODBC error: column "+std::to_string(index+1)+" is out of range, the result has "+std::to_string(_columns.size()));
+			}
+			column_t& column = _columns[index];
+			if(column.read) {
+				return column;
+			}
+			if(index+1 < _position && !_any_order) {
+				throw sqlpp::exception("ODBC error: column "+std::to_string(index+1)+" read after column "+std::to_string(_position)+
+					", the driver needs unbound columns to be read in increasing order");
+			}
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: reading lazy column " << index+1 << ", handle at " << _handle.get() << std::endl;
+			}
+			switch(column.kind) {
+				case column_kind::text:
+					_result._bind_text_result(index, &column.text, &column.length);
+					column.indicator = column.text ? static_cast<SQLLEN>(column.length) : SQL_NULL_DATA;
+					break;
+				case column_kind::numeric: {
+					bool is_null = false;
+					_result._bind_numeric_result(index, &column.numeric, &is_null);
+					column.indicator = is_null ? SQL_NULL_DATA : 0;
+					break;
+				}
+				default:
+					if(!SQL_SUCCEEDED(SQLGetData(_handle->stmt, index+1, c_type_of(column.kind), &column.value, sizeof(column.value), &column.indicator))) {
+						throw sqlpp::exception("ODBC error: couldn't SQLGetData("+std::to_string(index+1)+"): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+					}
+			}
+			column.read = true;
+			_position = index+1;
+			return column;
+		}
+		
+		lazy_result_t::column_t& lazy_result_t::column(size_t index, column_kind kind) {
+			column_t& c = column(index);
+			if(c.kind != kind) {
+				throw sqlpp::exception(std::string("ODBC error: column ")+std::to_string(index+1)+" is "+name_of(c.kind)+", not "+name_of(kind));
+			}
+			return c;
+		}
+		
+		bool lazy_result_t::is_null(size_t index) {
+			return column(index).indicator == SQL_NULL_DATA;
+		}
+		
+		int64_t lazy_result_t::integral(size_t index) {
+			const column_t& c = column(index, column_kind::integral);
+			return c.indicator == SQL_NULL_DATA ? 0 : c.value.integral;
+		}
+		
+		double lazy_result_t::floating_point(size_t index) {
+			const column_t& c = column(index, column_kind::floating_point);
+			return c.indicator == SQL_NULL_DATA ? 0 : c.value.floating_point;
+		}
+		
+		bool lazy_result_t::boolean(size_t index) {
+			const column_t& c = column(index, column_kind::boolean);
+			return c.indicator != SQL_NULL_DATA && c.value.boolean;
+		}
+		
+		const char* lazy_result_t::text(size_t index, size_t* length) {
+			const column_t& c = column(index, column_kind::text);
+			*length = c.length;
+			return c.text;
+		}
+		
+		std::string lazy_result_t::text(size_t index) {
+			size_t length = 0;
+			const char* value = text(index, &length);
+			return value ? std::string(value, length) : std::string();
+		}
+		
+		::sqlpp::day_point::_cpp_value_type lazy_result_t::date(size_t index) {
+			const column_t& c = column(index, column_kind::date);
+			if(c.indicator == SQL_NULL_DATA) {
+				return {};
+			}
+			return ::sqlpp::day_point::_cpp_value_type(::sqlpp::chrono::days(days_from_civil(c.value.date.year, c.value.date.month, c.value.date.day)));
+		}
+		
+		::sqlpp::time_point::_cpp_value_type lazy_result_t::date_time(size_t index) {
+			const column_t& c = column(index, column_kind::date_time);
+			if(c.indicator == SQL_NULL_DATA) {
+				return {};
+			}
+			return ::sqlpp::time_point::_cpp_value_type(std::chrono::microseconds(microseconds_from_timestamp(c.value.timestamp)));
+		}
+		
+		::sqlpp::time_of_day::_cpp_value_type lazy_result_t::time_of_day(size_t index) {
+			const column_t& c = column(index, column_kind::time_of_day);
+			if(c.indicator == SQL_NULL_DATA) {
+				return {};
+			}
+			return std::chrono::microseconds(microseconds_from_time(c.value.time));
+		}
+		
+		numeric_t lazy_result_t::numeric(size_t index) {
+			return column(index, column_kind::numeric).numeric;
+		}
+	}
+}
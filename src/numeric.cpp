@@ -0,0 +1,429 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/numeric.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			//Unsigned 128 bit arithmetic on 32 bit limbs, portable to compilers without __int128
+			struct magnitude_t {
+				uint64_t low;
+				uint64_t high;
+			};
+			
+			const uint32_t small_powers_of_ten[10] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+			
+			void split(const magnitude_t& m, uint64_t (&limbs)[4]) {
+				limbs[0] = m.low & 0xffffffff;
+				limbs[1] = m.low >> 32;
+				limbs[2] = m.high & 0xffffffff;
+				limbs[3] = m.high >> 32;
+			}
+			
+			magnitude_t join(const uint64_t (&limbs)[4]) {
+				return magnitude_t{limbs[0] | limbs[1] << 32, limbs[2] | limbs[3] << 32};
+			}
+			
+			//! m = m * factor + addend, returns false if the result doesn't fit into 128 bits
+			bool multiply_add(magnitude_t& m, uint32_t factor, uint32_t addend) {
+				uint64_t limbs[4];
+				split(m, limbs);
+				uint64_t carry = addend;
+				for(uint64_t& limb : limbs) {
+					const uint64_t product = limb * factor + carry;
+					limb = product & 0xffffffff;
+					carry = product >> 32;
+				}
+				m = join(limbs);
+				return carry == 0;
+			}
+			
+			//! m = m / divisor, returns the remainder
+			uint32_t divide(magnitude_t& m, uint32_t divisor) {
+				uint64_t limbs[4];
+				split(m, limbs);
+				uint64_t remainder = 0;
+				for(int i = 3; i >= 0; --i) {
+					const uint64_t current = remainder << 32 | limbs[i];
+					limbs[i] = current / divisor;
+					remainder = current % divisor;
+				}
+				m = join(limbs);
+				return static_cast<uint32_t>(remainder);
+			}
+			
+			int compare_magnitudes(const magnitude_t& lhs, const magnitude_t& rhs) {
+				if(lhs.high != rhs.high) {
+					return lhs.high < rhs.high ? -1 : 1;
+				}
+				if(lhs.low != rhs.low) {
+					return lhs.low < rhs.low ? -1 : 1;
+				}
+				return 0;
+			}
+			
+			//! Both are below 10^38 < 2^127, so the sum can't overflow
+			magnitude_t add(const magnitude_t& lhs, const magnitude_t& rhs) {
+				const uint64_t low = lhs.low + rhs.low;
+				return magnitude_t{low, lhs.high + rhs.high + (low < lhs.low)};
+			}
+			
+			//! lhs must not be smaller than rhs
+			magnitude_t subtract(const magnitude_t& lhs, const magnitude_t& rhs) {
+				return magnitude_t{lhs.low - rhs.low, lhs.high - rhs.high - (lhs.low < rhs.low)};
+			}
+			
+			bool scale_up(magnitude_t& m, unsigned digits) {
+				while(digits) {
+					const unsigned step = std::min(digits, 9u);
+					if(!multiply_add(m, small_powers_of_ten[step], 0)) {
+						return false;
+					}
+					digits -= step;
+				}
+				return true;
+			}
+			
+			//! Drops digits, rounding half away from zero
+			void scale_down(magnitude_t& m, unsigned digits) {
+				if(!digits) {
+					return;
+				}
+				//Only the first dropped digit decides the rounding
+				for(unsigned rest = digits - 1; rest; ) {
+					const unsigned step = std::min(rest, 9u);
+					divide(m, small_powers_of_ten[step]);
+					rest -= step;
+				}
+				if(divide(m, 10) >= 5) {
+					multiply_add(m, 1, 1);
+				}
+			}
+			
+			//! 10^0 ... 10^38
+			struct powers_of_ten_t {
+				magnitude_t values[numeric_t::max_precision + 1];
+				
+				powers_of_ten_t() {
+					values[0] = magnitude_t{1, 0};
+					for(unsigned i = 1; i <= numeric_t::max_precision; ++i) {
+						values[i] = values[i - 1];
+						multiply_add(values[i], 10, 0);
+					}
+				}
+			};
+			
+			const powers_of_ten_t powers_of_ten;
+			
+			unsigned digits_of(const magnitude_t& m) {
+				unsigned digits = 1;
+				while(digits <= numeric_t::max_precision && compare_magnitudes(m, powers_of_ten.values[digits]) >= 0) {
+					++digits;
+				}
+				return digits;
+			}
+			
+			void check_scale(unsigned scale) {
+				if(scale > numeric_t::max_precision) {
+					throw sqlpp::exception("ODBC error: numeric scale "+std::to_string(scale)+" exceeds "+std::to_string(+numeric_t::max_precision));
+				}
+			}
+			
+			//! Parses [+-]digits[.digits] nine digits at a time, fixed_scale < 0 keeps all digits after the point
+			magnitude_t parse(const std::string& text, int fixed_scale, bool& negative, unsigned& scale) {
+				size_t i = 0;
+				negative = false;
+				if(i < text.size() && (text[i] == '-' || text[i] == '+')) {
+					negative = text[i] == '-';
+					++i;
+				}
+				magnitude_t m{0, 0};
+				uint32_t chunk = 0;
+				unsigned chunk_digits = 0;
+				unsigned fraction = 0;
+				size_t digits = 0;
+				bool point = false;
+				int rounding_digit = -1;
+				for(; i < text.size(); ++i) {
+					const char c = text[i];
+					if(c == '.' && !point) {
+						point = true;
+						continue;
+					}
+					if(c < '0' || c > '9') {
+						throw sqlpp::exception("ODBC error: invalid numeric value '"+text+"'");
+					}
+					++digits;
+					if(point) {
+						if(fixed_scale >= 0 && fraction == static_cast<unsigned>(fixed_scale)) {
+							if(rounding_digit < 0) {
+								rounding_digit = c - '0';
+							}
+							continue;
+						}
+						++fraction;
+					}
+					chunk = chunk * 10 + static_cast<uint32_t>(c - '0');
+					if(++chunk_digits == 9) {
+						if(!multiply_add(m, small_powers_of_ten[9], chunk)) {
+							throw sqlpp::exception("ODBC error: numeric value '"+text+"' exceeds 128 bits");
+						}
+						chunk = 0;
+						chunk_digits = 0;
+					}
+				}
+				if(!digits) {
+					throw sqlpp::exception("ODBC error: invalid numeric value '"+text+"'");
+				}
+				scale = fixed_scale >= 0 ? static_cast<unsigned>(fixed_scale) : fraction;
+				check_scale(scale);
+				if(!multiply_add(m, small_powers_of_ten[chunk_digits], chunk) || !scale_up(m, scale - fraction)) {
+					throw sqlpp::exception("ODBC error: numeric value '"+text+"' exceeds 128 bits");
+				}
+				if(rounding_digit >= 5) {
+					multiply_add(m, 1, 1);
+				}
+				return m;
+			}
+		}
+		
+		constexpr uint8_t numeric_t::max_precision;
+		
+		numeric_t::numeric_t(int64_t unscaled, uint8_t scale, uint8_t precision)
+			: _low(unscaled < 0 ? 0 - static_cast<uint64_t>(unscaled) : static_cast<uint64_t>(unscaled))
+			, _negative(unscaled < 0)
+			, _precision(precision)
+			, _scale(scale)
+		{
+			check_scale(scale);
+			fit(false);
+		}
+		
+		numeric_t::numeric_t(const SQL_NUMERIC_STRUCT& value)
+			: _negative(value.sign == 0)
+			, _precision(value.precision ? value.precision : max_precision)
+		{
+			for(int i = 7; i >= 0; --i) {
+				_low = _low << 8 | value.val[i];
+				_high = _high << 8 | value.val[i + 8];
+			}
+			if(value.scale < 0) {
+				//A negative scale counts zeros before the point
+				magnitude_t m{_low, _high};
+				if(!scale_up(m, static_cast<unsigned>(-value.scale))) {
+					throw sqlpp::exception("ODBC error: numeric value exceeds 128 bits");
+				}
+				_low = m.low;
+				_high = m.high;
+			} else {
+				check_scale(static_cast<unsigned>(value.scale));
+				_scale = static_cast<uint8_t>(value.scale);
+			}
+			fit(true);
+		}
+		
+		numeric_t numeric_t::from_string(const std::string& text) {
+			numeric_t result;
+			unsigned scale = 0;
+			const magnitude_t m = parse(text, -1, result._negative, scale);
+			result._low = m.low;
+			result._high = m.high;
+			result._scale = static_cast<uint8_t>(scale);
+			result.fit(false);
+			return result;
+		}
+		
+		numeric_t numeric_t::from_string(const std::string& text, uint8_t scale, uint8_t precision) {
+			numeric_t result;
+			unsigned parsed_scale = 0;
+			const magnitude_t m = parse(text, scale, result._negative, parsed_scale);
+			result._low = m.low;
+			result._high = m.high;
+			result._scale = scale;
+			result._precision = precision;
+			result.fit(false);
+			return result;
+		}
+		
+		numeric_t numeric_t::from_double(double value, uint8_t scale, uint8_t precision) {
+			check_scale(scale);
+			if(!std::isfinite(value)) {
+				throw sqlpp::exception("ODBC error: numeric value must be finite");
+			}
+			const double two_to_64 = 18446744073709551616.0;
+			const double rounded = std::floor(std::fabs(value) * std::pow(10.0, scale) + 0.5);
+			if(rounded >= 1e38) {
+				throw sqlpp::exception("ODBC error: numeric value "+std::to_string(value)+" exceeds 38 digits");
+			}
+			//rounded is an integer, so both halves are exact
+			const double high = std::floor(rounded / two_to_64);
+			numeric_t result;
+			result._high = static_cast<uint64_t>(high);
+			result._low = static_cast<uint64_t>(rounded - high * two_to_64);
+			result._negative = value < 0;
+			result._scale = scale;
+			result._precision = precision;
+			result.fit(false);
+			return result;
+		}
+		
+		std::string numeric_t::to_string() const {
+			//Nine digits per division, least significant first
+			magnitude_t m{_low, _high};
+			std::string digits;
+			do {
+				uint32_t chunk = divide(m, small_powers_of_ten[9]);
+				for(int i = 0; i < 9; ++i) {
+					digits.push_back(static_cast<char>('0' + chunk % 10));
+					chunk /= 10;
+				}
+			} while(m.low || m.high);
+			while(digits.size() > static_cast<size_t>(_scale) + 1 && digits.back() == '0') {
+				digits.pop_back();
+			}
+			while(digits.size() < static_cast<size_t>(_scale) + 1) {
+				digits.push_back('0');
+			}
+			std::string text;
+			text.reserve(digits.size() + 2);
+			if(_negative) {
+				text.push_back('-');
+			}
+			for(size_t i = digits.size(); i > 0; --i) {
+				if(i == _scale) {
+					text.push_back('.');
+				}
+				text.push_back(digits[i - 1]);
+			}
+			return text;
+		}
+		
+		double numeric_t::to_double() const {
+			const double magnitude = static_cast<double>(_high) * 18446744073709551616.0 + static_cast<double>(_low);
+			const double value = magnitude / std::pow(10.0, _scale);
+			return _negative ? -value : value;
+		}
+		
+		SQL_NUMERIC_STRUCT numeric_t::to_struct() const {
+			SQL_NUMERIC_STRUCT value;
+			value.precision = _precision;
+			value.scale = static_cast<SQLSCHAR>(_scale);
+			value.sign = _negative ? 0 : 1;
+			for(int i = 0; i < 8; ++i) {
+				value.val[i] = static_cast<SQLCHAR>(_low >> (8 * i));
+				value.val[i + 8] = static_cast<SQLCHAR>(_high >> (8 * i));
+			}
+			return value;
+		}
+		
+		numeric_t numeric_t::rescale(uint8_t scale) const {
+			check_scale(scale);
+			numeric_t result = *this;
+			magnitude_t m{_low, _high};
+			if(scale > _scale) {
+				if(!scale_up(m, scale - _scale)) {
+					throw sqlpp::exception("ODBC error: numeric value "+to_string()+" exceeds 38 digits at scale "+std::to_string(+scale));
+				}
+			} else {
+				scale_down(m, _scale - scale);
+			}
+			result._low = m.low;
+			result._high = m.high;
+			result._scale = scale;
+			result.fit(true);
+			return result;
+		}
+		
+		numeric_t& numeric_t::operator+=(const numeric_t& rhs) {
+			const uint8_t scale = std::max(_scale, rhs._scale);
+			const numeric_t left = rescale(scale);
+			const numeric_t right = rhs.rescale(scale);
+			const magnitude_t l{left._low, left._high};
+			const magnitude_t r{right._low, right._high};
+			magnitude_t m;
+			if(left._negative == right._negative) {
+				m = add(l, r);
+			} else if(compare_magnitudes(l, r) >= 0) {
+				m = subtract(l, r);
+			} else {
+				m = subtract(r, l);
+				_negative = right._negative;
+			}
+			_low = m.low;
+			_high = m.high;
+			_scale = scale;
+			_precision = std::max(left._precision, right._precision);
+			fit(true);
+			return *this;
+		}
+		
+		numeric_t& numeric_t::operator-=(const numeric_t& rhs) {
+			return *this += -rhs;
+		}
+		
+		numeric_t numeric_t::operator-() const {
+			numeric_t result = *this;
+			result._negative = !_negative && !is_zero();
+			return result;
+		}
+		
+		int numeric_t::compare(const numeric_t& rhs) const {
+			if(_negative != rhs._negative) {
+				return _negative ? -1 : 1;
+			}
+			magnitude_t l{_low, _high};
+			magnitude_t r{rhs._low, rhs._high};
+			//Bring both to the larger scale, a value that overflows on the way is the larger one
+			int result;
+			if(_scale < rhs._scale && !scale_up(l, rhs._scale - _scale)) {
+				result = 1;
+			} else if(rhs._scale < _scale && !scale_up(r, _scale - rhs._scale)) {
+				result = -1;
+			} else {
+				result = compare_magnitudes(l, r);
+			}
+			return _negative ? -result : result;
+		}
+		
+		void numeric_t::fit(bool widen) {
+			if(is_zero()) {
+				_negative = false;
+			}
+			const unsigned digits = digits_of(magnitude_t{_low, _high});
+			if(widen && digits > _precision) {
+				_precision = static_cast<uint8_t>(std::min<unsigned>(digits, max_precision));
+			}
+			if(digits > _precision || digits > max_precision) {
+				throw sqlpp::exception("ODBC error: numeric value "+to_string()+" exceeds precision "+std::to_string(+_precision));
+			}
+		}
+	}
+}
@@ -0,0 +1,154 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sqlpp11/odbc/pipelined_rowset.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace detail {
+			struct pipeline_t {
+				rowset_t rowset;
+				//Blocks handed between the fetching thread and the consumer
+				std::vector<rowset_block_t> blocks;
+				std::deque<rowset_block_t*> free;
+				std::deque<rowset_block_t*> filled;
+				rowset_block_t* current = nullptr;
+				std::mutex mutex;
+				std::condition_variable changed;
+				bool done = false;
+				bool stop = false;
+				std::exception_ptr error;
+				std::thread thread;
+				
+				pipeline_t(rowset_t&& r) : rowset(std::move(r)) {}
+				
+				void run() {
+					while(true) {
+						rowset_block_t* block;
+						{
+							std::unique_lock<std::mutex> lock(mutex);
+							changed.wait(lock, [this]{ return stop || !free.empty(); });
+							if(stop) {
+								return;
+							}
+							block = free.front();
+							free.pop_front();
+						}
+						bool fetched = false;
+						std::exception_ptr fetch_error;
+						try {
+							fetched = rowset.fetch();
+							if(fetched) {
+								//The block's buffers are bound before the next fetch
+								rowset.swap(*block);
+							}
+						} catch(...) {
+							fetch_error = std::current_exception();
+						}
+						std::lock_guard<std::mutex> lock(mutex);
+						if(!fetched) {
+							free.push_back(block);
+							error = std::move(fetch_error);
+							done = true;
+							changed.notify_all();
+							return;
+						}
+						filled.push_back(block);
+						changed.notify_all();
+					}
+				}
+			};
+		}
+		
+		pipelined_rowset_t::pipelined_rowset_t(rowset_t rowset, size_t prefetch_blocks)
+			: _pipeline(new detail::pipeline_t(std::move(rowset)))
+		{
+			if(prefetch_blocks == 0) {
+				return;
+			}
+			detail::pipeline_t& pipeline = *_pipeline;
+			//One block more than fetched ahead, the consumer holds on to the current one
+			for(size_t i = 0; i <= prefetch_blocks; ++i) {
+				pipeline.blocks.push_back(pipeline.rowset.make_block());
+			}
+			for(rowset_block_t& block : pipeline.blocks) {
+				pipeline.free.push_back(&block);
+			}
+			pipeline.thread = std::thread(&detail::pipeline_t::run, &pipeline);
+		}
+		
+		pipelined_rowset_t::pipelined_rowset_t(pipelined_rowset_t&& rhs) = default;
+		
+		pipelined_rowset_t& pipelined_rowset_t::operator=(pipelined_rowset_t&& rhs) {
+			std::swap(_pipeline, rhs._pipeline);
+			return *this;
+		}
+		
+		pipelined_rowset_t::~pipelined_rowset_t() {
+			if(!_pipeline || !_pipeline->thread.joinable()) {
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(_pipeline->mutex);
+				_pipeline->stop = true;
+			}
+			_pipeline->changed.notify_all();
+			_pipeline->thread.join();
+		}
+		
+		rowset_block_t* pipelined_rowset_t::next() {
+			detail::pipeline_t& pipeline = *_pipeline;
+			if(!pipeline.thread.joinable()) {
+				return pipeline.rowset.fetch() ? &pipeline.rowset : nullptr;
+			}
+			std::unique_lock<std::mutex> lock(pipeline.mutex);
+			if(pipeline.current) {
+				pipeline.free.push_back(pipeline.current);
+				pipeline.current = nullptr;
+				pipeline.changed.notify_all();
+			}
+			pipeline.changed.wait(lock, [&pipeline]{ return pipeline.done || !pipeline.filled.empty(); });
+			if(!pipeline.filled.empty()) {
+				pipeline.current = pipeline.filled.front();
+				pipeline.filled.pop_front();
+				return pipeline.current;
+			}
+			if(pipeline.error) {
+				std::exception_ptr error = pipeline.error;
+				pipeline.error = nullptr;
+				std::rethrow_exception(error);
+			}
+			return nullptr;
+		}
+	}
+}
@@ -25,13 +25,17 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <cfloat>
 #include <date/date.h>
 #include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/civil_time.h>
+#include <sqlpp11/odbc/numeric.h>
 #include <sqlpp11/odbc/prepared_statement.h>
+#include <sqlpp11/odbc/transcode.h>
 #include "detail/prepared_statement_handle.h"
 #include "detail/connection_handle.h"
 
@@ -94,6 +98,7 @@ namespace sqlpp {
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO){
 				throw sqlpp::exception("ODBC error: couldn't reset parameters on prepared_statement: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
+			_handle->bindings.clear();
 		}
 		
 		void prepared_statement_t::_bind_boolean_parameter(size_t index, const signed char* value, bool is_null) {
@@ -101,17 +106,16 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding boolean parameter " << (*value ? "true" : "false")
 				<< " at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_CHAR, 
-									   SQL_BIT, 
-									   1, 
-									   0, 
-									   (SQLPOINTER)value, 
-									   sizeof(signed char), 
-									   &indPtr);
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_BIT, 
+									          SQL_BIT, 
+									          1, 
+									          0, 
+									          (SQLPOINTER)value, 
+									          sizeof(signed char), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind boolean parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -122,17 +126,16 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding floating_point parameter " << *value
 				<< " at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_DOUBLE, 
-									   SQL_DOUBLE, 
-									   15,
-									   DBL_DIG,
-									   (SQLPOINTER)value, 
-									   sizeof(double), 
-									   &indPtr);
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_DOUBLE, 
+									          SQL_DOUBLE, 
+									          15,
+									          DBL_DIG,
+									          (SQLPOINTER)value, 
+									          sizeof(double), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind floating_point parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -143,17 +146,16 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding integral parameter " << *value
 				<< " at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT,
-									   SQL_C_SBIGINT,
-									   SQL_BIGINT, 
-									   19,
-									   0, 
-									   (SQLPOINTER)value, 
-									   sizeof(int64_t), 
-									   &indPtr);
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_SBIGINT,
+									          SQL_BIGINT, 
+									          19,
+									          0, 
+									          (SQLPOINTER)value, 
+									          sizeof(int64_t), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind integral parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -164,17 +166,36 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding text parameter " << *value
 				<< " at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_CHAR, 
-									   SQL_CHAR,
-									   value->length(),
-									   0, 
-									   (SQLPOINTER)value, 
-									   value->size(), 
-									   &indPtr);
+			auto& buffer = _handle->parameter(index);
+			if(_handle->wide_text) {
+				static_assert(sizeof(SQLWCHAR) == sizeof(char16_t), "SQL_C_WCHAR buffers are written as UTF-16");
+				//The converted text has to stay alive until the statement is executed
+				std::u16string& wide = _handle->wide_parameter(index);
+				wide = is_null ? std::u16string() : utf8_to_utf16(*value);
+				buffer.indicator = is_null ? SQL_NULL_DATA : static_cast<SQLLEN>(wide.size() * sizeof(char16_t));
+				auto rc = _handle->bind_parameter(index, 
+										          SQL_C_WCHAR, 
+										          SQL_WVARCHAR,
+										          std::max<size_t>(wide.size(), 1),
+										          0, 
+										          (SQLPOINTER)wide.data(), 
+										          wide.size() * sizeof(char16_t), 
+										          &buffer.indicator);
+				if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
+					throw sqlpp::exception("ODBC error: couldn't bind wide text parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+				}
+				return;
+			}
+			//For character data the indicator is the length of the string
+			buffer.indicator = is_null ? SQL_NULL_DATA : static_cast<SQLLEN>(value->size());
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_CHAR, 
+									          SQL_CHAR,
+									          std::max<size_t>(value->length(), 1),
+									          0, 
+									          (SQLPOINTER)value->data(), 
+									          value->size(), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind text parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -185,25 +206,21 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding date parameter"
 				" at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			SQL_DATE_STRUCT ymd_value = {0};
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			buffer.date = SQL_DATE_STRUCT{0, 0, 0};
 			if(!is_null) {
-				const auto ymd = ::date::year_month_day{*value};
-				ymd_value.year = static_cast<int>(ymd.year());
-				ymd_value.month = static_cast<unsigned>(ymd.month());
-				ymd_value.day = static_cast<unsigned>(ymd.day());
+				buffer.date = civil_from_days(value->time_since_epoch().count());
 			}
 			
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_TYPE_DATE, 
-									   SQL_TYPE_DATE, 
-									   10,
-									   0, 
-									   (SQLPOINTER)&ymd_value, 
-									   sizeof(SQL_DATE_STRUCT), 
-									   &indPtr);
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_TYPE_DATE, 
+									          SQL_TYPE_DATE, 
+									          10,
+									          0, 
+									          (SQLPOINTER)&buffer.date, 
+									          sizeof(SQL_DATE_STRUCT), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind date parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -214,31 +231,21 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding date_time parameter"
 				" at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			SQL_TIMESTAMP_STRUCT ts_value = {0};
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			buffer.timestamp = SQL_TIMESTAMP_STRUCT{0, 0, 0, 0, 0, 0, 0};
 			if(!is_null) {
-				const auto dp = ::date::floor<::date::days>(*value);
-				const auto time = date::make_time(*value - dp);
-				const auto ymd = ::date::year_month_day{dp};
-				ts_value.year = static_cast<int>(ymd.year());
-				ts_value.month = static_cast<unsigned>(ymd.month());
-				ts_value.day = static_cast<unsigned>(ymd.day());
-				ts_value.hour = time.hours().count();
-				ts_value.minute = time.minutes().count();
-				ts_value.second = time.seconds().count();
-				ts_value.fraction = time.subseconds().count();
+				buffer.timestamp = timestamp_from_microseconds(value->time_since_epoch().count());
 			}
 			
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_TYPE_TIMESTAMP, 
-									   SQL_TYPE_TIMESTAMP, 
-									   sizeof(SQL_TIMESTAMP_STRUCT),
-									   0, 
-									   (SQLPOINTER)&ts_value, 
-									   sizeof(SQL_DATE_STRUCT), 
-									   &indPtr);
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_TYPE_TIMESTAMP, 
+									          SQL_TYPE_TIMESTAMP, 
+									          26,
+									          6, 
+									          (SQLPOINTER)&buffer.timestamp, 
+									          sizeof(SQL_TIMESTAMP_STRUCT), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind date parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -249,17 +256,16 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding date_time parameter"
 				" at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_TYPE_TIMESTAMP, 
-									   SQL_TYPE_TIMESTAMP, 
-									   29,
-									   0, 
-									   (SQLPOINTER)value, 
-									   sizeof(SQL_DATE_STRUCT), 
-									   &indPtr);
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_TYPE_TIMESTAMP, 
+									          SQL_TYPE_TIMESTAMP, 
+									          29,
+									          9, 
+									          (SQLPOINTER)value, 
+									          sizeof(SQL_TIMESTAMP_STRUCT), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind date parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
@@ -270,29 +276,50 @@ namespace sqlpp {
 				std::cerr << "ODBC debug: binding date_time parameter"
 				" at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
 			}
-			SQLLEN indPtr(is_null ? SQL_NULL_DATA : 0);
-			SQL_TIME_STRUCT t_value = {0};
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			buffer.time = SQL_TIME_STRUCT{0, 0, 0};
 			if(!is_null) {
-				const auto time = date::make_time(value->time_since_epoch());
-				t_value.hour = time.hours().count();
-				t_value.minute = time.minutes().count();
-				t_value.second = time.seconds().count();
+				buffer.time = time_from_microseconds(value->time_since_epoch().count());
 			}
 			
-			auto rc = SQLBindParameter(_handle->stmt, 
-									   index, 
-									   SQL_PARAM_INPUT, 
-									   SQL_C_TYPE_TIME, 
-									   SQL_TYPE_TIME, 
-									   8,
-									   0, 
-									   (SQLPOINTER)&t_value, 
-									   sizeof(SQL_DATE_STRUCT), 
-									   &indPtr);
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_TYPE_TIME, 
+									          SQL_TYPE_TIME, 
+									          8,
+									          0, 
+									          (SQLPOINTER)&buffer.time, 
+									          sizeof(SQL_TIME_STRUCT), 
+									          &buffer.indicator);
 			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
 				throw sqlpp::exception("ODBC error: couldn't bind date parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
 			}
 		}
+		void prepared_statement_t::_bind_numeric_parameter(size_t index, const numeric_t* value, bool is_null) {
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: binding numeric parameter"
+				" at index: " << index << ", being " << (is_null ? std::string() : "not") << " null" << std::endl;
+			}
+			auto& buffer = _handle->parameter(index);
+			buffer.indicator = is_null ? SQL_NULL_DATA : 0;
+			const numeric_t number = is_null ? numeric_t() : *value;
+			buffer.numeric = number.to_struct();
+			
+			auto rc = _handle->bind_parameter(index, 
+									          SQL_C_NUMERIC, 
+									          SQL_NUMERIC, 
+									          number.precision(),
+									          number.scale(), 
+									          (SQLPOINTER)&buffer.numeric, 
+									          sizeof(SQL_NUMERIC_STRUCT), 
+									          &buffer.indicator);
+			if(rc != SQL_SUCCESS && rc != SQL_SUCCESS_WITH_INFO) {
+				throw sqlpp::exception("ODBC error: couldn't bind numeric parameter: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+			}
+			//Drivers read the value at the precision and scale of the APD record, not those in the struct
+			detail::set_numeric_descriptor(_handle->stmt, SQL_ATTR_APP_PARAM_DESC, index+1, number.precision(), number.scale(), &buffer.numeric);
+		}
+		
 		SQLHSTMT prepared_statement_t::native_handle() {
 			return _handle->stmt;
 		}
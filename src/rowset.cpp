@@ -0,0 +1,333 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/connection_config.h>
+#include <sqlpp11/odbc/rowset.h>
+#include <sqlpp11/odbc/transcode.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sql.h>
+#include <sqlext.h>
+#include "detail/prepared_statement_handle.h"
+#include "detail/connection_handle.h"
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			SQLSMALLINT c_type_of(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return SQL_C_SBIGINT;
+					case column_kind::floating_point: return SQL_C_DOUBLE;
+					case column_kind::boolean: return SQL_C_BIT;
+					case column_kind::date: return SQL_C_TYPE_DATE;
+					case column_kind::date_time: return SQL_C_TYPE_TIMESTAMP;
+					case column_kind::time_of_day: return SQL_C_TYPE_TIME;
+					case column_kind::numeric: return SQL_C_NUMERIC;
+					default: return SQL_C_CHAR;
+				}
+			}
+			
+			SQLLEN width_of(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return sizeof(SQLBIGINT);
+					case column_kind::floating_point: return sizeof(SQLDOUBLE);
+					case column_kind::boolean: return sizeof(SQLCHAR);
+					case column_kind::date: return sizeof(SQL_DATE_STRUCT);
+					case column_kind::date_time: return sizeof(SQL_TIMESTAMP_STRUCT);
+					case column_kind::time_of_day: return sizeof(SQL_TIME_STRUCT);
+					case column_kind::numeric: return sizeof(SQL_NUMERIC_STRUCT);
+					default: return 0;
+				}
+			}
+			
+			void set_statement_attribute(SQLHSTMT stmt, SQLINTEGER attribute, SQLPOINTER value, const char* name) {
+				if(!SQL_SUCCEEDED(SQLSetStmtAttr(stmt, attribute, value, 0))) {
+					throw sqlpp::exception(std::string("ODBC error: couldn't SQLSetStmtAttr(")+name+"): "+detail::odbc_error(stmt, SQL_HANDLE_STMT));
+				}
+			}
+			
+			column_info describe_column(const detail::result_column_t& column) {
+				column_kind kind;
+				switch(column.sql_type) {
+					case SQL_BIT:
+						kind = column_kind::boolean;
+						break;
+					case SQL_TINYINT:
+					case SQL_SMALLINT:
+					case SQL_INTEGER:
+					case SQL_BIGINT:
+						kind = column_kind::integral;
+						break;
+					case SQL_DECIMAL:
+					case SQL_NUMERIC:
+						kind = column.digits == 0 && column.size <= 18 ? column_kind::integral : column_kind::numeric;
+						break;
+					case SQL_REAL:
+					case SQL_FLOAT:
+					case SQL_DOUBLE:
+						kind = column_kind::floating_point;
+						break;
+					case SQL_TYPE_DATE:
+					case SQL_DATE:
+						kind = column_kind::date;
+						break;
+					case SQL_TYPE_TIMESTAMP:
+					case SQL_TIMESTAMP:
+						kind = column_kind::date_time;
+						break;
+					case SQL_TYPE_TIME:
+					case SQL_TIME:
+						kind = column_kind::time_of_day;
+						break;
+					default:
+						kind = column_kind::text;
+						break;
+				}
+				unsigned precision = 0, scale = 0;
+				if(kind == column_kind::numeric) {
+					precision = static_cast<unsigned>(std::min<SQLULEN>(column.size ? column.size : numeric_t::max_precision, numeric_t::max_precision));
+					scale = static_cast<unsigned>(column.digits);
+				}
+				return column_info{column.name, kind, column.nullable != SQL_NO_NULLS, precision, scale};
+			}
+		}
+		
+		rowset_t::rowset_t(const std::shared_ptr<detail::prepared_statement_handle_t>& handle, const std::vector<column_kind>& kinds, const rowset_config& config)
+			: _handle(handle)
+			, _fetched(new SQLULEN(0))
+			, _capacity(config.rows ? config.rows : statement_options().rowset_size)
+		{
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: Constructing rowset of " << _capacity << " rows, using handle at " << _handle.get() << std::endl;
+			}
+			const std::vector<detail::result_column_t>& described = detail::describe_result(*_handle);
+			if(described.size() != kinds.size()) {
+				throw sqlpp::exception("ODBC error: result has "+std::to_string(described.size())+" columns, expected "+std::to_string(kinds.size()));
+			}
+			set_statement_attribute(_handle->stmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)SQL_BIND_BY_COLUMN, "SQL_ATTR_ROW_BIND_TYPE");
+			set_statement_attribute(_handle->stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)_capacity, "SQL_ATTR_ROW_ARRAY_SIZE");
+			//Drivers may lower the rowset size (01S02 Option value changed)
+			SQLULEN capacity = 0;
+			if(SQL_SUCCEEDED(SQLGetStmtAttr(_handle->stmt, SQL_ATTR_ROW_ARRAY_SIZE, &capacity, 0, nullptr)) && capacity > 0) {
+				_capacity = std::min<size_t>(_capacity, capacity);
+			}
+			set_statement_attribute(_handle->stmt, SQL_ATTR_ROWS_FETCHED_PTR, _fetched.get(), "SQL_ATTR_ROWS_FETCHED_PTR");
+			
+			_columns.resize(kinds.size());
+			for(size_t i = 0; i < kinds.size(); ++i) {
+				column_buffer_t& column = _columns[i];
+				column.kind = kinds[i];
+				column.c_type = c_type_of(kinds[i]);
+				column.width = width_of(kinds[i]);
+				if(column.kind == column_kind::text) {
+					//Don't reserve max_text_length for short columns, a character may take up to 4 bytes
+					size_t length = config.max_text_length;
+					if(described[i].size > 0) {
+						length = std::min<size_t>(length, described[i].size * 4);
+					}
+					column.width = length + 1;
+				}
+				column.precision = 0;
+				column.scale = 0;
+				if(column.kind == column_kind::numeric) {
+					const SQLULEN size = described[i].size;
+					column.precision = static_cast<SQLSMALLINT>(std::min<SQLULEN>(size ? size : numeric_t::max_precision, numeric_t::max_precision));
+					column.scale = described[i].digits;
+				}
+				column.values.resize(_capacity * column.width);
+				column.indicators.resize(_capacity);
+			}
+			_bound.resize(_columns.size());
+			_wide.resize(_columns.size());
+			for(size_t i = 0; i < _columns.size(); ++i) {
+				const bool wide = _handle->wide_text || std::find(config.wide_columns.begin(), config.wide_columns.end(), i) != config.wide_columns.end();
+				if(wide && _columns[i].kind == column_kind::text) {
+					//A UTF-16 unit never takes less than a byte in UTF-8, so the text buffer's width in units is enough
+					_wide[i].resize(_capacity * _columns[i].width);
+				}
+			}
+		}
+		
+		rowset_t& rowset_t::operator=(rowset_t&& rhs) {
+			//rhs takes over our bindings and releases them when it is destroyed
+			rowset_block_t::swap(rhs);
+			std::swap(_handle, rhs._handle);
+			std::swap(_fetched, rhs._fetched);
+			std::swap(_capacity, rhs._capacity);
+			std::swap(_bound, rhs._bound);
+			std::swap(_wide, rhs._wide);
+			return *this;
+		}
+		
+		rowset_t::~rowset_t() {
+			if(!_handle) {
+				return;
+			}
+			//Leave the statement as we found it, so it can be executed and fetched row by row again
+			SQLFreeStmt(_handle->stmt, SQL_CLOSE);
+			detail::unbind_columns(*_handle);
+			SQLSetStmtAttr(_handle->stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+			SQLSetStmtAttr(_handle->stmt, SQL_ATTR_ROWS_FETCHED_PTR, nullptr, 0);
+		}
+		
+		void rowset_t::bind_column(size_t index) {
+			column_buffer_t& column = _columns[index];
+			if(!_wide[index].empty()) {
+				if(!SQL_SUCCEEDED(SQLBindCol(_handle->stmt, index+1, SQL_C_WCHAR, _wide[index].data(), column.width * sizeof(char16_t), column.indicators.data()))) {
+					throw sqlpp::exception("ODBC error: couldn't SQLBindCol("+std::to_string(index+1)+",SQL_C_WCHAR): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+				}
+				_bound[index] = std::make_pair(reinterpret_cast<const char*>(_wide[index].data()), column.indicators.data());
+				return;
+			}
+			if(!SQL_SUCCEEDED(SQLBindCol(_handle->stmt, index+1, column.c_type, column.values.data(), column.width, column.indicators.data()))) {
+				throw sqlpp::exception("ODBC error: couldn't SQLBindCol("+std::to_string(index+1)+"): "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT));
+			}
+			if(column.kind == column_kind::numeric) {
+				detail::set_numeric_descriptor(_handle->stmt, SQL_ATTR_APP_ROW_DESC, index+1, column.precision, column.scale, column.values.data());
+			}
+			_bound[index] = std::make_pair(column.values.data(), column.indicators.data());
+		}
+		
+		rowset_block_t rowset_t::make_block() const {
+			std::vector<column_buffer_t> columns;
+			for(const column_buffer_t& column : _columns) {
+				//Only the shape is copied, not the values
+				columns.push_back(column_buffer_t{column.kind, column.c_type, column.width,
+					std::vector<char>(column.values.size()), std::vector<SQLLEN>(column.indicators.size()), column.precision, column.scale});
+			}
+			return rowset_block_t(std::move(columns));
+		}
+		
+		bool rowset_t::fetch() {
+			if(!_handle) {
+				return false;
+			}
+			if(_handle->debug) {
+				std::cerr << "ODBC debug: fetching rowset, handle at " << _handle.get() << std::endl;
+			}
+			for(size_t i = 0; i < _columns.size(); ++i) {
+				const char* values = _wide[i].empty() ? _columns[i].values.data() : reinterpret_cast<const char*>(_wide[i].data());
+				if(_bound[i].first != values || _bound[i].second != _columns[i].indicators.data()) {
+					bind_column(i);
+				}
+			}
+			SQLRETURN rc;
+			while((rc = SQLFetch(_handle->stmt)) == SQL_STILL_EXECUTING){}
+			switch(rc) {
+				case SQL_NO_DATA:
+					*_fetched = 0;
+					_size = 0;
+					return false;
+				case SQL_SUCCESS:
+				case SQL_SUCCESS_WITH_INFO:
+					break;
+				default:
+					detail::throw_error("ODBC error: couldn't SQLFetch rowset: "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT, rc), detail::sqlstate(_handle->stmt, SQL_HANDLE_STMT));
+			}
+			_size = static_cast<size_t>(*_fetched);
+			for(size_t i = 0; i < _columns.size(); ++i) {
+				const column_buffer_t& column = _columns[i];
+				if(column.kind != column_kind::text) {
+					continue;
+				}
+				if(!_wide[i].empty()) {
+					convert_wide_column(i);
+					continue;
+				}
+				for(size_t row = 0; row < size(); ++row) {
+					const SQLLEN ind = column.indicators[row];
+					if(ind == SQL_NO_TOTAL || ind >= column.width) {
+						throw sqlpp::exception("ODBC error: text in column "+std::to_string(i+1)+" is longer than "+
+							std::to_string(column.width - 1)+" bytes, raise rowset_config::max_text_length");
+					}
+				}
+			}
+			if(rc == SQL_SUCCESS_WITH_INFO) {
+				std::cerr << "ODBC warning: SQLFetch returned info "+detail::odbc_error(_handle->stmt, SQL_HANDLE_STMT) << std::endl;
+			}
+			return size() > 0;
+		}
+		
+		void rowset_t::convert_wide_column(size_t index) {
+			column_buffer_t& column = _columns[index];
+			const SQLLEN wide_width = column.width * static_cast<SQLLEN>(sizeof(char16_t));
+			for(size_t row = 0; row < size(); ++row) {
+				SQLLEN& ind = column.indicators[row];
+				if(ind == SQL_NULL_DATA) {
+					continue;
+				}
+				size_t length = transcode_overflow;
+				if(ind != SQL_NO_TOTAL && ind < wide_width) {
+					//Leave room for the null terminator, like the driver does for SQL_C_CHAR
+					char* text = column.values.data() + row * column.width;
+					length = utf16_to_utf8(_wide[index].data() + row * column.width, ind / sizeof(char16_t), text, column.width - 1);
+					if(length != transcode_overflow) {
+						text[length] = '\0';
+						ind = static_cast<SQLLEN>(length);
+					}
+				}
+				if(length == transcode_overflow) {
+					throw sqlpp::exception("ODBC error: text in column "+std::to_string(index+1)+" is longer than "+
+						std::to_string(column.width - 1)+" bytes, raise rowset_config::max_text_length");
+				}
+			}
+		}
+		
+		SQLHSTMT rowset_t::native_handle() {
+			return _handle->stmt;
+		}
+		
+		std::vector<column_info> describe_columns(SQLHSTMT stmt) {
+			std::vector<column_info> columns;
+			for(const detail::result_column_t& column : detail::describe_result(stmt)) {
+				columns.push_back(describe_column(column));
+			}
+			return columns;
+		}
+		
+		std::vector<column_info> describe_columns(detail::prepared_statement_handle_t& statement) {
+			std::vector<column_info> columns;
+			for(const detail::result_column_t& column : detail::describe_result(statement)) {
+				columns.push_back(describe_column(column));
+			}
+			return columns;
+		}
+	}
+}
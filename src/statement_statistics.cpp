@@ -0,0 +1,228 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <utility>
+#include <sqlpp11/odbc/statement_statistics.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			bool is_identifier_char(char c) {
+				return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+			}
+			
+			//! Buckets 0-3 hold 0-3 microseconds, after that each power of two is split into 4
+			size_t bucket_of(uint64_t microseconds) {
+				if(microseconds < 4) {
+					return static_cast<size_t>(microseconds);
+				}
+				size_t msb = 0;
+				while((microseconds >> (msb + 1)) != 0) {
+					++msb;
+				}
+				const size_t bucket = 4 * (msb - 1) + ((microseconds >> (msb - 2)) & 3);
+				return std::min(bucket, statement_statistics_t::histogram_buckets - 1);
+			}
+			
+			//! Largest duration falling into the bucket
+			uint64_t bucket_limit(size_t bucket) {
+				if(bucket < 4) {
+					return bucket;
+				}
+				const size_t msb = bucket / 4 + 1;
+				return ((UINT64_C(4) + bucket % 4 + 1) << (msb - 2)) - 1;
+			}
+		}
+		
+		std::string statement_fingerprint(const std::string& statement) {
+			std::string ret;
+			ret.reserve(statement.size());
+			//Position after the last value in ret and whether it was followed by a list of more values
+			size_t value_end = std::string::npos;
+			const auto add_value = [&]() {
+				//Another value after "?," (or "...,") continues a list
+				if(value_end != std::string::npos) {
+					size_t i = value_end;
+					while(i < ret.size() && (ret[i] == ' ' || ret[i] == ',')) {
+						++i;
+					}
+					if(i == ret.size() && ret.find(',', value_end) != std::string::npos) {
+						ret.resize(value_end);
+						if(ret.compare(ret.size() - 3, 3, "...") != 0) {
+							ret.replace(ret.size() - 1, 1, "...");
+						}
+						value_end = ret.size();
+						return;
+					}
+				}
+				ret.push_back('?');
+				value_end = ret.size();
+			};
+			for(size_t i = 0; i < statement.size();) {
+				const char c = statement[i];
+				if(c == '\'') {
+					//'' inside a literal is an escaped quote
+					for(++i; i < statement.size(); ++i) {
+						if(statement[i] == '\'') {
+							if(i + 1 < statement.size() && statement[i+1] == '\'') {
+								++i;
+							} else {
+								++i;
+								break;
+							}
+						}
+					}
+					add_value();
+				} else if(c == '"') {
+					//Quoted identifiers are kept
+					const size_t end = statement.find('"', i + 1);
+					const size_t next = end == std::string::npos ? statement.size() : end + 1;
+					ret.append(statement, i, next - i);
+					i = next;
+				} else if(std::isspace(static_cast<unsigned char>(c))) {
+					while(i < statement.size() && std::isspace(static_cast<unsigned char>(statement[i]))) {
+						++i;
+					}
+					if(!ret.empty() && i < statement.size()) {
+						ret.push_back(' ');
+					}
+				} else if(std::isdigit(static_cast<unsigned char>(c)) && (ret.empty() || !is_identifier_char(ret.back()))) {
+					while(i < statement.size() && (is_identifier_char(statement[i]) || statement[i] == '.' ||
+						((statement[i] == '+' || statement[i] == '-') && (statement[i-1] == 'e' || statement[i-1] == 'E')))) {
+						++i;
+					}
+					add_value();
+				} else if(c == '?') {
+					++i;
+					add_value();
+				} else if(is_identifier_char(c)) {
+					while(i < statement.size() && is_identifier_char(statement[i])) {
+						ret.push_back(statement[i++]);
+					}
+				} else {
+					ret.push_back(c);
+					++i;
+				}
+			}
+			return ret;
+		}
+		
+		statement_statistics_t::statement_statistics_t(statement_statistics_config config)
+			: _config(std::move(config))
+		{
+			_entries.reserve(_config.max_statements);
+		}
+		
+		statement_statistics_t::entry_t& statement_statistics_t::entry(const std::string& fingerprint) {
+			auto it = _entries.find(fingerprint);
+			if(it != _entries.end()) {
+				return it->second;
+			}
+			entry_t replacement;
+			if(_entries.size() >= std::max<size_t>(_config.max_statements, 1)) {
+				//Only happens for statements not seen before once the table is full, a linear scan is fine
+				auto least = std::min_element(_entries.begin(), _entries.end(),
+					[](const std::pair<const std::string, entry_t>& lhs, const std::pair<const std::string, entry_t>& rhs) {
+						return lhs.second.count < rhs.second.count;
+					});
+				replacement.count = least->second.count;
+				replacement.count_error = least->second.count;
+				_entries.erase(least);
+			}
+			return _entries.emplace(fingerprint, replacement).first->second;
+		}
+		
+		void statement_statistics_t::record(const std::string& fingerprint, std::chrono::microseconds duration, size_t rows) {
+			const uint64_t microseconds = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				entry_t& e = entry(fingerprint);
+				++e.count;
+				e.total_time += microseconds;
+				e.max_time = std::max(e.max_time, microseconds);
+				e.total_rows += rows;
+				e.max_rows = std::max<uint64_t>(e.max_rows, rows);
+				++e.histogram[bucket_of(microseconds)];
+			}
+			if(_config.slow_threshold.count() <= 0 || duration <= _config.slow_threshold) {
+				return;
+			}
+			if(_config.slow_statement_log) {
+				_config.slow_statement_log(fingerprint, duration, rows);
+			} else {
+				std::cerr << "ODBC slow statement: " << microseconds / 1000.0 << " ms, " << rows << " rows: " << fingerprint << std::endl;
+			}
+		}
+		
+		std::vector<statement_stats> statement_statistics_t::top(size_t n) const {
+			std::vector<statement_stats> ret;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				ret.reserve(_entries.size());
+				for(const auto& item : _entries) {
+					const entry_t& e = item.second;
+					//Executions recorded here, without the ones inherited from a replaced statement
+					uint64_t recorded = 0;
+					for(uint32_t bucket : e.histogram) {
+						recorded += bucket;
+					}
+					const uint64_t rank = recorded - recorded / 100;
+					uint64_t seen = 0;
+					uint64_t p99 = 0;
+					for(size_t b = 0; b < histogram_buckets; ++b) {
+						seen += e.histogram[b];
+						if(seen >= rank && seen > 0) {
+							p99 = std::min(bucket_limit(b), e.max_time);
+							break;
+						}
+					}
+					ret.push_back(statement_stats{item.first, e.count, e.count_error, std::chrono::microseconds(e.total_time),
+						std::chrono::microseconds(e.max_time), std::chrono::microseconds(p99), e.total_rows, e.max_rows});
+				}
+			}
+			std::sort(ret.begin(), ret.end(), [](const statement_stats& lhs, const statement_stats& rhs) {
+				return lhs.total_time > rhs.total_time;
+			});
+			if(ret.size() > n) {
+				ret.resize(n);
+			}
+			return ret;
+		}
+		
+		size_t statement_statistics_t::size() const {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _entries.size();
+		}
+		
+		void statement_statistics_t::clear() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_entries.clear();
+		}
+	}
+}
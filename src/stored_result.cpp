@@ -0,0 +1,202 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/civil_time.h>
+#include <sqlpp11/odbc/numeric.h>
+#include <sqlpp11/odbc/stored_result.h>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			//Text slots hold the offset into the heap and the length
+			struct text_slot_t {
+				uint64_t offset;
+				uint64_t length;
+			};
+			
+			size_t slot_width_of(column_kind kind) {
+				switch(kind) {
+					case column_kind::integral: return sizeof(SQLBIGINT);
+					case column_kind::floating_point: return sizeof(SQLDOUBLE);
+					case column_kind::boolean: return sizeof(SQLCHAR);
+					case column_kind::date: return sizeof(SQL_DATE_STRUCT);
+					case column_kind::date_time: return sizeof(SQL_TIMESTAMP_STRUCT);
+					case column_kind::time_of_day: return sizeof(SQL_TIME_STRUCT);
+					case column_kind::numeric: return sizeof(SQL_NUMERIC_STRUCT);
+					default: return sizeof(text_slot_t);
+				}
+			}
+			
+			//Slots are not aligned, so values are copied out of them
+			template <typename T>
+			T read_slot(const char* slot) {
+				T value;
+				std::memcpy(&value, slot, sizeof(T));
+				return value;
+			}
+			
+			std::vector<column_kind> kinds_of(const rowset_block_t& block) {
+				std::vector<column_kind> kinds;
+				for(size_t i = 0; i < block.column_count(); ++i) {
+					kinds.push_back(block.column(i).kind);
+				}
+				return kinds;
+			}
+		}
+		
+		stored_result_t::stored_result_t(const std::vector<column_kind>& kinds)
+			: _kinds(kinds)
+		{
+			for(column_kind kind : _kinds) {
+				_offsets.push_back(_row_width);
+				_row_width += slot_width_of(kind);
+			}
+		}
+		
+		stored_result_t::stored_result_t(rowset_t&& rowset)
+			: stored_result_t(kinds_of(rowset))
+		{
+			rowset_t drained(std::move(rowset));
+			while(drained.fetch()) {
+				append(drained);
+			}
+		}
+		
+		void stored_result_t::append(const rowset_block_t& block) {
+			append(block, 0, block.size());
+		}
+		
+		void stored_result_t::append(const rowset_block_t& block, size_t first, size_t rows) {
+			if(block.column_count() != _kinds.size()) {
+				throw sqlpp::exception("ODBC error: block has "+std::to_string(block.column_count())+" columns, stored result has "+std::to_string(_kinds.size()));
+			}
+			if(first + rows > block.size()) {
+				throw sqlpp::exception("ODBC error: rows "+std::to_string(first)+" to "+std::to_string(first + rows)+" are not in a block of "+std::to_string(block.size()));
+			}
+			const size_t columns = _kinds.size();
+			_slots.resize((_size + rows) * _row_width);
+			_nulls.resize((_size + rows) * columns);
+			for(size_t c = 0; c < columns; ++c) {
+				const rowset_block_t::column_buffer_t& column = block.column(c);
+				if(column.kind != _kinds[c]) {
+					throw sqlpp::exception("ODBC error: column "+std::to_string(c+1)+" of the block has a different kind than the stored result");
+				}
+				const size_t width = slot_width_of(column.kind);
+				char* slot = _slots.data() + _size * _row_width + _offsets[c];
+				for(size_t i = 0; i < rows; ++i, slot += _row_width) {
+					const size_t row = first + i;
+					const bool is_null = block.is_null(c, row);
+					_nulls[(_size + i) * columns + c] = is_null;
+					if(is_null) {
+						continue;
+					}
+					if(column.kind == column_kind::text) {
+						const text_slot_t text = {_heap.size(), block.text_length(c, row)};
+						_heap.insert(_heap.end(), block.text(c, row), block.text(c, row) + text.length);
+						std::memcpy(slot, &text, sizeof(text));
+					} else {
+						std::memcpy(slot, column.values.data() + row * column.width, width);
+					}
+				}
+			}
+			_size += rows;
+		}
+		
+		void stored_result_t::_bind_boolean_result(size_t index, signed char* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = static_cast<signed char>(read_slot<SQLCHAR>(slot(index)));
+			}
+		}
+		
+		void stored_result_t::_bind_floating_point_result(size_t index, double* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = read_slot<SQLDOUBLE>(slot(index));
+			}
+		}
+		
+		void stored_result_t::_bind_integral_result(size_t index, int64_t* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = read_slot<SQLBIGINT>(slot(index));
+			}
+		}
+		
+		void stored_result_t::_bind_text_result(size_t index, const char** value, size_t* len) {
+			if(null(index)) {
+				*value = nullptr;
+				*len = 0;
+				return;
+			}
+			const text_slot_t text = read_slot<text_slot_t>(slot(index));
+			//sqlpp11 reads a nullptr as NULL, and the heap has no data() yet if all texts so far were empty
+			static const char empty[] = "";
+			*value = text.length == 0 ? empty : _heap.data() + text.offset;
+			*len = static_cast<size_t>(text.length);
+		}
+		
+		void stored_result_t::_bind_date_result(size_t index, ::sqlpp::day_point::_cpp_value_type* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				const SQL_DATE_STRUCT date_struct = read_slot<SQL_DATE_STRUCT>(slot(index));
+				*value = ::sqlpp::day_point::_cpp_value_type(::sqlpp::chrono::days(days_from_civil(date_struct.year, date_struct.month, date_struct.day)));
+			}
+		}
+		
+		void stored_result_t::_bind_date_time_result(size_t index, ::sqlpp::time_point::_cpp_value_type* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = ::sqlpp::time_point::_cpp_value_type(std::chrono::microseconds(microseconds_from_timestamp(read_slot<SQL_TIMESTAMP_STRUCT>(slot(index)))));
+			}
+		}
+		
+		void stored_result_t::_bind_time_of_day_result(size_t index, ::sqlpp::time_of_day::_cpp_value_type* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = std::chrono::microseconds(microseconds_from_time(read_slot<SQL_TIME_STRUCT>(slot(index))));
+			}
+		}
+		
+		void stored_result_t::_bind_timestamp_result(size_t index, SQL_TIMESTAMP_STRUCT* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = read_slot<SQL_TIMESTAMP_STRUCT>(slot(index));
+			}
+		}
+		
+		void stored_result_t::_bind_numeric_result(size_t index, numeric_t* value, bool* is_null) {
+			*is_null = null(index);
+			if(!*is_null) {
+				*value = numeric_t(read_slot<SQL_NUMERIC_STRUCT>(slot(index)));
+			}
+		}
+	}
+}
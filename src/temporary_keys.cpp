@@ -0,0 +1,184 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/temporary_keys.h>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sql.h>
+#include <sqlext.h>
+#include "detail/prepared_statement_handle.h"
+#include "detail/connection_handle.h"
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			std::string drop_statement(ODBC_Type type, const std::string& name) {
+				switch(type) {
+					case ODBC_Type::MySQL:
+						return "DROP TEMPORARY TABLE IF EXISTS " + name;
+					case ODBC_Type::TSQL:
+						return "DROP TABLE " + name;
+					default:
+						return "DROP TABLE IF EXISTS " + name;
+				}
+			}
+			
+			//! Shortens the arrays for the last chunk of keys, which the driver took at full capacity
+			void set_array_size(detail::prepared_statement_handle_t& prepared, size_t capacity, size_t sets) {
+				if(sets < capacity && detail::set_parameter_array(prepared, sets, nullptr, nullptr) != sets) {
+					throw sqlpp::exception("ODBC error: couldn't set SQL_ATTR_PARAMSET_SIZE to "+std::to_string(sets)+": "+detail::odbc_error(prepared.stmt, SQL_HANDLE_STMT));
+				}
+			}
+			
+			void check_bound(detail::prepared_statement_handle_t& prepared, SQLRETURN rc) {
+				if(!SQL_SUCCEEDED(rc)) {
+					throw sqlpp::exception("ODBC error: couldn't bind the keys of a temporary table: "+detail::odbc_error(prepared.stmt, SQL_HANDLE_STMT));
+				}
+			}
+		}
+		
+		temporary_keys_t::temporary_keys_t(connection& db, std::string name, const std::string& column, const std::vector<int64_t>& keys, const temporary_keys_config& config)
+			: _db(&db)
+			, _name(std::move(name))
+		{
+			create(column, "BIGINT", config);
+			try {
+				auto prepared = _db->prepare_statement("INSERT INTO " + _name + " (" + column + ") VALUES (?)");
+				//Drivers may take fewer sets than asked for, or none at all and one key per SQLExecute then
+				const size_t capacity = detail::set_parameter_array(*prepared, std::max<size_t>(config.batch_size, 1), nullptr, nullptr);
+				std::vector<int64_t> values(capacity);
+				std::vector<SQLLEN> indicators(capacity, 0);
+				check_bound(*prepared, prepared->bind_parameter(0, SQL_C_SBIGINT, SQL_BIGINT, 0, 0, values.data(), sizeof(int64_t), indicators.data()));
+				for(size_t begin = 0; begin < keys.size(); begin += capacity) {
+					const size_t sets = std::min(capacity, keys.size() - begin);
+					std::copy(keys.begin() + begin, keys.begin() + begin + sets, values.begin());
+					set_array_size(*prepared, capacity, sets);
+					_db->execute_statement(*prepared);
+					_size += sets;
+				}
+			} catch(...) {
+				drop();
+				throw;
+			}
+		}
+		
+		temporary_keys_t::temporary_keys_t(connection& db, std::string name, const std::string& column, const std::vector<std::string>& keys, const temporary_keys_config& config)
+			: _db(&db)
+			, _name(std::move(name))
+		{
+			for(const auto& key : keys) {
+				if(key.size() > config.text_length) {
+					throw sqlpp::exception("ODBC error: key of "+std::to_string(key.size())+" bytes exceeds temporary_keys_config::text_length");
+				}
+			}
+			create(column, "VARCHAR(" + std::to_string(config.text_length) + ")", config);
+			try {
+				auto prepared = _db->prepare_statement("INSERT INTO " + _name + " (" + column + ") VALUES (?)");
+				const size_t capacity = detail::set_parameter_array(*prepared, std::max<size_t>(config.batch_size, 1), nullptr, nullptr);
+				//Column-wise arrays are packed at the buffer length, terminated keys fit one byte more than the column
+				const size_t width = config.text_length + 1;
+				std::vector<char> values(capacity * width);
+				std::vector<SQLLEN> indicators(capacity);
+				check_bound(*prepared, prepared->bind_parameter(0, SQL_C_CHAR, SQL_VARCHAR, config.text_length, 0, values.data(), static_cast<SQLLEN>(width), indicators.data()));
+				for(size_t begin = 0; begin < keys.size(); begin += capacity) {
+					const size_t sets = std::min(capacity, keys.size() - begin);
+					for(size_t i = 0; i < sets; ++i) {
+						const std::string& key = keys[begin + i];
+						std::memcpy(&values[i * width], key.data(), key.size());
+						values[i * width + key.size()] = '\0';
+						indicators[i] = static_cast<SQLLEN>(key.size());
+					}
+					set_array_size(*prepared, capacity, sets);
+					_db->execute_statement(*prepared);
+					_size += sets;
+				}
+			} catch(...) {
+				drop();
+				throw;
+			}
+		}
+		
+		temporary_keys_t::temporary_keys_t(temporary_keys_t&& rhs)
+			: _db(rhs._db)
+			, _name(std::move(rhs._name))
+			, _size(rhs._size)
+		{
+			rhs._db = nullptr;
+		}
+		
+		temporary_keys_t::~temporary_keys_t() {
+			if(_db) {
+				drop();
+			}
+		}
+		
+		void temporary_keys_t::drop() {
+			try {
+				_db->execute(drop_statement(_db->type(), _name));
+			} catch(const std::exception& e) {
+				std::cerr << "ODBC warning: couldn't drop temporary table " << _name << ": " << e.what() << std::endl;
+			}
+		}
+		
+		void temporary_keys_t::create(const std::string& column, const std::string& type, const temporary_keys_config& config) {
+			const std::string definition = " (" + column + " " + type + " NOT NULL" + (config.primary_key ? " PRIMARY KEY)" : ")");
+			switch(_db->type()) {
+				case ODBC_Type::MySQL:
+				case ODBC_Type::PostgreSQL:
+					_db->execute("CREATE TEMPORARY TABLE " + _name + definition);
+					break;
+				case ODBC_Type::SQLite3:
+					_db->execute("CREATE TEMP TABLE " + _name + definition);
+					break;
+				case ODBC_Type::TSQL:
+					//Local temporary tables are the ones named #..., anything else would outlive the session
+					if(_name.empty() || _name[0] != '#') {
+						throw sqlpp::exception("ODBC error: temporary tables on TSQL need a name starting with #, got "+_name);
+					}
+					_db->execute("CREATE TABLE " + _name + definition);
+					break;
+				default:
+					throw sqlpp::exception("ODBC error: temporary tables are not supported for this ODBC_Type");
+			}
+		}
+	}
+}
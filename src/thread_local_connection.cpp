@@ -0,0 +1,150 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <sqlpp11/exception.h>
+#include <sqlpp11/odbc/thread_local_connection.h>
+
+namespace sqlpp {
+	namespace odbc {
+		struct thread_local_connection::state_t {
+			std::function<std::unique_ptr<connection>()> connect;
+			thread_local_connection_config limits;
+			mutable std::mutex mutex;
+			std::condition_variable released;
+			size_t open = 0;
+			
+			//! Counts a new connection, waiting for another one to be released if max_connections are open
+			void acquire() {
+				std::unique_lock<std::mutex> lock(mutex);
+				if(limits.max_connections && !released.wait_for(lock, limits.max_wait, [this]() { return open < limits.max_connections; })) {
+					throw sqlpp::exception("ODBC error: all "+std::to_string(limits.max_connections)+" connections are in use by other threads");
+				}
+				++open;
+			}
+			
+			void release() {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					--open;
+				}
+				released.notify_one();
+			}
+		};
+		
+		namespace {
+			//! The connections of one thread, one for every thread_local_connection it used
+			struct thread_connections_t {
+				struct entry_t {
+					std::weak_ptr<thread_local_connection::state_t> state;
+					std::unique_ptr<connection> db;
+				};
+				std::vector<entry_t> entries;
+				
+				static void close(entry_t& entry) {
+					entry.db.reset();
+					if(auto state = entry.state.lock()) {
+						state->release();
+					}
+				}
+				
+				~thread_connections_t() {
+					for(entry_t& entry : entries) {
+						close(entry);
+					}
+				}
+			};
+			
+			thread_connections_t& this_thread() {
+				//Destroyed when the thread exits
+				thread_local thread_connections_t connections;
+				return connections;
+			}
+		}
+		
+		thread_local_connection::thread_local_connection(const connection_config& config, thread_local_connection_config limits)
+			: _state(std::make_shared<state_t>())
+		{
+			_state->limits = limits;
+			_state->connect = [config]() { return std::unique_ptr<connection>(new connection(config)); };
+		}
+		
+		thread_local_connection::thread_local_connection(const driver_connection_config& config, thread_local_connection_config limits)
+			: _state(std::make_shared<state_t>())
+		{
+			_state->limits = limits;
+			_state->connect = [config]() { return std::unique_ptr<connection>(new connection(config)); };
+		}
+		
+		thread_local_connection::~thread_local_connection() {
+			release();
+		}
+		
+		connection& thread_local_connection::get() {
+			std::vector<thread_connections_t::entry_t>& entries = this_thread().entries;
+			for(auto it = entries.begin(); it != entries.end();) {
+				const std::shared_ptr<state_t> state = it->state.lock();
+				if(state == _state) {
+					return *it->db;
+				}
+				if(!state) {
+					//Left behind by a thread_local_connection that is gone
+					it = entries.erase(it);
+				} else {
+					++it;
+				}
+			}
+			_state->acquire();
+			std::unique_ptr<connection> db;
+			try {
+				db = _state->connect();
+			} catch(...) {
+				_state->release();
+				throw;
+			}
+			entries.push_back({_state, std::move(db)});
+			return *entries.back().db;
+		}
+		
+		void thread_local_connection::release() {
+			std::vector<thread_connections_t::entry_t>& entries = this_thread().entries;
+			for(auto it = entries.begin(); it != entries.end(); ++it) {
+				if(it->state.lock() == _state) {
+					thread_connections_t::close(*it);
+					entries.erase(it);
+					return;
+				}
+			}
+		}
+		
+		size_t thread_local_connection::size() const {
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			return _state->open;
+		}
+	}
+}
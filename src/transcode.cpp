@@ -0,0 +1,203 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+#include <sqlpp11/odbc/transcode.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SQLPP11_ODBC_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace sqlpp {
+	namespace odbc {
+		namespace {
+			const uint32_t replacement_character = 0xFFFD;
+			
+			//! Writes the UTF-8 encoding of c, returns its length or 0 if it doesn't fit
+			size_t encode_utf8(uint32_t c, char* out, size_t capacity) {
+				if(c < 0x80) {
+					if(capacity < 1) {
+						return 0;
+					}
+					out[0] = static_cast<char>(c);
+					return 1;
+				}
+				if(c < 0x800) {
+					if(capacity < 2) {
+						return 0;
+					}
+					out[0] = static_cast<char>(0xC0 | (c >> 6));
+					out[1] = static_cast<char>(0x80 | (c & 0x3F));
+					return 2;
+				}
+				if(c < 0x10000) {
+					if(capacity < 3) {
+						return 0;
+					}
+					out[0] = static_cast<char>(0xE0 | (c >> 12));
+					out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					out[2] = static_cast<char>(0x80 | (c & 0x3F));
+					return 3;
+				}
+				if(capacity < 4) {
+					return 0;
+				}
+				out[0] = static_cast<char>(0xF0 | (c >> 18));
+				out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+				out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+				out[3] = static_cast<char>(0x80 | (c & 0x3F));
+				return 4;
+			}
+			
+			//! Decodes the sequence at in, returns the number of bytes it takes.
+			// Invalid sequences give U+FFFD for their longest valid prefix (at least one byte), as recommended by Unicode.
+			size_t decode_utf8(const unsigned char* in, size_t length, uint32_t& c) {
+				const unsigned char lead = in[0];
+				size_t size = 0;
+				//Range of the second byte, which excludes overlong forms, surrogates and code points above U+10FFFF
+				unsigned char lower = 0x80, upper = 0xBF;
+				if(lead < 0x80) {
+					c = lead;
+					return 1;
+				} else if(lead >= 0xC2 && lead <= 0xDF) {
+					size = 2;
+					c = lead & 0x1F;
+				} else if(lead >= 0xE0 && lead <= 0xEF) {
+					size = 3;
+					c = lead & 0x0F;
+					lower = lead == 0xE0 ? 0xA0 : 0x80;
+					upper = lead == 0xED ? 0x9F : 0xBF;
+				} else if(lead >= 0xF0 && lead <= 0xF4) {
+					size = 4;
+					c = lead & 0x07;
+					lower = lead == 0xF0 ? 0x90 : 0x80;
+					upper = lead == 0xF4 ? 0x8F : 0xBF;
+				} else {
+					c = replacement_character;
+					return 1;
+				}
+				for(size_t i = 1; i < size; ++i) {
+					if(i >= length || in[i] < lower || in[i] > upper) {
+						c = replacement_character;
+						return i;
+					}
+					c = (c << 6) | (in[i] & 0x3F);
+					lower = 0x80;
+					upper = 0xBF;
+				}
+				return size;
+			}
+		}
+		
+		size_t utf16_to_utf8(const char16_t* in, size_t length, char* out, size_t capacity) {
+			size_t i = 0, o = 0;
+			while(i < length) {
+#ifdef SQLPP11_ODBC_SSE2
+				//8 units at a time as long as they are all ASCII
+				const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+				while(i + 8 <= length && o + 8 <= capacity) {
+					const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+					if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, non_ascii), _mm_setzero_si128())) != 0xFFFF) {
+						break;
+					}
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out + o), _mm_packus_epi16(units, units));
+					i += 8;
+					o += 8;
+				}
+				if(i == length) {
+					break;
+				}
+#endif
+				uint32_t c = in[i++];
+				if(c >= 0xD800 && c < 0xE000) {
+					if(c < 0xDC00 && i < length && in[i] >= 0xDC00 && in[i] < 0xE000) {
+						c = 0x10000 + ((c - 0xD800) << 10) + (in[i++] - 0xDC00);
+					} else {
+						c = replacement_character;
+					}
+				}
+				const size_t size = encode_utf8(c, out + o, capacity - o);
+				if(!size) {
+					return transcode_overflow;
+				}
+				o += size;
+			}
+			return o;
+		}
+		
+		size_t utf8_to_utf16(const char* in, size_t length, char16_t* out, size_t capacity) {
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+			size_t i = 0, o = 0;
+			while(i < length) {
+#ifdef SQLPP11_ODBC_SSE2
+				//16 bytes at a time as long as they are all ASCII, widened by interleaving with zeros
+				while(i + 16 <= length && o + 16 <= capacity) {
+					const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+					if(_mm_movemask_epi8(chars)) {
+						break;
+					}
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_unpacklo_epi8(chars, _mm_setzero_si128()));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + o + 8), _mm_unpackhi_epi8(chars, _mm_setzero_si128()));
+					i += 16;
+					o += 16;
+				}
+				if(i == length) {
+					break;
+				}
+#endif
+				uint32_t c = 0;
+				i += decode_utf8(bytes + i, length - i, c);
+				if(c < 0x10000) {
+					if(o >= capacity) {
+						return transcode_overflow;
+					}
+					out[o++] = static_cast<char16_t>(c);
+				} else {
+					if(o + 2 > capacity) {
+						return transcode_overflow;
+					}
+					c -= 0x10000;
+					out[o++] = static_cast<char16_t>(0xD800 + (c >> 10));
+					out[o++] = static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+				}
+			}
+			return o;
+		}
+		
+		std::string utf16_to_utf8(const std::u16string& text) {
+			std::string ret(3 * text.size(), '\0');
+			ret.resize(utf16_to_utf8(text.data(), text.size(), &ret[0], ret.size()));
+			return ret;
+		}
+		
+		std::u16string utf8_to_utf16(const std::string& text) {
+			std::u16string ret(text.size(), u'\0');
+			ret.resize(utf8_to_utf16(text.data(), text.size(), &ret[0], ret.size()));
+			return ret;
+		}
+	}
+}
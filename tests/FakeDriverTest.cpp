@@ -0,0 +1,834 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TabSample.h"
+#include "fake_driver/fake_driver.h"
+#include <sqlpp11/sqlpp11.h>
+#include <sqlpp11/odbc/odbc.h>
+#include <date/date.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cassert>
+
+namespace odbc = sqlpp::odbc;
+
+//! A prepared statement with a single numeric_t parameter, standing in for a custom data type's
+struct numeric_statement_t {
+	mutable odbc::prepared_statement_t _prepared_statement;
+	odbc::numeric_t parameter;
+	
+	void _bind_params() const {
+		_prepared_statement._bind_numeric_parameter(0, &parameter, false);
+	}
+};
+
+//! A result row of a single numeric_t column, for bind_result_t::next
+struct numeric_row_t {
+	bool valid = false;
+	odbc::numeric_t amount;
+	bool is_null = true;
+	
+	void _validate() { valid = true; }
+	void _invalidate() { valid = false; }
+	explicit operator bool() const { return valid; }
+	void _bind(odbc::bind_result_t& result) {
+		result._bind_numeric_result(0, &amount, &is_null);
+	}
+};
+
+int main()
+{
+	try {
+		//The fake driver is linked in directly, any data source name will do
+		odbc::connection_config config;
+		config.data_source_name = "fake";
+		config.type = odbc::ODBC_Type::MySQL;
+		config.debug = false;
+		odbc::connection db(config);
+		
+		db.execute(R"(DROP TABLE IF EXISTS tab_sample)");
+		db.execute(R"(DROP TABLE IF EXISTS tab_foo)");
+		db.execute(R"(DROP TABLE IF EXISTS tab_bar)");
+		db.execute(R"(CREATE TABLE tab_foo (
+				omega BIGINT NOT NULL AUTO_INCREMENT,
+				name VARCHAR(32),
+				PRIMARY KEY (omega)
+			))");
+		db.execute(R"(CREATE TABLE tab_sample (
+				alpha bigint(20) DEFAULT NULL,
+				beta varchar(2048) DEFAULT NULL,
+				gamma bool DEFAULT NULL,
+				FOREIGN KEY (alpha) REFERENCES tab_foo(omega)
+				))");
+		db.execute(R"(CREATE TABLE tab_bar (
+				delta date DEFAULT NULL,
+				epsilon datetime DEFAULT NULL,
+				zeta timestamp,
+				eta time DEFAULT NULL
+			))");
+		
+		TabFoo foo;
+		TabSample tab;
+		TabBar bar;
+		
+		const size_t first_id = db.insert(insert_into(foo).set(foo.name = "first"));
+		assert(first_id == 1);
+		const size_t second_id = db.insert(insert_into(foo).set(foo.name = "second"));
+		assert(second_id == 2);
+		
+		db(insert_into(tab).set(tab.alpha = 1, tab.gamma = true, tab.beta = "cheesecake"));
+		db(insert_into(tab).set(tab.gamma = false, tab.beta = "blueberry muffin"));
+		{
+			auto result = db(select(all_of(tab)).from(tab).unconditionally());
+			assert(result.size() == 2);
+			auto& row = result.front();
+			assert(row.alpha.value() == 1);
+			assert(row.beta.value() == "cheesecake");
+			assert(row.gamma.value());
+			result.pop_front();
+			assert(row.alpha.is_null());
+			assert(row.beta.value() == "blueberry muffin");
+			assert(!row.gamma.value());
+		}
+		
+		//Text longer than the initial fetch buffer is retrieved in several parts
+		const std::string long_text(1000, 'x');
+		db(update(tab).set(tab.beta = long_text).where(tab.alpha == 1));
+		for(const auto& row : db(select(tab.beta).from(tab).where(tab.alpha == 1))) {
+			assert(row.beta.value() == long_text);
+		}
+		db(update(tab).set(tab.beta = sqlpp::null).where(tab.alpha == 1));
+		for(const auto& row : db(select(tab.beta).from(tab).where(tab.alpha == 1))) {
+			assert(row.beta.is_null());
+		}
+		
+		//Prepared statements bind parameters by position and can be executed repeatedly
+		auto prepared_insert = db.prepare(insert_into(tab).set(
+			tab.alpha = parameter(tab.alpha), tab.beta = parameter(tab.beta), tab.gamma = parameter(tab.gamma)));
+		prepared_insert.params.alpha = 2;
+		prepared_insert.params.beta = "apple pie";
+		prepared_insert.params.gamma = true;
+		db(prepared_insert);
+		prepared_insert.params.alpha = 2;
+		prepared_insert.params.beta = "";
+		prepared_insert.params.gamma = false;
+		db(prepared_insert);
+		
+		auto prepared_select = db.prepare(select(all_of(tab)).from(tab).where(tab.alpha == parameter(tab.alpha)));
+		prepared_select.params.alpha = 2;
+		{
+			size_t count = 0;
+			for(const auto& row : db(prepared_select)) {
+				assert(row.alpha.value() == 2);
+				assert(row.beta.value() == (count == 0 ? "apple pie" : ""));
+				++count;
+			}
+			assert(count == 2);
+		}
+		prepared_select.params.alpha = 1;
+		{
+			auto result = db(prepared_select);
+			assert(!result.empty());
+			result.pop_front();
+			assert(result.empty());
+		}
+		
+		const size_t updated = db(update(tab).set(tab.gamma = true).where(tab.alpha == 2));
+		assert(updated == 2);
+		const size_t removed = db(remove_from(tab).where(tab.alpha.is_null()));
+		assert(removed == 1);
+		
+		//Columnar results are fetched in blocks, two rows at a time here, either on this or on a background thread
+		for(size_t prefetch_blocks : {0, 2}) {
+			odbc::rowset_config rowset;
+			rowset.rows = 2;
+			rowset.prefetch_blocks = prefetch_blocks;
+			auto columns = db.select_columnar(select(all_of(tab)).from(tab).unconditionally(), rowset);
+			assert(columns.size() == 3);
+			assert(columns.alpha[0] == 1);
+			assert(columns.alpha[2] == 2);
+			assert(columns.beta.is_null(0));
+			assert(columns.beta.validity().null_count() == 1);
+			assert(columns.beta[1] == "apple pie");
+			assert(!columns.beta.is_null(2));
+			assert(columns.beta.length(2) == 0);
+			for(size_t i = 0; i < columns.size(); ++i) {
+				assert(columns.gamma[i]);
+			}
+		}
+		
+		//Arrow streams deliver one record batch per block
+		{
+			odbc::rowset_config rowset;
+			rowset.rows = 2;
+			ArrowArrayStream stream;
+			db.select_arrow("SELECT alpha, beta FROM tab_sample", &stream, rowset);
+			ArrowSchema schema;
+			const int described = stream.get_schema(&stream, &schema);
+			assert(described == 0);
+			assert(std::string(schema.format) == "+s");
+			assert(schema.n_children == 2);
+			assert(std::string(schema.children[0]->name) == "alpha");
+			assert(std::string(schema.children[0]->format) == "l");
+			assert(std::string(schema.children[1]->format) == "U");
+			schema.release(&schema);
+			
+			std::vector<int64_t> lengths;
+			int64_t beta_nulls = 0;
+			while(true) {
+				ArrowArray batch;
+				const int fetched = stream.get_next(&stream, &batch);
+				assert(fetched == 0);
+				if(!batch.release) {
+					break;
+				}
+				lengths.push_back(batch.length);
+				beta_nulls += batch.children[1]->null_count;
+				const int64_t* alpha = static_cast<const int64_t*>(batch.children[0]->buffers[1]);
+				assert(alpha[0] == (lengths.size() == 1 ? 1 : 2));
+				batch.release(&batch);
+			}
+			assert((lengths == std::vector<int64_t>{2, 1}));
+			assert(beta_nulls == 1);
+			stream.release(&stream);
+		}
+		
+		//DECIMAL columns are fetched as SQL_C_NUMERIC at their own scale, without going through double or text
+		{
+			db.execute(R"(DROP TABLE IF EXISTS tab_money)");
+			db.execute(R"(CREATE TABLE tab_money (amount DECIMAL(12,2) DEFAULT NULL))");
+			db.execute(R"(INSERT INTO tab_money (amount) VALUES (1234.56))");
+			db.execute(R"(INSERT INTO tab_money (amount) VALUES (-0.07))");
+			ArrowArrayStream stream;
+			db.select_arrow("SELECT amount FROM tab_money", &stream);
+			ArrowSchema schema;
+			const int described = stream.get_schema(&stream, &schema);
+			assert(described == 0);
+			assert(std::string(schema.children[0]->format) == "d:12,2");
+			schema.release(&schema);
+			ArrowArray batch;
+			const int fetched = stream.get_next(&stream, &batch);
+			assert(fetched == 0);
+			assert(batch.length == 2);
+			const int64_t* amount = static_cast<const int64_t*>(batch.children[0]->buffers[1]);
+			assert(amount[0] == 123456 && amount[1] == 0);
+			assert(amount[2] == -7 && amount[3] == -1);
+			batch.release(&batch);
+			stream.release(&stream);
+			
+			const odbc::numeric_t sum = odbc::numeric_t::from_string("1234.56") + odbc::numeric_t(-7, 2);
+			assert(sum.to_string() == "1234.49");
+			assert(odbc::numeric_t::from_double(sum.to_double(), 2) == sum);
+			assert(odbc::numeric_t(sum.to_struct()) == sum);
+			assert(odbc::numeric_t::from_string("0.125", 2).to_string() == "0.13");
+			
+			//Custom data types bind numeric_t through _bind_numeric_parameter and _bind_numeric_result, at the scale of the value and of the column
+			auto insert_amount = sqlpp::verbatim("INSERT INTO tab_money (amount) VALUES (?)");
+			const numeric_statement_t inserting{db.prepare_execute(insert_amount), odbc::numeric_t::from_string("-1234.5")};
+			db.run_prepared_insert(inserting);
+			auto select_amounts = sqlpp::verbatim("SELECT amount FROM tab_money WHERE amount < ?");
+			const numeric_statement_t selecting{db.prepare_execute(select_amounts), odbc::numeric_t(0, 0)};
+			//The second execution reads through the descriptor records set up by the first
+			for(int run = 0; run < 2; ++run) {
+				auto result = db.run_prepared_select(selecting);
+				std::vector<std::string> amounts;
+				numeric_row_t row;
+				for(result.next(row); row; result.next(row)) {
+					assert(!row.is_null);
+					amounts.push_back(row.amount.to_string());
+				}
+				assert((amounts == std::vector<std::string>{"-0.07", "-1234.50"}));
+			}
+		}
+		
+		//Statement options apply to the statements prepared while they are set
+		{
+			odbc::statement_options options = db.get_statement_options();
+			options.max_rows = 1;
+			options.noscan = true;
+			odbc::scoped_statement_options scoped(db, options);
+			size_t count = 0;
+			for(const auto& row : db(select(all_of(tab)).from(tab).unconditionally())) {
+				assert(row.alpha.value() == 1);
+				++count;
+			}
+			assert(count == 1);
+		}
+		const auto unlimited = db.select_columnar(select(all_of(tab)).from(tab).unconditionally());
+		assert(unlimited.size() == 3);
+		
+		//A stored result is fetched completely, so its size is exact and it can be indexed and iterated repeatedly
+		{
+			auto rows = db.store(select(all_of(tab)).from(tab).unconditionally());
+			assert(rows.size() == 3);
+			auto columns = db.select_columnar(select(all_of(tab)).from(tab).unconditionally());
+			assert(rows[2].alpha.value() == columns.alpha[2]);
+			for(int pass = 0; pass < 2; ++pass) {
+				size_t count = 0;
+				for(const auto& row : rows) {
+					assert(row.alpha.value() == columns.alpha[count]);
+					++count;
+				}
+				assert(count == 3);
+			}
+			
+			//Empty text is not NULL, even when no text of the result had any bytes to keep
+			db(insert_into(foo).set(foo.name = ""));
+			auto empty_names = db.store(select(foo.name).from(foo).where(foo.name == ""));
+			assert(empty_names.size() == 1);
+			assert(!empty_names[0].name.is_null());
+			assert(empty_names[0].name.value().empty());
+			db(remove_from(foo).where(foo.name == ""));
+		}
+		
+		//A lazy result reads a column on first access, the fixed width columns before the first text column are bound
+		{
+			auto lazy = db.select_lazy(select(all_of(tab)).from(tab).unconditionally());
+			const size_t alpha = lazy.index("alpha");
+			const size_t gamma = lazy.index("gamma");
+			assert(lazy.is_bound(alpha));
+			assert(!lazy.is_bound(gamma));
+			size_t count = 0;
+			while(lazy.next()) {
+				lazy.integral(alpha);
+				lazy.boolean(gamma);
+				//The fake driver needs unbound columns in increasing order
+				try {
+					lazy.text(lazy.index("beta"));
+					assert(false);
+				} catch(const sqlpp::exception&) {
+				}
+				++count;
+			}
+			assert(count == 3);
+		}
+		
+		//A planned result binds all columns once, blocks of two rows here, and decodes them at offsets fixed at compile time
+		{
+			auto columns = db.select_columnar(select(all_of(tab)).from(tab).unconditionally());
+			size_t count = 0;
+			for(const auto& row : db.select_planned(select(all_of(tab)).from(tab).unconditionally(), 2)) {
+				assert(row.alpha.value() == columns.alpha[count]);
+				assert(row.beta.is_null() == columns.beta.is_null(count));
+				++count;
+			}
+			assert(count == 3);
+		}
+		
+		//Result columns are described once per prepared statement, running it again reuses the description
+		{
+			auto prepared_select = db.prepare(select(all_of(tab)).from(tab).unconditionally());
+			for(int run = 0; run < 2; ++run) {
+				size_t count = 0;
+				for(const auto& row : db(prepared_select)) {
+					assert(row.beta.is_null() || !row.beta.value().empty());
+					++count;
+				}
+				assert(count == 3);
+			}
+			//The planned columns stay bound between runs, running it with db() unbinds them again
+			for(int run = 0; run < 2; ++run) {
+				size_t count = 0;
+				for(const auto& row : db.run_planned(prepared_select)) {
+					assert(row.beta.is_null() || !row.beta.value().empty());
+					++count;
+				}
+				assert(count == 3);
+			}
+			size_t count = 0;
+			for(const auto& row : db(prepared_select)) {
+				assert(!row.alpha.is_null());
+				++count;
+			}
+			assert(count == 3);
+		}
+		
+		//Statement statistics count executions by fingerprint, the literals of a statement don't split it up
+		{
+			assert(odbc::statement_fingerprint("SELECT a FROM t WHERE b IN (1, 2, 3) AND c = 'x''y'") == "SELECT a FROM t WHERE b IN (...) AND c = ?");
+			assert(!db.statement_statistics());
+			auto statistics = db.enable_statement_statistics();
+			for(int alpha = 1; alpha <= 2; ++alpha) {
+				db(update(tab).set(tab.gamma = true).where(tab.alpha == alpha));
+			}
+			db(select(all_of(tab)).from(tab).unconditionally());
+			db.disable_statement_statistics();
+			db(update(tab).set(tab.gamma = true).where(tab.alpha == 3));
+			assert(statistics->size() == 2);
+			bool found = false;
+			for(const auto& stats : statistics->top(2)) {
+				if(stats.fingerprint.find("UPDATE") == 0) {
+					assert(stats.count == 2);
+					assert(stats.max_time <= stats.total_time);
+					found = true;
+				}
+			}
+			assert(found);
+		}
+		
+		//IN lookups are padded to a few arities, so key sets of different sizes share their prepared statements
+		{
+			std::vector<int64_t> keys;
+			auto columns = db.select_columnar(select(tab.alpha).from(tab).unconditionally());
+			for(size_t i = 0; i < columns.alpha.size(); ++i) {
+				if(!columns.alpha.is_null(i)) {
+					keys.push_back(columns.alpha[i]);
+				}
+			}
+			odbc::in_list_config buckets;
+			buckets.buckets = {1, 4};
+			auto lookup = odbc::make_in_list_lookup(db, select(all_of(tab)).from(tab), tab.alpha, buckets);
+			//Every row with a key, keys given twice within a chunk don't repeat rows
+			const auto all = lookup(keys);
+			assert(all.size() == keys.size());
+			const size_t matching = static_cast<size_t>(std::count(keys.begin(), keys.end(), keys.front()));
+			const auto single = lookup({keys.front()});
+			assert(single.size() == matching);
+			//Chunks of 4 and 2 padded to 4, the rows repeat in each chunk
+			const auto repeated = lookup(std::vector<int64_t>(6, keys.front()));
+			assert(repeated.size() == 2 * matching);
+			const auto none = lookup({});
+			assert(none.size() == 0);
+			assert(lookup.prepared() == 2);
+		}
+		
+		//Point lookups from concurrent threads are coalesced into one IN query, each caller gets the rows of its key
+		{
+			std::vector<int64_t> keys;
+			auto columns = db.select_columnar(select(tab.alpha).from(tab).unconditionally());
+			for(size_t i = 0; i < columns.alpha.size(); ++i) {
+				if(!columns.alpha.is_null(i)) {
+					keys.push_back(columns.alpha[i]);
+				}
+			}
+			odbc::coalescing_config coalescing;
+			coalescing.max_keys = keys.size();
+			//The batch runs once every thread joined
+			coalescing.max_delay = std::chrono::seconds(10);
+			auto lookup = odbc::make_coalescing_lookup(db, select(all_of(tab)).from(tab), tab.alpha, coalescing);
+			using lookup_t = decltype(lookup);
+			std::vector<std::future<lookup_t::_result_t>> results(keys.size());
+			std::vector<std::thread> threads;
+			for(size_t i = 0; i < keys.size(); ++i) {
+				threads.emplace_back([&lookup, &results, &keys, i]() {
+					results[i] = lookup(keys[i]);
+				});
+			}
+			for(auto& thread : threads) {
+				thread.join();
+			}
+			for(size_t i = 0; i < keys.size(); ++i) {
+				auto rows = results[i].get();
+				assert(rows.size() == static_cast<size_t>(std::count(keys.begin(), keys.end(), keys[i])));
+				for(const auto& row : rows) {
+					assert(row.alpha.value() == keys[i]);
+				}
+			}
+			assert(lookup.lookups() == keys.size());
+			assert(lookup.batches() == 1);
+		}
+		
+		//Results are exported to CSV block by block, text is quoted where it needs to be
+		{
+			db(insert_into(tab).set(tab.alpha = 4711, tab.gamma = true, tab.beta = "pie, \"apple\""));
+			odbc::csv_options options;
+			options.rowset.rows = 2;
+			const std::string path = "FakeDriverTest.csv";
+			const size_t rows = odbc::export_csv(db, select(tab.alpha, tab.beta, tab.gamma).from(tab).unconditionally(), path, options);
+			const auto exported = db.select_columnar(select(tab.alpha).from(tab).unconditionally());
+			assert(rows == exported.size());
+			std::ifstream in(path);
+			const std::string csv((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+			in.close();
+			assert(csv.find("alpha,beta,gamma\n") == 0);
+			assert(csv.find("\n4711,\"pie, \"\"apple\"\"\",1\n") != std::string::npos);
+			assert(static_cast<size_t>(std::count(csv.begin(), csv.end(), '\n')) == rows + 1);
+			
+			options.header = false;
+			options.delimiter = '\t';
+			const size_t tsv_rows = odbc::export_csv(db, std::string("SELECT alpha FROM tab_sample WHERE alpha = 4711"), path, options);
+			assert(tsv_rows == 1);
+			std::ifstream tsv(path);
+			std::string line;
+			std::getline(tsv, line);
+			assert(line == "4711");
+			tsv.close();
+			std::remove(path.c_str());
+			db(remove_from(tab).where(tab.alpha == 4711));
+		}
+		
+		//CSV files are inserted as parameter arrays, rows that don't parse or that the database rejects are reported
+		{
+			const std::string path = "FakeDriverTest.csv";
+			{
+				std::ofstream out(path);
+				out << "id,label\n100,hundred\n101,\"one, oh one\"\n,no id\nx,bad\n102,last\n";
+			}
+			db.execute("CREATE TABLE tab_import (id BIGINT NOT NULL, label VARCHAR(32))");
+			const std::vector<odbc::column_info> columns = {
+				{"id", odbc::column_kind::integral, false, 0, 0},
+				{"label", odbc::column_kind::text, true, 0, 0}};
+			odbc::csv_import_options options;
+			options.batch_size = 3;
+			options.max_errors = 2;
+			//The NULL id fails the first array at its third row, the x in the next batch doesn't parse
+			const auto imported = odbc::import_csv(db, "tab_import", columns, path, options);
+			assert(imported.rows == 3);
+			assert(imported.errors.size() == 2);
+			assert(imported.errors[0].line == 4);
+			assert(imported.errors[1].line == 5);
+			const size_t quoted = db.execute("SELECT id FROM tab_import WHERE label = 'one, oh one'");
+			assert(quoted == 1);
+			
+			options.max_errors = 1;
+			try {
+				odbc::import_csv(db, "tab_import", columns, path, options);
+				assert(false);
+			} catch(const sqlpp::exception&) {
+			}
+			
+			//With a sqlpp11 table the header can name any of its columns
+			{
+				std::ofstream out(path);
+				out << "name\nimported\n\"quoted \"\"name\"\"\"\n";
+			}
+			options.max_errors = 0;
+			options.pipeline = false;
+			const auto imported_names = odbc::import_csv(db, foo, path, options);
+			assert(imported_names.rows == 2);
+			auto quoted_name = db(select(foo.omega).from(foo).where(foo.name == "quoted \"name\""));
+			assert(!quoted_name.empty());
+			db(remove_from(foo).where(foo.name == "imported" or foo.name == "quoted \"name\""));
+			
+			//Drivers like SQL Server run the sets after a failing one and return SQL_SUCCESS_WITH_INFO, this one also takes only 2 sets at a time
+			{
+				std::ofstream out(path);
+				out << "id,label\n200,two hundred\n,no id\n201,two hundred one\n202,two hundred two\n";
+			}
+			odbc::connection_config array_config = config;
+			array_config.statement.attributes = {{odbc::fake::attr_continue_after_errors, 1}, {odbc::fake::attr_max_paramset_size, 2}};
+			odbc::connection array_db(array_config);
+			//Counting the executions doesn't lose the driver's messages
+			array_db.enable_statement_statistics();
+			options.max_errors = 1;
+			const auto partial = odbc::import_csv(array_db, "tab_import", columns, path, options);
+			assert(partial.rows == 3);
+			assert(partial.errors.size() == 1);
+			assert(partial.errors[0].line == 3);
+			assert(partial.errors[0].message.find("cannot be null") != std::string::npos);
+			const size_t continued = db.execute("SELECT id FROM tab_import WHERE id >= 200");
+			assert(continued == 3);
+			db.execute("DROP TABLE tab_import");
+			std::remove(path.c_str());
+		}
+		
+		//insert_or_replace and insert_or_ignore are spelled in the dialect of the connection
+		{
+			odbc::serializer_t mysql_context(db);
+			serialize(odbc::insert_or_replace_into(tab).set(tab.alpha = 1, tab.beta = "pie").on_conflict(tab.alpha), mysql_context);
+			assert(mysql_context.str().find("ON DUPLICATE KEY UPDATE beta = VALUES(beta)") != std::string::npos);
+			
+			odbc::connection_config tsql_config = config;
+			tsql_config.type = odbc::ODBC_Type::TSQL;
+			odbc::connection tsql_db(tsql_config);
+			odbc::serializer_t tsql_context(tsql_db);
+			serialize(odbc::insert_or_ignore_into(tab).set(tab.alpha = 1, tab.beta = "pie").on_conflict(tab.alpha), tsql_context);
+			assert(tsql_context.str().find("MERGE INTO tab_sample WITH (HOLDLOCK) AS t") == 0);
+			assert(tsql_context.str().find("WHEN MATCHED") == std::string::npos);
+			
+			odbc::connection_config postgresql_config = config;
+			postgresql_config.type = odbc::ODBC_Type::PostgreSQL;
+			odbc::connection postgresql_db(postgresql_config);
+			odbc::serializer_t postgresql_context(postgresql_db);
+			try {
+				//PostgreSQL needs the key to update on
+				serialize(odbc::insert_or_replace_into(tab).set(tab.alpha = 1, tab.beta = "pie"), postgresql_context);
+				assert(false);
+			} catch(const sqlpp::exception&) {
+			}
+		}
+		
+		//Keys loaded into a temporary table as parameter arrays join like any other table, the table is dropped with them
+		{
+			std::vector<int64_t> keys;
+			size_t rows = 0;
+			auto columns = db.select_columnar(select(tab.alpha).from(tab).unconditionally());
+			for(size_t i = 0; i < columns.alpha.size(); ++i) {
+				if(!columns.alpha.is_null(i)) {
+					keys.push_back(columns.alpha[i]);
+					++rows;
+				}
+			}
+			std::sort(keys.begin(), keys.end());
+			keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+			keys.push_back(keys.back() + 1000);
+			odbc::temporary_keys_config loading;
+			loading.batch_size = 2;
+			loading.primary_key = true;
+			{
+				odbc::temporary_keys<odbc::integral_keys> temporary(db, keys, loading);
+				assert(temporary.size() == keys.size());
+				const auto& k = temporary.table();
+				size_t joined = 0;
+				for(const auto& row : db(select(tab.alpha).from(tab.join(k).on(tab.alpha == k.id)).unconditionally())) {
+					assert(std::binary_search(keys.begin(), keys.end(), row.alpha.value()));
+					++joined;
+				}
+				assert(joined == rows);
+			}
+			try {
+				db.execute("SELECT id FROM sqlpp_keys");
+				assert(false);
+			} catch(const sqlpp::exception&) {
+			}
+			//Drivers may take fewer keys per execution than batch_size
+			{
+				odbc::statement_options options = db.get_statement_options();
+				options.attributes.push_back({odbc::fake::attr_max_paramset_size, 2});
+				odbc::scoped_statement_options scoped(db, options);
+				loading.batch_size = 5;
+				odbc::temporary_keys<odbc::integral_keys> temporary(db, keys, loading);
+				assert(temporary.size() == keys.size());
+				const size_t loaded = db.execute("SELECT id FROM sqlpp_keys");
+				assert(loaded == keys.size());
+			}
+		}
+		
+		//Text can be exchanged as UTF-16 (SQL_C_WCHAR) and converted to UTF-8 by the connector
+		{
+			const std::string text = u8"Gr\u00FC\u00DFe, \u4E16\u754C \U0001F600";
+			assert(odbc::utf16_to_utf8(odbc::utf8_to_utf16(text)) == text);
+			odbc::statement_options options = db.get_statement_options();
+			options.wide_text = true;
+			odbc::scoped_statement_options scoped(db, options);
+			auto prepared_update = db.prepare(update(tab).set(tab.beta = parameter(tab.beta)).where(tab.alpha == 1));
+			prepared_update.params.beta = text;
+			const size_t updated_wide = db(prepared_update);
+			assert(updated_wide == 1);
+			for(const auto& row : db(select(tab.beta).from(tab).where(tab.alpha == 1))) {
+				assert(row.beta.value() == text);
+			}
+			auto columns = db.select_columnar(select(tab.beta).from(tab).where(tab.alpha == 1));
+			assert(columns.beta[0] == text);
+		}
+		
+		auto date_time = std::chrono::system_clock::time_point() 
+			+ std::chrono::microseconds(3723123456);
+		auto dp = date::floor<date::days>(date_time);
+		
+		db.start_transaction();
+		db(insert_into(bar).set(
+			bar.delta = dp,
+			bar.epsilon = date_time,
+			bar.zeta = date_time,
+			bar.eta = date_time));
+		{
+			auto select_bar = db(select(all_of(bar)).from(bar).unconditionally());
+			assert(!select_bar.empty());
+			const auto& row = select_bar.front();
+			assert(row.delta.value() == dp);
+			assert(row.epsilon.value() == date_time);
+			assert(row.zeta.value() == date_time);
+			assert(!row.eta.is_null());
+		}
+		db.rollback_transaction(false);
+		auto rolled_back = db(select(all_of(bar)).from(bar).unconditionally());
+		assert(rolled_back.empty());
+		
+		//Nested transactions are savepoints, autocommit stays off between back to back transactions
+		const auto foo_names = [&db, &foo]() -> std::vector<std::string> {
+			std::vector<std::string> names;
+			for(const auto& row : db(select(foo.name).from(foo).unconditionally())) {
+				names.push_back(row.name.value());
+			}
+			return names;
+		};
+		db.start_transaction();
+		db(insert_into(foo).set(foo.name = "third"));
+		db.start_transaction();
+		assert(db.transaction_depth() == 2);
+		db(insert_into(foo).set(foo.name = "fourth"));
+		db.rollback_transaction(false);
+		db.start_transaction();
+		db(insert_into(foo).set(foo.name = "fifth"));
+		db.commit_transaction();
+		db.commit_transaction();
+		assert(db.transaction_depth() == 0);
+		db.start_transaction();
+		db(remove_from(foo).where(foo.name == "third"));
+		db.commit_transaction();
+		assert((foo_names() == std::vector<std::string>{"first", "second", "fifth"}));
+		
+		//With manual commit nothing is committed outside of commit_transaction
+		{
+			odbc::connection_config manual = config;
+			manual.manual_commit = true;
+			odbc::connection manual_db(manual);
+			manual_db(remove_from(foo).where(foo.name == "fifth"));
+			manual_db.start_transaction();
+			manual_db.rollback_transaction(false);
+		}
+		assert(foo_names().size() == 3);
+		
+		//Batched writes are committed every max_statements statements, a failing statement rolls back its batch
+		{
+			std::vector<odbc::batch_result> batches;
+			odbc::batched_writer_config batching;
+			batching.max_statements = 2;
+			batching.max_delay = std::chrono::hours(1);
+			batching.on_batch = [&batches](const odbc::batch_result& batch) { batches.push_back(batch); };
+			odbc::batched_writer writer(db, batching);
+			writer(insert_into(foo).set(foo.name = "sixth"));
+			writer(insert_into(foo).set(foo.name = "seventh"));
+			writer(insert_into(foo).set(foo.name = "lost"));
+			assert(batches.size() == 1 && batches[0].committed && batches[0].statements == 2);
+			bool failed = false;
+			try {
+				writer.execute("INSERT INTO no_such_table (name) VALUES ('x')");
+			} catch(const sqlpp::exception&) {
+				failed = true;
+			}
+			assert(failed);
+			assert(batches.size() == 2 && !batches[1].committed && batches[1].statements == 1 && !batches[1].error.empty());
+			writer(insert_into(foo).set(foo.name = "eighth"));
+			writer.flush();
+			assert(batches.size() == 3 && batches[2].committed);
+		}
+		assert((foo_names() == std::vector<std::string>{"first", "second", "fifth", "sixth", "seventh", "eighth"}));
+		
+		//KILL CONNECTION drops the fake driver's link, auto_reconnect prepares the statement again and retries it
+		{
+			odbc::connection_config reconnecting = config;
+			reconnecting.auto_reconnect = true;
+			odbc::connection live_db(reconnecting);
+			auto by_name = live_db.prepare(select(foo.omega).from(foo).where(foo.name == parameter(foo.name)));
+			by_name.params.name = "second";
+			assert(live_db.is_alive());
+			live_db.execute("KILL CONNECTION");
+			assert(!live_db.is_alive());
+			auto reconnected = live_db(by_name);
+			assert(!reconnected.empty() && reconnected.front().omega == 2);
+			assert(live_db.is_alive());
+			
+			odbc::connection lost_db(config);
+			lost_db.execute("KILL CONNECTION");
+			bool lost = false;
+			try {
+				lost_db(select(foo.name).from(foo).unconditionally());
+			} catch(const odbc::connection_lost&) {
+				lost = true;
+			}
+			assert(lost);
+			lost_db.reconnect();
+			assert(lost_db.is_alive());
+		}
+		
+		//Statements stop at their deadline, or when they are cancelled from another thread
+		{
+			bool expired = false;
+			{
+				odbc::scoped_query_timeout deadline(db, std::chrono::seconds(1));
+				try {
+					db.execute("DO SLEEP(30)");
+				} catch(const odbc::timeout_expired&) {
+					expired = true;
+				}
+			}
+			assert(expired);
+			assert(db.get_statement_options().query_timeout == 0);
+			
+			std::atomic<bool> finished(false);
+			bool cancelled = false;
+			std::thread worker([&db, &finished, &cancelled]() {
+				try {
+					db.execute("DO SLEEP(30)");
+				} catch(const odbc::query_cancelled&) {
+					cancelled = true;
+				}
+				finished = true;
+			});
+			//Nothing may be running yet, so keep asking
+			while(!finished) {
+				db.cancel();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			worker.join();
+			assert(cancelled);
+			assert(!db.cancel());
+		}
+		
+		//Every thread gets its own connection, which is closed when the thread exits
+		{
+			odbc::thread_local_connection_config limits;
+			limits.max_connections = 2;
+			odbc::thread_local_connection shared(config, limits);
+			odbc::connection* mine = &shared.get();
+			std::atomic<size_t> rows(0);
+			std::atomic<size_t> others(0);
+			std::vector<std::thread> threads;
+			for(int i = 0; i < 4; ++i) {
+				threads.emplace_back([&shared, &foo, &rows, &others, mine]() {
+					if(&shared.get() != mine) {
+						++others;
+					}
+					for(const auto& row : shared(select(foo.name).from(foo).unconditionally())) {
+						rows += !row.name.is_null();
+					}
+				});
+			}
+			for(auto& thread : threads) {
+				thread.join();
+			}
+			assert(others == 4);
+			assert(rows == 4 * foo_names().size());
+			assert(shared.size() == 1);
+		}
+		
+		//Driver errors are reported as exceptions
+		bool thrown = false;
+		try {
+			db.execute("SELECT * FROM no_such_table");
+		} catch(const sqlpp::exception&) {
+			thrown = true;
+		}
+		assert(thrown);
+	} catch(const std::exception& e) {
+		std::cerr << "Encountered error: " << e.what() << '\n';
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,117 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sqlpp11/odbc/odbc.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace odbc = sqlpp::odbc;
+
+namespace {
+	double seconds_since(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	
+	void benchmark_transcoder(const std::string& name, const std::string& text, size_t repetitions) {
+		const std::u16string wide = odbc::utf8_to_utf16(text);
+		std::string narrow(3 * wide.size(), '\0');
+		std::u16string widened(text.size(), u'\0');
+		//Throughput is counted in UTF-8 bytes both ways
+		size_t written = 0;
+		auto start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < repetitions; ++i) {
+			written += odbc::utf16_to_utf8(wide.data(), wide.size(), &narrow[0], narrow.size());
+		}
+		const double to_utf8 = written / 1e6 / seconds_since(start);
+		written = 0;
+		start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < repetitions; ++i) {
+			written += odbc::utf8_to_utf16(text.data(), text.size(), &widened[0], widened.size()) ? text.size() : 0;
+		}
+		const double to_utf16 = written / 1e6 / seconds_since(start);
+		std::cout << name << ": UTF-16 to UTF-8 " << to_utf8 << " MB/s, UTF-8 to UTF-16 " << to_utf16 << " MB/s" << std::endl;
+	}
+	
+	//Reads the whole column through select_arrow, so only fetching and conversion are timed
+	double fetch(odbc::connection& db, const odbc::rowset_config& rowset) {
+		const auto start = std::chrono::steady_clock::now();
+		ArrowArrayStream stream;
+		db.select_arrow("SELECT txt FROM transcode_benchmark", &stream, rowset);
+		for(;;) {
+			ArrowArray batch;
+			if(stream.get_next(&stream, &batch) != 0) {
+				std::cerr << "Encountered error: " << stream.get_last_error(&stream) << '\n';
+				break;
+			}
+			if(!batch.release) {
+				break;
+			}
+			batch.release(&batch);
+		}
+		stream.release(&stream);
+		return seconds_since(start);
+	}
+}
+
+//Compares text fetched as SQL_C_CHAR (converted by the driver) with SQL_C_WCHAR converted by the connector.
+//Without a connection string only the transcoder itself is measured.
+int main(int argc, const char **argv)
+{
+	const std::string ascii(200, 'a');
+	std::string mixed;
+	while(mixed.size() < 200) {
+		mixed += u8"Straße 12, München – 東京 ";
+	}
+	benchmark_transcoder("ASCII", ascii, 200000);
+	benchmark_transcoder("Mixed", mixed, 200000);
+	if(argc < 2) {
+		std::cout << "Usage: TranscodeBenchmark <connection string> [rows] to compare with the driver's conversion" << std::endl;
+		return 0;
+	}
+	try {
+		odbc::driver_connection_config config;
+		config.connection = argv[1];
+		odbc::connection db(config);
+		const size_t rows = argc > 2 ? std::stoul(argv[2]) : 10000;
+		db.execute("DROP TABLE IF EXISTS transcode_benchmark");
+		db.execute("CREATE TABLE transcode_benchmark (txt VARCHAR(256))");
+		for(size_t i = 0; i < rows; ++i) {
+			db.execute("INSERT INTO transcode_benchmark (txt) VALUES ('" + (i % 2 ? ascii : mixed) + "')");
+		}
+		odbc::rowset_config narrow;
+		odbc::rowset_config wide;
+		wide.wide_columns = {0};
+		std::cout << "SQL_C_CHAR: " << fetch(db, narrow) << " s, SQL_C_WCHAR and transcoding: " << fetch(db, wide) << " s" << std::endl;
+		db.execute("DROP TABLE transcode_benchmark");
+	} catch(const std::exception& e) {
+		std::cerr << "Encountered error: " << e.what() << '\n';
+		return 2;
+	}
+	return 0;
+}
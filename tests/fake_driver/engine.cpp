@@ -0,0 +1,1875 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fake_driver.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace fake {
+			namespace {
+				std::string to_upper(std::string s) {
+					for(auto& c : s) {
+						c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+					}
+					return s;
+				}
+				
+				std::string to_lower(std::string s) {
+					for(auto& c : s) {
+						c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+					}
+					return s;
+				}
+				
+				//Howard Hinnant's civil_from_days, see http://howardhinnant.github.io/date_algorithms.html
+				void civil_from_days(int64_t z, int& y, unsigned& m, unsigned& d) {
+					z += 719468;
+					const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+					const unsigned doe = static_cast<unsigned>(z - era * 146097);
+					const unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+					const unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+					const unsigned mp = (5*doy + 2)/153;
+					d = doy - (153*mp+2)/5 + 1;
+					m = mp < 10 ? mp+3 : mp-9;
+					y = static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (m <= 2));
+				}
+				
+				bool parse_date(const std::string& s, value_t& v) {
+					int y;
+					unsigned m, d;
+					if(std::sscanf(s.c_str(), "%d-%u-%u", &y, &m, &d) != 3) {
+						return false;
+					}
+					v = make_date(y, m, d);
+					return true;
+				}
+				
+				bool parse_time_part(const char* s, unsigned& h, unsigned& m, unsigned& sec, uint32_t& fraction) {
+					int consumed = 0;
+					if(std::sscanf(s, "%u:%u:%u%n", &h, &m, &sec, &consumed) != 3) {
+						return false;
+					}
+					fraction = 0;
+					s += consumed;
+					if(*s == '.') {
+						++s;
+						uint32_t scale = 100000000;
+						for(; std::isdigit(static_cast<unsigned char>(*s)) && scale; ++s, scale /= 10) {
+							fraction += static_cast<uint32_t>(*s - '0') * scale;
+						}
+					}
+					return true;
+				}
+				
+				bool parse_timestamp(const std::string& s, value_t& v) {
+					int y;
+					unsigned mo, d, h = 0, mi = 0, sec = 0;
+					uint32_t fraction = 0;
+					int consumed = 0;
+					if(std::sscanf(s.c_str(), "%d-%u-%u%n", &y, &mo, &d, &consumed) != 3) {
+						return false;
+					}
+					const char* rest = s.c_str() + consumed;
+					if(*rest == ' ' || *rest == 'T') {
+						if(!parse_time_part(rest + 1, h, mi, sec, fraction)) {
+							return false;
+						}
+					}
+					v = make_timestamp(y, mo, d, h, mi, sec, fraction);
+					return true;
+				}
+				
+				bool parse_time(const std::string& s, value_t& v) {
+					unsigned h, m, sec;
+					uint32_t fraction;
+					if(!parse_time_part(s.c_str(), h, m, sec, fraction)) {
+						return false;
+					}
+					v = make_time(h, m, sec);
+					v.fraction = fraction;
+					return true;
+				}
+				
+				bool is_numeric(const value_t& v) {
+					return v.type == value_type::integer || v.type == value_type::real;
+				}
+				
+				bool is_temporal(const value_t& v) {
+					return v.type == value_type::date || v.type == value_type::timestamp || v.type == value_type::time;
+				}
+				
+				double as_real(const value_t& v) {
+					return v.type == value_type::integer ? static_cast<double>(v.integer) : v.real;
+				}
+				
+				template<typename T>
+				int three_way(const T& a, const T& b) {
+					return a < b ? -1 : (b < a ? 1 : 0);
+				}
+				
+				int compare_temporal(const value_t& a, const value_t& b) {
+					int r = three_way(a.year, b.year);
+					if(!r) r = three_way(a.month, b.month);
+					if(!r) r = three_way(a.day, b.day);
+					if(!r) r = three_way(a.hour, b.hour);
+					if(!r) r = three_way(a.minute, b.minute);
+					if(!r) r = three_way(a.second, b.second);
+					if(!r) r = three_way(a.fraction, b.fraction);
+					return r;
+				}
+				
+				//! Returns false if either side is NULL
+				bool compare(const value_t& a, const value_t& b, int& result) {
+					if(a.is_null() || b.is_null()) {
+						return false;
+					}
+					if(a.type == value_type::integer && b.type == value_type::integer) {
+						result = three_way(a.integer, b.integer);
+					} else if(is_numeric(a) && is_numeric(b)) {
+						result = three_way(as_real(a), as_real(b));
+					} else if(a.type == value_type::text && b.type == value_type::text) {
+						result = three_way(a.text, b.text);
+					} else if(is_temporal(a) && b.type == value_type::text) {
+						result = compare_temporal(a, coerce(b, a.type == value_type::date ? column_type::date :
+							a.type == value_type::time ? column_type::time : column_type::timestamp));
+					} else if(a.type == value_type::text && is_temporal(b)) {
+						return compare(b, a, result) && ((result = -result), true);
+					} else if(is_temporal(a) && is_temporal(b)) {
+						result = compare_temporal(a, b);
+					} else if(is_numeric(a) && b.type == value_type::text) {
+						result = three_way(as_real(a), as_real(coerce(b, column_type::real)));
+					} else if(a.type == value_type::text && is_numeric(b)) {
+						result = three_way(as_real(coerce(a, column_type::real)), as_real(b));
+					} else {
+						throw error_t("22018", "Invalid comparison between incompatible values");
+					}
+					return true;
+				}
+				
+				bool like(const char* s, const char* p) {
+					for(; *p; ++p, ++s) {
+						if(*p == '%') {
+							for(const char* t = s; ; ++t) {
+								if(like(t, p + 1)) {
+									return true;
+								}
+								if(!*t) {
+									return false;
+								}
+							}
+						}
+						if(!*s || (*p != '_' && *p != *s)) {
+							return false;
+						}
+					}
+					return !*s;
+				}
+				
+				struct token_t {
+					enum class kind_t {
+						end,
+						identifier,
+						quoted_identifier,
+						number,
+						string,
+						symbol,
+						parameter
+					};
+					kind_t kind;
+					std::string text;
+					std::string upper;
+				};
+				
+				std::vector<token_t> tokenize(const std::string& sql) {
+					std::vector<token_t> tokens;
+					size_t i = 0;
+					const size_t n = sql.size();
+					while(i < n) {
+						const char c = sql[i];
+						if(std::isspace(static_cast<unsigned char>(c))) {
+							++i;
+						} else if(c == '-' && i+1 < n && sql[i+1] == '-') {
+							while(i < n && sql[i] != '\n') {
+								++i;
+							}
+						} else if(std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '#' || c == '@') {
+							const size_t start = i;
+							while(i < n && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '_' || sql[i] == '#' || sql[i] == '@' || sql[i] == '$')) {
+								++i;
+							}
+							const std::string text = sql.substr(start, i - start);
+							tokens.push_back({token_t::kind_t::identifier, text, to_upper(text)});
+						} else if(std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && i+1 < n && std::isdigit(static_cast<unsigned char>(sql[i+1])))) {
+							const size_t start = i;
+							while(i < n && (std::isdigit(static_cast<unsigned char>(sql[i])) || sql[i] == '.')) {
+								++i;
+							}
+							if(i < n && (sql[i] == 'e' || sql[i] == 'E')) {
+								++i;
+								if(i < n && (sql[i] == '+' || sql[i] == '-')) {
+									++i;
+								}
+								while(i < n && std::isdigit(static_cast<unsigned char>(sql[i]))) {
+									++i;
+								}
+							}
+							tokens.push_back({token_t::kind_t::number, sql.substr(start, i - start), std::string()});
+						} else if(c == '\'' ) {
+							std::string text;
+							for(++i; ; ++i) {
+								if(i >= n) {
+									throw error_t("42000", "Syntax error: unterminated string literal");
+								}
+								if(sql[i] == '\'') {
+									if(i+1 < n && sql[i+1] == '\'') {
+										++i;
+									} else {
+										++i;
+										break;
+									}
+								}
+								text.push_back(sql[i]);
+							}
+							tokens.push_back({token_t::kind_t::string, text, std::string()});
+						} else if(c == '"' || c == '`' || c == '[') {
+							const char close = c == '[' ? ']' : c;
+							const size_t end = sql.find(close, i + 1);
+							if(end == std::string::npos) {
+								throw error_t("42000", "Syntax error: unterminated quoted identifier");
+							}
+							const std::string text = sql.substr(i + 1, end - i - 1);
+							tokens.push_back({token_t::kind_t::quoted_identifier, text, to_upper(text)});
+							i = end + 1;
+						} else if(c == '?') {
+							tokens.push_back({token_t::kind_t::parameter, "?", "?"});
+							++i;
+						} else {
+							static const char* const two_char[] = {"<=", ">=", "<>", "!=", "||"};
+							std::string text(1, c);
+							for(auto op : two_char) {
+								if(sql.compare(i, 2, op) == 0) {
+									text = op;
+									break;
+								}
+							}
+							if(std::string("(),.;*=<>+-/{}!|%").find(c) == std::string::npos) {
+								throw error_t("42000", std::string("Syntax error: unexpected character '")+c+'\'');
+							}
+							i += text.size();
+							tokens.push_back({token_t::kind_t::symbol, text, text});
+						}
+					}
+					tokens.push_back({token_t::kind_t::end, std::string(), std::string()});
+					return tokens;
+				}
+				
+				struct expr_t;
+				using expr_ptr = std::shared_ptr<expr_t>;
+				
+				struct expr_t {
+					enum class kind_t {
+						literal,
+						parameter,
+						column,
+						function,
+						star,
+						unary,
+						binary,
+						is_null,
+						in_list,
+						like
+					};
+					kind_t kind;
+					value_t value;
+					//parameter index or resolved column index
+					size_t index = 0;
+					std::string qualifier;
+					//column name, upper case function name or operator
+					std::string name;
+					std::vector<expr_ptr> args;
+					bool negated = false;
+					
+					explicit expr_t(kind_t k) : kind(k) {}
+				};
+				
+				expr_ptr make_expr(expr_t::kind_t kind) {
+					return std::make_shared<expr_t>(kind);
+				}
+				
+				struct select_item_t {
+					expr_ptr expr;
+					std::string alias;
+				};
+				
+				struct order_item_t {
+					expr_ptr expr;
+					bool descending;
+				};
+				
+				//! [INNER] JOIN table [alias] ON condition
+				struct join_t {
+					std::string table;
+					std::string alias;
+					expr_ptr on;
+				};
+			}
+			
+			struct statement_t {
+				enum class kind_t {
+					noop,
+					select,
+					insert,
+					update,
+					remove,
+					create,
+					drop,
+					savepoint,
+					release_savepoint,
+					rollback_to_savepoint,
+					kill,
+					sleep
+				};
+				kind_t kind = kind_t::noop;
+				std::string table;
+				std::string table_alias;
+				//select
+				std::vector<select_item_t> items;
+				std::vector<join_t> joins;
+				expr_ptr where;
+				std::vector<order_item_t> order_by;
+				int64_t limit = -1;
+				int64_t offset = 0;
+				//insert and update
+				std::vector<std::string> columns;
+				std::vector<std::vector<expr_ptr>> values;
+				std::vector<expr_ptr> assignments;
+				//create and drop
+				std::vector<column_t> definitions;
+				bool if_exists = false;
+				//savepoints
+				std::string savepoint;
+				//sleep
+				double seconds = 0;
+				size_t parameters = 0;
+			};
+			
+			namespace {
+				const char* const reserved_words[] = {
+					"FROM", "WHERE", "ORDER", "GROUP", "LIMIT", "OFFSET", "AS", "ON", "INNER", "LEFT", "RIGHT",
+					"OUTER", "CROSS", "JOIN", "AND", "OR", "NOT", "UNION", "HAVING", "SET", "VALUES", "ASC", "DESC"
+				};
+				
+				bool is_reserved(const std::string& upper) {
+					for(auto word : reserved_words) {
+						if(upper == word) {
+							return true;
+						}
+					}
+					return false;
+				}
+				
+				class parser_t {
+					std::vector<token_t> _tokens;
+					size_t _pos;
+					size_t _parameters;
+					
+					const token_t& peek(size_t ahead = 0) const {
+						return _tokens[std::min(_pos + ahead, _tokens.size() - 1)];
+					}
+					
+					const token_t& next() {
+						const token_t& t = peek();
+						if(_pos < _tokens.size() - 1) {
+							++_pos;
+						}
+						return t;
+					}
+					
+					[[noreturn]] void fail(const std::string& expected) const {
+						const token_t& t = peek();
+						throw error_t("42000", "Syntax error: expected "+expected+" near '"+(t.kind == token_t::kind_t::end ? std::string("end of statement") : t.text)+'\'');
+					}
+					
+					bool at_keyword(const char* keyword, size_t ahead = 0) const {
+						const token_t& t = peek(ahead);
+						return t.kind == token_t::kind_t::identifier && t.upper == keyword;
+					}
+					
+					bool accept_keyword(const char* keyword) {
+						if(at_keyword(keyword)) {
+							next();
+							return true;
+						}
+						return false;
+					}
+					
+					void expect_keyword(const char* keyword) {
+						if(!accept_keyword(keyword)) {
+							fail(keyword);
+						}
+					}
+					
+					bool at_symbol(const char* symbol, size_t ahead = 0) const {
+						const token_t& t = peek(ahead);
+						return t.kind == token_t::kind_t::symbol && t.text == symbol;
+					}
+					
+					bool accept_symbol(const char* symbol) {
+						if(at_symbol(symbol)) {
+							next();
+							return true;
+						}
+						return false;
+					}
+					
+					void expect_symbol(const char* symbol) {
+						if(!accept_symbol(symbol)) {
+							fail(std::string("'")+symbol+'\'');
+						}
+					}
+					
+					bool at_identifier() const {
+						const token_t& t = peek();
+						return t.kind == token_t::kind_t::quoted_identifier ||
+							(t.kind == token_t::kind_t::identifier && !is_reserved(t.upper));
+					}
+					
+					std::string identifier() {
+						if(!at_identifier()) {
+							fail("identifier");
+						}
+						return next().text;
+					}
+					
+					//! Parses [schema.]name and returns name
+					std::string table_name() {
+						std::string name = identifier();
+						while(accept_symbol(".")) {
+							name = identifier();
+						}
+						return name;
+					}
+					
+					std::string optional_alias() {
+						if(accept_keyword("AS") || at_identifier()) {
+							return identifier();
+						}
+						return std::string();
+					}
+					
+					int64_t integer_literal() {
+						if(peek().kind != token_t::kind_t::number) {
+							fail("number");
+						}
+						return std::stoll(next().text);
+					}
+					
+					expr_ptr primary() {
+						const token_t& t = peek();
+						switch(t.kind) {
+							case token_t::kind_t::number: {
+								auto e = make_expr(expr_t::kind_t::literal);
+								const std::string text = next().text;
+								if(text.find_first_of(".eE") == std::string::npos) {
+									e->value = make_integer(std::stoll(text));
+								} else {
+									e->value = make_real(std::stod(text));
+								}
+								return e;
+							}
+							case token_t::kind_t::string: {
+								auto e = make_expr(expr_t::kind_t::literal);
+								e->value = make_text(next().text);
+								return e;
+							}
+							case token_t::kind_t::parameter: {
+								next();
+								auto e = make_expr(expr_t::kind_t::parameter);
+								e->index = _parameters++;
+								return e;
+							}
+							case token_t::kind_t::symbol:
+								if(accept_symbol("(")) {
+									auto e = expression();
+									expect_symbol(")");
+									return e;
+								}
+								if(accept_symbol("{")) {
+									//ODBC escape sequence, e.g. {fn CONCAT(a,b)}
+									expect_keyword("FN");
+									auto e = expression();
+									expect_symbol("}");
+									return e;
+								}
+								fail("expression");
+							case token_t::kind_t::identifier:
+								if(accept_keyword("NULL")) {
+									return make_expr(expr_t::kind_t::literal);
+								}
+								if(at_keyword("TRUE") || at_keyword("FALSE")) {
+									auto e = make_expr(expr_t::kind_t::literal);
+									e->value = make_integer(next().upper == "TRUE" ? 1 : 0);
+									return e;
+								}
+								if((at_keyword("DATE") || at_keyword("TIMESTAMP") || at_keyword("TIME")) && peek(1).kind == token_t::kind_t::string) {
+									const std::string type = next().upper;
+									const std::string text = next().text;
+									auto e = make_expr(expr_t::kind_t::literal);
+									const bool ok = type == "DATE" ? parse_date(text, e->value) :
+										type == "TIME" ? parse_time(text, e->value) : parse_timestamp(text, e->value);
+									if(!ok) {
+										throw error_t("22007", "Invalid datetime format: "+text);
+									}
+									return e;
+								}
+								if(at_symbol("(", 1) || t.upper == "SCOPE_IDENTITY" || t.upper == "@@IDENTITY") {
+									auto e = make_expr(expr_t::kind_t::function);
+									e->name = next().upper;
+									if(accept_symbol("(")) {
+										if(accept_symbol("*")) {
+											e->args.push_back(make_expr(expr_t::kind_t::star));
+										} else if(!at_symbol(")")) {
+											do {
+												e->args.push_back(expression());
+											} while(accept_symbol(","));
+										}
+										expect_symbol(")");
+									}
+									return e;
+								}
+								//fall through
+							case token_t::kind_t::quoted_identifier: {
+								auto e = make_expr(expr_t::kind_t::column);
+								e->name = identifier();
+								if(accept_symbol(".")) {
+									e->qualifier = e->name;
+									if(accept_symbol("*")) {
+										e->kind = expr_t::kind_t::star;
+										return e;
+									}
+									e->name = identifier();
+								}
+								return e;
+							}
+							default:
+								fail("expression");
+						}
+					}
+					
+					expr_ptr unary() {
+						if(accept_symbol("-")) {
+							auto e = make_expr(expr_t::kind_t::unary);
+							e->name = "-";
+							e->args.push_back(unary());
+							return e;
+						}
+						return primary();
+					}
+					
+					expr_ptr binary(expr_ptr lhs, const std::string& op, expr_ptr rhs) {
+						auto e = make_expr(expr_t::kind_t::binary);
+						e->name = op;
+						e->args.push_back(std::move(lhs));
+						e->args.push_back(std::move(rhs));
+						return e;
+					}
+					
+					expr_ptr multiplicative() {
+						auto e = unary();
+						while(at_symbol("*") || at_symbol("/") || at_symbol("%")) {
+							const std::string op = next().text;
+							e = binary(e, op, unary());
+						}
+						return e;
+					}
+					
+					expr_ptr additive() {
+						auto e = multiplicative();
+						while(at_symbol("+") || at_symbol("-") || at_symbol("||")) {
+							const std::string op = next().text;
+							e = binary(e, op, multiplicative());
+						}
+						return e;
+					}
+					
+					expr_ptr comparison() {
+						auto e = additive();
+						static const char* const operators[] = {"=", "<>", "!=", "<", "<=", ">", ">="};
+						for(auto op : operators) {
+							if(accept_symbol(op)) {
+								return binary(e, op, additive());
+							}
+						}
+						if(accept_keyword("IS")) {
+							auto is_null = make_expr(expr_t::kind_t::is_null);
+							is_null->negated = accept_keyword("NOT");
+							expect_keyword("NULL");
+							is_null->args.push_back(e);
+							return is_null;
+						}
+						const bool negated = at_keyword("NOT") && (at_keyword("IN", 1) || at_keyword("LIKE", 1));
+						if(negated) {
+							next();
+						}
+						if(accept_keyword("IN")) {
+							auto in = make_expr(expr_t::kind_t::in_list);
+							in->negated = negated;
+							in->args.push_back(e);
+							expect_symbol("(");
+							if(!at_symbol(")")) {
+								do {
+									in->args.push_back(expression());
+								} while(accept_symbol(","));
+							}
+							expect_symbol(")");
+							return in;
+						}
+						if(accept_keyword("LIKE")) {
+							auto l = make_expr(expr_t::kind_t::like);
+							l->negated = negated;
+							l->args.push_back(e);
+							l->args.push_back(additive());
+							return l;
+						}
+						return e;
+					}
+					
+					expr_ptr negation() {
+						if(accept_keyword("NOT")) {
+							auto e = make_expr(expr_t::kind_t::unary);
+							e->name = "NOT";
+							e->args.push_back(negation());
+							return e;
+						}
+						return comparison();
+					}
+					
+					expr_ptr conjunction() {
+						auto e = negation();
+						while(accept_keyword("AND")) {
+							e = binary(e, "AND", negation());
+						}
+						return e;
+					}
+					
+					expr_ptr expression() {
+						auto e = conjunction();
+						while(accept_keyword("OR")) {
+							e = binary(e, "OR", conjunction());
+						}
+						return e;
+					}
+					
+					void select(statement_t& s) {
+						s.kind = statement_t::kind_t::select;
+						accept_keyword("ALL");
+						do {
+							select_item_t item;
+							if(accept_symbol("*")) {
+								item.expr = make_expr(expr_t::kind_t::star);
+							} else {
+								item.expr = expression();
+								item.alias = optional_alias();
+							}
+							s.items.push_back(item);
+						} while(accept_symbol(","));
+						if(accept_keyword("FROM")) {
+							s.table = table_name();
+							s.table_alias = optional_alias();
+							while(at_keyword("INNER") || at_keyword("JOIN")) {
+								accept_keyword("INNER");
+								expect_keyword("JOIN");
+								join_t join;
+								join.table = table_name();
+								join.alias = optional_alias();
+								expect_keyword("ON");
+								join.on = expression();
+								s.joins.push_back(join);
+							}
+						}
+						if(accept_keyword("WHERE")) {
+							s.where = expression();
+						}
+						if(accept_keyword("ORDER")) {
+							expect_keyword("BY");
+							do {
+								order_item_t item;
+								item.expr = expression();
+								item.descending = accept_keyword("DESC");
+								if(!item.descending) {
+									accept_keyword("ASC");
+								}
+								s.order_by.push_back(item);
+							} while(accept_symbol(","));
+						}
+						if(accept_keyword("LIMIT")) {
+							s.limit = integer_literal();
+						}
+						if(accept_keyword("OFFSET")) {
+							s.offset = integer_literal();
+						}
+					}
+					
+					std::vector<expr_ptr> tuple() {
+						std::vector<expr_ptr> values;
+						expect_symbol("(");
+						if(!at_symbol(")")) {
+							do {
+								values.push_back(expression());
+							} while(accept_symbol(","));
+						}
+						expect_symbol(")");
+						return values;
+					}
+					
+					void insert(statement_t& s) {
+						s.kind = statement_t::kind_t::insert;
+						expect_keyword("INTO");
+						s.table = table_name();
+						if(accept_symbol("(")) {
+							if(!at_symbol(")")) {
+								do {
+									s.columns.push_back(table_name());
+								} while(accept_symbol(","));
+							}
+							expect_symbol(")");
+						}
+						if(accept_keyword("DEFAULT")) {
+							expect_keyword("VALUES");
+							s.values.push_back({});
+							return;
+						}
+						expect_keyword("VALUES");
+						do {
+							s.values.push_back(tuple());
+						} while(accept_symbol(","));
+					}
+					
+					void update(statement_t& s) {
+						s.kind = statement_t::kind_t::update;
+						s.table = table_name();
+						expect_keyword("SET");
+						do {
+							s.columns.push_back(table_name());
+							expect_symbol("=");
+							s.assignments.push_back(expression());
+						} while(accept_symbol(","));
+						if(accept_keyword("WHERE")) {
+							s.where = expression();
+						}
+					}
+					
+					void remove(statement_t& s) {
+						s.kind = statement_t::kind_t::remove;
+						expect_keyword("FROM");
+						s.table = table_name();
+						if(accept_keyword("WHERE")) {
+							s.where = expression();
+						}
+					}
+					
+					//! Skips tokens up to the next ',' or ')' outside of parentheses
+					void skip_definition() {
+						size_t depth = 0;
+						while(peek().kind != token_t::kind_t::end) {
+							if(depth == 0 && (at_symbol(",") || at_symbol(")"))) {
+								return;
+							}
+							if(at_symbol("(")) {
+								++depth;
+							} else if(at_symbol(")")) {
+								--depth;
+							}
+							next();
+						}
+					}
+					
+					column_t column_definition() {
+						column_t column;
+						column.name = identifier();
+						const std::string type = to_upper(identifier());
+						if(type == "DOUBLE") {
+							accept_keyword("PRECISION");
+						}
+						if(type == "BOOL" || type == "BOOLEAN" || type == "BIT") {
+							column.type = column_type::boolean;
+						} else if(type.find("INT") != std::string::npos) {
+							column.type = column_type::integer;
+						} else if(type == "SERIAL" || type == "BIGSERIAL") {
+							column.type = column_type::integer;
+							column.auto_increment = true;
+						} else if(type == "REAL" || type == "FLOAT" || type == "DOUBLE") {
+							column.type = column_type::real;
+						} else if(type == "DECIMAL" || type == "NUMERIC") {
+							//MySQL's default, DECIMAL(10, 0)
+							column.type = column_type::real;
+							column.precision = 10;
+						} else if(type == "DATE") {
+							column.type = column_type::date;
+						} else if(type == "DATETIME" || type == "DATETIME2" || type == "TIMESTAMP") {
+							column.type = column_type::timestamp;
+						} else if(type == "TIME") {
+							column.type = column_type::time;
+						} else if(type.find("CHAR") != std::string::npos || type == "TEXT" || type == "CLOB" || type == "STRING") {
+							column.type = column_type::text;
+							column.length = type.find("TEXT") != std::string::npos ? 65535 : 255;
+						} else {
+							throw error_t("42000", "Unsupported column type "+type);
+						}
+						if(accept_symbol("(")) {
+							const int64_t length = integer_literal();
+							if(column.type == column_type::text) {
+								column.length = static_cast<size_t>(length);
+							} else if(column.precision) {
+								column.precision = static_cast<unsigned>(length);
+							}
+							if(accept_symbol(",")) {
+								const int64_t scale = integer_literal();
+								if(column.precision) {
+									column.scale = static_cast<unsigned>(scale);
+								}
+							}
+							expect_symbol(")");
+						}
+						while(!(at_symbol(",") || at_symbol(")") || peek().kind == token_t::kind_t::end)) {
+							if(accept_keyword("NOT")) {
+								expect_keyword("NULL");
+								column.nullable = false;
+							} else if(accept_keyword("PRIMARY")) {
+								expect_keyword("KEY");
+								column.nullable = false;
+							} else if(accept_keyword("AUTO_INCREMENT") || accept_keyword("AUTOINCREMENT") || accept_keyword("IDENTITY")) {
+								column.auto_increment = true;
+								if(at_symbol("(")) {
+									tuple();
+								}
+							} else if(at_symbol("(")) {
+								tuple();
+							} else {
+								next();
+							}
+						}
+						return column;
+					}
+					
+					void create(statement_t& s) {
+						s.kind = statement_t::kind_t::create;
+						if(!accept_keyword("TEMPORARY")) {
+							accept_keyword("TEMP");
+						}
+						expect_keyword("TABLE");
+						if(accept_keyword("IF")) {
+							expect_keyword("NOT");
+							expect_keyword("EXISTS");
+							s.if_exists = true;
+						}
+						s.table = table_name();
+						expect_symbol("(");
+						do {
+							if(at_keyword("PRIMARY") || at_keyword("FOREIGN") || at_keyword("UNIQUE") || at_keyword("KEY") ||
+								at_keyword("CONSTRAINT") || at_keyword("INDEX") || at_keyword("CHECK")) {
+								skip_definition();
+							} else {
+								s.definitions.push_back(column_definition());
+							}
+						} while(accept_symbol(","));
+						expect_symbol(")");
+						while(peek().kind != token_t::kind_t::end && !at_symbol(";")) {
+							//table options, e.g. ENGINE=InnoDB
+							next();
+						}
+					}
+					
+					void drop(statement_t& s) {
+						s.kind = statement_t::kind_t::drop;
+						accept_keyword("TEMPORARY");
+						expect_keyword("TABLE");
+						if(accept_keyword("IF")) {
+							expect_keyword("EXISTS");
+							s.if_exists = true;
+						}
+						s.table = table_name();
+					}
+					
+					//! SAVEPOINT, RELEASE [SAVEPOINT] and ROLLBACK TO [SAVEPOINT], or T-SQL's SAVE/ROLLBACK TRANSACTION
+					void savepoint(statement_t& s, statement_t::kind_t kind) {
+						s.kind = kind;
+						s.savepoint = to_lower(identifier());
+					}
+					
+				public:
+					explicit parser_t(const std::string& sql) : _tokens(tokenize(sql)), _pos(0), _parameters(0) {}
+					
+					std::shared_ptr<statement_t> statement() {
+						auto s = std::make_shared<statement_t>();
+						if(accept_keyword("SELECT")) {
+							select(*s);
+						} else if(accept_keyword("INSERT")) {
+							insert(*s);
+						} else if(accept_keyword("UPDATE")) {
+							update(*s);
+						} else if(accept_keyword("DELETE")) {
+							remove(*s);
+						} else if(accept_keyword("CREATE")) {
+							create(*s);
+						} else if(accept_keyword("DROP")) {
+							drop(*s);
+						} else if(accept_keyword("USE")) {
+							identifier();
+						} else if(accept_keyword("SAVEPOINT")) {
+							savepoint(*s, statement_t::kind_t::savepoint);
+						} else if(accept_keyword("SAVE")) {
+							expect_keyword("TRANSACTION");
+							savepoint(*s, statement_t::kind_t::savepoint);
+						} else if(accept_keyword("RELEASE")) {
+							accept_keyword("SAVEPOINT");
+							savepoint(*s, statement_t::kind_t::release_savepoint);
+						} else if(accept_keyword("ROLLBACK")) {
+							if(!accept_keyword("TRANSACTION")) {
+								expect_keyword("TO");
+								accept_keyword("SAVEPOINT");
+							}
+							savepoint(*s, statement_t::kind_t::rollback_to_savepoint);
+						} else if(accept_keyword("DO")) {
+							//MySQL's DO SLEEP(seconds), to have something to time out and cancel
+							s->kind = statement_t::kind_t::sleep;
+							expect_keyword("SLEEP");
+							expect_symbol("(");
+							if(peek().kind != token_t::kind_t::number) {
+								fail("number");
+							}
+							s->seconds = std::stod(next().text);
+							expect_symbol(")");
+						} else if(accept_keyword("KILL")) {
+							//MySQL's KILL [CONNECTION] id, the fake always kills its own session to simulate a dropped link
+							s->kind = statement_t::kind_t::kill;
+							accept_keyword("CONNECTION");
+							if(peek().kind == token_t::kind_t::number) {
+								next();
+							}
+						} else {
+							fail("statement");
+						}
+						accept_symbol(";");
+						if(peek().kind != token_t::kind_t::end) {
+							fail("end of statement");
+						}
+						s->parameters = _parameters;
+						return s;
+					}
+				};
+				
+				std::mutex& catalog_mutex() {
+					static std::mutex mutex;
+					return mutex;
+				}
+				
+				catalog_t& catalog() {
+					static catalog_t tables;
+					return tables;
+				}
+				
+				void before_write(session_t& session) {
+					if(!session.autocommit && !session.snapshot) {
+						session.snapshot.reset(new catalog_t(catalog()));
+					}
+				}
+				
+				table_t& find_table(const std::string& name) {
+					auto it = catalog().find(to_lower(name));
+					if(it == catalog().end()) {
+						throw error_t("42S02", "Table not found: "+name);
+					}
+					return it->second;
+				}
+				
+				//! Synthetic table fake_series_<N>, generated on the fly
+				const std::string series_prefix = "fake_series_";
+				
+				bool is_series(const std::string& name, size_t& rows) {
+					const std::string lower = to_lower(name);
+					if(lower.compare(0, series_prefix.size(), series_prefix) != 0 || lower.size() == series_prefix.size() ||
+						lower.find_first_not_of("0123456789", series_prefix.size()) != std::string::npos) {
+						return false;
+					}
+					rows = std::stoull(lower.substr(series_prefix.size()));
+					return true;
+				}
+				
+				std::vector<column_t> series_columns() {
+					std::vector<column_t> columns(7);
+					const char* const names[] = {"id", "value", "name", "day", "ts", "flag", "maybe"};
+					const column_type types[] = {column_type::integer, column_type::real, column_type::text, column_type::date,
+						column_type::timestamp, column_type::boolean, column_type::integer};
+					for(size_t i = 0; i < columns.size(); ++i) {
+						columns[i].name = names[i];
+						columns[i].type = types[i];
+						columns[i].length = types[i] == column_type::text ? 32 : 0;
+						columns[i].nullable = i == 6;
+					}
+					return columns;
+				}
+				
+				value_t series_value(int64_t id, size_t column) {
+					int y;
+					unsigned m, d;
+					switch(column) {
+						case 0:
+							return make_integer(id);
+						case 1:
+							return make_real(static_cast<double>(id) * 0.5);
+						case 2:
+							return make_text("name_"+std::to_string(id));
+						case 3:
+							civil_from_days(id, y, m, d);
+							return make_date(y, m, d);
+						case 4: {
+							//2000-01-01 plus id seconds and id % 1000 milliseconds
+							civil_from_days(10957 + id / 86400, y, m, d);
+							const int64_t seconds = id % 86400;
+							return make_timestamp(y, m, d, static_cast<unsigned>(seconds / 3600), static_cast<unsigned>(seconds / 60 % 60),
+								static_cast<unsigned>(seconds % 60), static_cast<uint32_t>(id % 1000) * 1000000u);
+						}
+						case 5:
+							return make_integer(id % 2);
+						default:
+							return id % 3 == 0 ? value_t() : make_integer(id * 3);
+					}
+				}
+				
+				struct source_t {
+					std::string name;
+					std::string alias;
+					std::vector<column_t> columns;
+					size_t rows;
+					//Either table is set or the source is a synthetic series
+					const table_t* table;
+					//Rows of joined tables, table points here then
+					std::shared_ptr<table_t> joined;
+					//Name and alias of the table each column comes from, only set for joins
+					std::vector<std::pair<std::string, std::string>> origins;
+				};
+				
+				source_t open_source(const statement_t& s) {
+					source_t source;
+					source.name = to_lower(s.table);
+					source.alias = to_lower(s.table_alias);
+					source.table = nullptr;
+					if(s.table.empty()) {
+						source.rows = 1;
+					} else if(is_series(s.table, source.rows)) {
+						source.columns = series_columns();
+					} else {
+						source.table = &find_table(s.table);
+						source.columns = source.table->columns;
+						source.rows = source.table->rows.size();
+					}
+					return source;
+				}
+				
+				void load_row(const source_t& source, size_t row, std::vector<value_t>& out) {
+					if(source.table) {
+						out = source.table->rows[row];
+					} else {
+						out.resize(source.columns.size());
+						for(size_t i = 0; i < out.size(); ++i) {
+							out[i] = series_value(static_cast<int64_t>(row) + 1, i);
+						}
+					}
+				}
+				
+				size_t find_column(const source_t& source, const std::string& qualifier, const std::string& name) {
+					if(!source.origins.empty()) {
+						const std::string q = to_lower(qualifier);
+						const std::string lower = to_lower(name);
+						size_t found = source.columns.size();
+						for(size_t i = 0; i < source.columns.size(); ++i) {
+							if(to_lower(source.columns[i].name) == lower && (q.empty() || q == source.origins[i].first || q == source.origins[i].second)) {
+								if(found != source.columns.size()) {
+									throw error_t("42000", "Column reference is ambiguous: "+name);
+								}
+								found = i;
+							}
+						}
+						if(found == source.columns.size()) {
+							throw error_t("42S22", "Column not found: "+(qualifier.empty() ? name : qualifier+'.'+name));
+						}
+						return found;
+					}
+					if(!qualifier.empty()) {
+						const std::string q = to_lower(qualifier);
+						if(q != source.name && q != source.alias) {
+							throw error_t("42S22", "Column not found: "+qualifier+'.'+name);
+						}
+					}
+					const std::string lower = to_lower(name);
+					for(size_t i = 0; i < source.columns.size(); ++i) {
+						if(to_lower(source.columns[i].name) == lower) {
+							return i;
+						}
+					}
+					throw error_t("42S22", "Column not found: "+name);
+				}
+				
+				//! Returns a copy of e with column references replaced by indices into the source row
+				expr_ptr resolve(const expr_ptr& e, const source_t& source) {
+					if(!e) {
+						return e;
+					}
+					auto r = std::make_shared<expr_t>(*e);
+					if(r->kind == expr_t::kind_t::column) {
+						r->index = find_column(source, r->qualifier, r->name);
+					}
+					for(auto& arg : r->args) {
+						arg = resolve(arg, source);
+					}
+					return r;
+				}
+				
+				struct context_t {
+					const std::vector<value_t>& row;
+					const std::vector<value_t>& parameters;
+					const session_t& session;
+				};
+				
+				bool truth(const value_t& v) {
+					switch(v.type) {
+						case value_type::null:
+							return false;
+						case value_type::integer:
+							return v.integer != 0;
+						case value_type::real:
+							return v.real != 0.0;
+						default:
+							return true;
+					}
+				}
+				
+				value_t eval(const expr_t& e, const context_t& c);
+				
+				value_t eval_function(const expr_t& e, const context_t& c) {
+					if(e.name == "LAST_INSERT_ID" || e.name == "LAST_INSERT_ROWID" || e.name == "LASTVAL" ||
+						e.name == "SCOPE_IDENTITY" || e.name == "@@IDENTITY") {
+						return make_integer(c.session.last_insert_id);
+					}
+					if(e.name == "CONCAT") {
+						std::string text;
+						for(const auto& arg : e.args) {
+							const value_t v = eval(*arg, c);
+							if(v.is_null()) {
+								return value_t();
+							}
+							text += to_text(v);
+						}
+						return make_text(text);
+					}
+					if(e.name == "UPPER" || e.name == "LOWER") {
+						const value_t v = e.args.empty() ? value_t() : eval(*e.args.front(), c);
+						if(v.is_null()) {
+							return v;
+						}
+						return make_text(e.name == "UPPER" ? to_upper(to_text(v)) : to_lower(to_text(v)));
+					}
+					if(e.name == "COUNT") {
+						throw error_t("42000", "COUNT is only supported as the only aggregate in a select list");
+					}
+					throw error_t("42000", "Unsupported function "+e.name);
+				}
+				
+				value_t eval_binary(const expr_t& e, const context_t& c) {
+					if(e.name == "AND") {
+						return make_integer(truth(eval(*e.args[0], c)) && truth(eval(*e.args[1], c)));
+					}
+					if(e.name == "OR") {
+						return make_integer(truth(eval(*e.args[0], c)) || truth(eval(*e.args[1], c)));
+					}
+					const value_t a = eval(*e.args[0], c);
+					const value_t b = eval(*e.args[1], c);
+					if(a.is_null() || b.is_null()) {
+						return value_t();
+					}
+					if(e.name == "||") {
+						return make_text(to_text(a)+to_text(b));
+					}
+					if(e.name == "+" || e.name == "-" || e.name == "*" || e.name == "/" || e.name == "%") {
+						if(!is_numeric(a) || !is_numeric(b)) {
+							throw error_t("22018", "Arithmetic on non-numeric values");
+						}
+						if(a.type == value_type::integer && b.type == value_type::integer && e.name != "/") {
+							switch(e.name[0]) {
+								case '+': return make_integer(a.integer + b.integer);
+								case '-': return make_integer(a.integer - b.integer);
+								case '*': return make_integer(a.integer * b.integer);
+								default:
+									if(b.integer == 0) {
+										throw error_t("22012", "Division by zero");
+									}
+									return make_integer(a.integer % b.integer);
+							}
+						}
+						switch(e.name[0]) {
+							case '+': return make_real(as_real(a) + as_real(b));
+							case '-': return make_real(as_real(a) - as_real(b));
+							case '*': return make_real(as_real(a) * as_real(b));
+							case '%': return make_real(std::fmod(as_real(a), as_real(b)));
+							default:
+								if(as_real(b) == 0.0) {
+									throw error_t("22012", "Division by zero");
+								}
+								return make_real(as_real(a) / as_real(b));
+						}
+					}
+					int r = 0;
+					compare(a, b, r);
+					if(e.name == "=") return make_integer(r == 0);
+					if(e.name == "<>" || e.name == "!=") return make_integer(r != 0);
+					if(e.name == "<") return make_integer(r < 0);
+					if(e.name == "<=") return make_integer(r <= 0);
+					if(e.name == ">") return make_integer(r > 0);
+					return make_integer(r >= 0);
+				}
+				
+				value_t eval(const expr_t& e, const context_t& c) {
+					switch(e.kind) {
+						case expr_t::kind_t::literal:
+							return e.value;
+						case expr_t::kind_t::parameter:
+							if(e.index >= c.parameters.size()) {
+								throw error_t("07002", "COUNT field incorrect");
+							}
+							return c.parameters[e.index];
+						case expr_t::kind_t::column:
+							return c.row[e.index];
+						case expr_t::kind_t::function:
+							return eval_function(e, c);
+						case expr_t::kind_t::unary: {
+							const value_t v = eval(*e.args[0], c);
+							if(e.name == "NOT") {
+								return v.is_null() ? v : make_integer(!truth(v));
+							}
+							if(v.type == value_type::integer) {
+								return make_integer(-v.integer);
+							}
+							if(v.type == value_type::real) {
+								return make_real(-v.real);
+							}
+							return value_t();
+						}
+						case expr_t::kind_t::binary:
+							return eval_binary(e, c);
+						case expr_t::kind_t::is_null:
+							return make_integer(eval(*e.args[0], c).is_null() != e.negated);
+						case expr_t::kind_t::in_list: {
+							const value_t v = eval(*e.args[0], c);
+							if(v.is_null()) {
+								return v;
+							}
+							bool found = false;
+							for(size_t i = 1; i < e.args.size() && !found; ++i) {
+								int r;
+								found = compare(v, eval(*e.args[i], c), r) && r == 0;
+							}
+							return make_integer(found != e.negated);
+						}
+						case expr_t::kind_t::like: {
+							const value_t v = eval(*e.args[0], c);
+							const value_t p = eval(*e.args[1], c);
+							if(v.is_null() || p.is_null()) {
+								return value_t();
+							}
+							return make_integer(like(to_text(v).c_str(), to_text(p).c_str()) != e.negated);
+						}
+						default:
+							throw error_t("42000", "'*' is not allowed here");
+					}
+				}
+				
+				column_t describe(const select_item_t& item, const source_t& source, const value_t& sample) {
+					column_t column;
+					if(item.expr->kind == expr_t::kind_t::column) {
+						column = source.columns[item.expr->index];
+					} else {
+						column.name = item.expr->kind == expr_t::kind_t::function ? to_lower(item.expr->name) : "expr";
+						column.length = 0;
+						switch(sample.type) {
+							case value_type::real: column.type = column_type::real; break;
+							case value_type::text: column.type = column_type::text; column.length = 255; break;
+							case value_type::date: column.type = column_type::date; break;
+							case value_type::timestamp: column.type = column_type::timestamp; break;
+							case value_type::time: column.type = column_type::time; break;
+							default: column.type = column_type::integer;
+						}
+					}
+					if(!item.alias.empty()) {
+						column.name = item.alias;
+					}
+					return column;
+				}
+				
+				//! The FROM table with the tables of its joins, nested loops over the rows joined so far
+				source_t open_joined_source(const statement_t& s, const session_t& session, const std::vector<value_t>& parameters) {
+					source_t source = open_source(s);
+					if(s.joins.empty()) {
+						return source;
+					}
+					auto joined = std::make_shared<table_t>();
+					joined->columns = source.columns;
+					source.origins.assign(source.columns.size(), std::make_pair(source.name, source.alias));
+					std::vector<value_t> row;
+					for(size_t i = 0; i < source.rows; ++i) {
+						load_row(source, i, row);
+						joined->rows.push_back(row);
+					}
+					for(const auto& join : s.joins) {
+						statement_t single;
+						single.table = join.table;
+						single.table_alias = join.alias;
+						const source_t right = open_source(single);
+						source.columns.insert(source.columns.end(), right.columns.begin(), right.columns.end());
+						source.origins.resize(source.columns.size(), std::make_pair(right.name, right.alias));
+						const auto on = resolve(join.on, source);
+						std::vector<std::vector<value_t>> rows;
+						std::vector<value_t> right_row;
+						for(const auto& left_row : joined->rows) {
+							for(size_t i = 0; i < right.rows; ++i) {
+								load_row(right, i, right_row);
+								row = left_row;
+								row.insert(row.end(), right_row.begin(), right_row.end());
+								if(truth(eval(*on, context_t{row, parameters, session}))) {
+									rows.push_back(row);
+								}
+							}
+						}
+						joined->rows.swap(rows);
+					}
+					joined->columns = source.columns;
+					source.rows = joined->rows.size();
+					source.table = joined.get();
+					source.joined = joined;
+					return source;
+				}
+				
+				execution_t execute_select(const statement_t& s, session_t& session, const std::vector<value_t>& parameters) {
+					const source_t source = open_joined_source(s, session, parameters);
+					std::vector<select_item_t> items;
+					for(const auto& item : s.items) {
+						if(item.expr->kind == expr_t::kind_t::star) {
+							if(!item.expr->qualifier.empty()) {
+								find_column(source, item.expr->qualifier, source.columns.empty() ? std::string() : source.columns.front().name);
+							}
+							for(size_t i = 0; i < source.columns.size(); ++i) {
+								select_item_t column_item;
+								column_item.expr = make_expr(expr_t::kind_t::column);
+								column_item.expr->index = i;
+								items.push_back(column_item);
+							}
+						} else {
+							items.push_back({resolve(item.expr, source), item.alias});
+						}
+					}
+					const auto where = resolve(s.where, source);
+					std::vector<order_item_t> order_by;
+					for(const auto& item : s.order_by) {
+						order_by.push_back({resolve(item.expr, source), item.descending});
+					}
+					
+					execution_t execution;
+					execution.result = std::make_shared<result_set_t>();
+					const size_t offset = static_cast<size_t>(std::max<int64_t>(s.offset, 0));
+					
+					bool aggregate = false;
+					bool plain_columns = true;
+					for(const auto& item : items) {
+						aggregate |= item.expr->kind == expr_t::kind_t::function && item.expr->name == "COUNT";
+						plain_columns &= item.expr->kind == expr_t::kind_t::column;
+					}
+					if(!source.table && !source.columns.empty() && !where && order_by.empty() && !aggregate && plain_columns) {
+						//Synthetic rows are generated when fetched, so huge series cost no memory
+						std::vector<size_t> mapping;
+						for(const auto& item : items) {
+							execution.result->columns.push_back(describe(item, source, value_t()));
+							mapping.push_back(item.expr->index);
+						}
+						size_t rows = source.rows > offset ? source.rows - offset : 0;
+						if(s.limit >= 0) {
+							rows = std::min(rows, static_cast<size_t>(s.limit));
+						}
+						execution.result->rows = rows;
+						execution.result->cell = [mapping, offset](size_t row, size_t column) {
+							return series_value(static_cast<int64_t>(offset + row) + 1, mapping[column]);
+						};
+						return execution;
+					}
+					
+					std::vector<std::vector<value_t>> matches;
+					std::vector<value_t> row;
+					for(size_t i = 0; i < source.rows; ++i) {
+						load_row(source, i, row);
+						if(!where || truth(eval(*where, context_t{row, parameters, session}))) {
+							matches.push_back(row);
+						}
+					}
+					if(!order_by.empty()) {
+						std::stable_sort(matches.begin(), matches.end(),
+							[&](const std::vector<value_t>& a, const std::vector<value_t>& b) {
+								for(const auto& item : order_by) {
+									const value_t va = eval(*item.expr, context_t{a, parameters, session});
+									const value_t vb = eval(*item.expr, context_t{b, parameters, session});
+									int r = 0;
+									if(!compare(va, vb, r)) {
+										//NULLs sort first
+										r = va.is_null() == vb.is_null() ? 0 : (va.is_null() ? -1 : 1);
+									}
+									if(r) {
+										return item.descending ? r > 0 : r < 0;
+									}
+								}
+								return false;
+							});
+					}
+					
+					auto rows = std::make_shared<std::vector<std::vector<value_t>>>();
+					if(aggregate) {
+						std::vector<value_t> out;
+						for(const auto& item : items) {
+							if(item.expr->kind == expr_t::kind_t::function && item.expr->name == "COUNT") {
+								int64_t count = 0;
+								for(const auto& m : matches) {
+									const auto& arg = item.expr->args;
+									count += arg.empty() || arg.front()->kind == expr_t::kind_t::star ||
+										!eval(*arg.front(), context_t{m, parameters, session}).is_null();
+								}
+								out.push_back(make_integer(count));
+							} else {
+								out.push_back(matches.empty() ? value_t() : eval(*item.expr, context_t{matches.front(), parameters, session}));
+							}
+						}
+						rows->push_back(out);
+					} else {
+						size_t count = matches.size() > offset ? matches.size() - offset : 0;
+						if(s.limit >= 0) {
+							count = std::min(count, static_cast<size_t>(s.limit));
+						}
+						rows->reserve(count);
+						for(size_t i = offset; i < offset + count; ++i) {
+							std::vector<value_t> out;
+							out.reserve(items.size());
+							for(const auto& item : items) {
+								out.push_back(eval(*item.expr, context_t{matches[i], parameters, session}));
+							}
+							rows->push_back(std::move(out));
+						}
+					}
+					for(size_t i = 0; i < items.size(); ++i) {
+						execution.result->columns.push_back(describe(items[i], source, rows->empty() ? value_t() : rows->front()[i]));
+						if(aggregate && items[i].expr->kind == expr_t::kind_t::function) {
+							execution.result->columns.back().nullable = false;
+						}
+					}
+					execution.result->rows = rows->size();
+					execution.result->cell = [rows](size_t row, size_t column) {
+						return (*rows)[row][column];
+					};
+					return execution;
+				}
+				
+				void store(table_t& table, std::vector<value_t>& row, size_t column, const value_t& v, session_t& session) {
+					const column_t& definition = table.columns[column];
+					row[column] = coerce(v, definition.type);
+					if(definition.auto_increment) {
+						if(row[column].is_null()) {
+							row[column] = make_integer(table.next_id++);
+							session.last_insert_id = row[column].integer;
+						} else {
+							table.next_id = std::max(table.next_id, row[column].integer + 1);
+						}
+					}
+					if(row[column].is_null() && !definition.nullable) {
+						throw error_t("23000", "Column '"+definition.name+"' cannot be null");
+					}
+				}
+				
+				execution_t execute_insert(const statement_t& s, session_t& session, const std::vector<value_t>& parameters) {
+					source_t source = open_source(s);
+					if(!source.table) {
+						throw error_t("HY000", "Cannot insert into "+s.table);
+					}
+					table_t& table = find_table(s.table);
+					std::vector<size_t> indices;
+					for(const auto& name : s.columns) {
+						indices.push_back(find_column(source, std::string(), name));
+					}
+					if(s.columns.empty() && !s.values.empty() && !s.values.front().empty()) {
+						for(size_t i = 0; i < table.columns.size(); ++i) {
+							indices.push_back(i);
+						}
+					}
+					before_write(session);
+					const std::vector<value_t> empty;
+					execution_t execution;
+					execution.affected = 0;
+					for(const auto& tuple : s.values) {
+						if(tuple.size() != indices.size()) {
+							throw error_t("21S01", "Insert value list does not match column list");
+						}
+						std::vector<value_t> row(table.columns.size());
+						std::vector<bool> assigned(table.columns.size(), false);
+						for(size_t i = 0; i < tuple.size(); ++i) {
+							store(table, row, indices[i], eval(*tuple[i], context_t{empty, parameters, session}), session);
+							assigned[indices[i]] = true;
+						}
+						for(size_t i = 0; i < row.size(); ++i) {
+							if(!assigned[i]) {
+								store(table, row, i, value_t(), session);
+							}
+						}
+						table.rows.push_back(std::move(row));
+						++execution.affected;
+					}
+					return execution;
+				}
+				
+				execution_t execute_update(const statement_t& s, session_t& session, const std::vector<value_t>& parameters) {
+					source_t source = open_source(s);
+					if(!source.table) {
+						throw error_t("HY000", "Cannot update "+s.table);
+					}
+					table_t& table = find_table(s.table);
+					std::vector<size_t> indices;
+					std::vector<expr_ptr> assignments;
+					for(size_t i = 0; i < s.columns.size(); ++i) {
+						indices.push_back(find_column(source, std::string(), s.columns[i]));
+						assignments.push_back(resolve(s.assignments[i], source));
+					}
+					const auto where = resolve(s.where, source);
+					before_write(session);
+					execution_t execution;
+					execution.affected = 0;
+					for(auto& row : table.rows) {
+						if(where && !truth(eval(*where, context_t{row, parameters, session}))) {
+							continue;
+						}
+						std::vector<value_t> updated = row;
+						for(size_t i = 0; i < indices.size(); ++i) {
+							store(table, updated, indices[i], eval(*assignments[i], context_t{row, parameters, session}), session);
+						}
+						row.swap(updated);
+						++execution.affected;
+					}
+					return execution;
+				}
+				
+				execution_t execute_remove(const statement_t& s, session_t& session, const std::vector<value_t>& parameters) {
+					source_t source = open_source(s);
+					if(!source.table) {
+						throw error_t("HY000", "Cannot delete from "+s.table);
+					}
+					table_t& table = find_table(s.table);
+					const auto where = resolve(s.where, source);
+					before_write(session);
+					const size_t before = table.rows.size();
+					table.rows.erase(std::remove_if(table.rows.begin(), table.rows.end(),
+						[&](const std::vector<value_t>& row) {
+							return !where || truth(eval(*where, context_t{row, parameters, session}));
+						}), table.rows.end());
+					execution_t execution;
+					execution.affected = static_cast<int64_t>(before - table.rows.size());
+					return execution;
+				}
+			}
+			
+			value_t make_integer(int64_t i) {
+				value_t v;
+				v.type = value_type::integer;
+				v.integer = i;
+				return v;
+			}
+			
+			value_t make_real(double d) {
+				value_t v;
+				v.type = value_type::real;
+				v.real = d;
+				return v;
+			}
+			
+			value_t make_text(std::string s) {
+				value_t v;
+				v.type = value_type::text;
+				v.text = std::move(s);
+				return v;
+			}
+			
+			value_t make_date(int year, unsigned month, unsigned day) {
+				value_t v;
+				v.type = value_type::date;
+				v.year = year;
+				v.month = month;
+				v.day = day;
+				return v;
+			}
+			
+			value_t make_timestamp(int year, unsigned month, unsigned day, unsigned hour, unsigned minute, unsigned second, uint32_t fraction) {
+				value_t v = make_date(year, month, day);
+				v.type = value_type::timestamp;
+				v.hour = hour;
+				v.minute = minute;
+				v.second = second;
+				v.fraction = fraction;
+				return v;
+			}
+			
+			value_t make_time(unsigned hour, unsigned minute, unsigned second) {
+				value_t v;
+				v.type = value_type::time;
+				v.hour = hour;
+				v.minute = minute;
+				v.second = second;
+				return v;
+			}
+			
+			std::string to_text(const value_t& v) {
+				char buffer[64];
+				switch(v.type) {
+					case value_type::null:
+						return std::string();
+					case value_type::integer:
+						return std::to_string(v.integer);
+					case value_type::real:
+						//Shortest representation that survives a round trip
+						std::snprintf(buffer, sizeof(buffer), "%.15g", v.real);
+						if(std::strtod(buffer, nullptr) != v.real) {
+							std::snprintf(buffer, sizeof(buffer), "%.17g", v.real);
+						}
+						return buffer;
+					case value_type::text:
+						return v.text;
+					case value_type::date:
+						std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u", v.year, v.month, v.day);
+						return buffer;
+					case value_type::timestamp:
+						if(v.fraction % 1000) {
+							std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u %02u:%02u:%02u.%09u", v.year, v.month, v.day, v.hour, v.minute, v.second, v.fraction);
+						} else if(v.fraction) {
+							std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u %02u:%02u:%02u.%06u", v.year, v.month, v.day, v.hour, v.minute, v.second, v.fraction / 1000);
+						} else {
+							std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u %02u:%02u:%02u", v.year, v.month, v.day, v.hour, v.minute, v.second);
+						}
+						return buffer;
+					case value_type::time:
+						std::snprintf(buffer, sizeof(buffer), "%02u:%02u:%02u", v.hour, v.minute, v.second);
+						return buffer;
+				}
+				return std::string();
+			}
+			
+			value_t coerce(const value_t& v, column_type type) {
+				if(v.is_null()) {
+					return v;
+				}
+				value_t result;
+				bool ok = true;
+				switch(type) {
+					case column_type::integer:
+					case column_type::boolean:
+						if(v.type == value_type::integer) {
+							result = v;
+						} else if(v.type == value_type::real) {
+							result = make_integer(static_cast<int64_t>(v.real));
+						} else if(v.type == value_type::text) {
+							char* end = nullptr;
+							result = make_integer(std::strtoll(v.text.c_str(), &end, 10));
+							ok = !v.text.empty() && *end == '\0';
+						} else {
+							ok = false;
+						}
+						if(ok && type == column_type::boolean) {
+							result.integer = result.integer != 0;
+						}
+						break;
+					case column_type::real:
+						if(is_numeric(v)) {
+							result = make_real(as_real(v));
+						} else if(v.type == value_type::text) {
+							char* end = nullptr;
+							result = make_real(std::strtod(v.text.c_str(), &end));
+							ok = !v.text.empty() && *end == '\0';
+						} else {
+							ok = false;
+						}
+						break;
+					case column_type::text:
+						result = make_text(to_text(v));
+						break;
+					case column_type::date:
+						if(v.type == value_type::date || v.type == value_type::timestamp) {
+							result = make_date(v.year, v.month, v.day);
+						} else {
+							ok = v.type == value_type::text && parse_date(v.text, result);
+						}
+						break;
+					case column_type::timestamp:
+						if(v.type == value_type::date || v.type == value_type::timestamp) {
+							result = make_timestamp(v.year, v.month, v.day, v.hour, v.minute, v.second, v.fraction);
+						} else if(v.type == value_type::time) {
+							//ODBC converts times to timestamps on the current date
+							int y;
+							unsigned m, d;
+							civil_from_days(static_cast<int64_t>(std::time(nullptr) / 86400), y, m, d);
+							result = make_timestamp(y, m, d, v.hour, v.minute, v.second, v.fraction);
+						} else {
+							ok = v.type == value_type::text && parse_timestamp(v.text, result);
+						}
+						break;
+					case column_type::time:
+						if(v.type == value_type::time || v.type == value_type::timestamp) {
+							result = make_time(v.hour, v.minute, v.second);
+							result.fraction = v.fraction;
+						} else {
+							ok = v.type == value_type::text && parse_time(v.text, result);
+						}
+						break;
+				}
+				if(!ok) {
+					throw error_t("22018", "Invalid character value for cast specification: "+to_text(v));
+				}
+				return result;
+			}
+			
+			std::shared_ptr<const statement_t> parse(const std::string& sql) {
+				return parser_t(sql).statement();
+			}
+			
+			size_t parameter_count(const statement_t& statement) {
+				return statement.parameters;
+			}
+			
+			execution_t execute(const statement_t& statement, session_t& session, const std::vector<value_t>& parameters) {
+				std::lock_guard<std::mutex> lock(catalog_mutex());
+				switch(statement.kind) {
+					case statement_t::kind_t::select:
+						return execute_select(statement, session, parameters);
+					case statement_t::kind_t::insert:
+						return execute_insert(statement, session, parameters);
+					case statement_t::kind_t::update:
+						return execute_update(statement, session, parameters);
+					case statement_t::kind_t::remove:
+						return execute_remove(statement, session, parameters);
+					case statement_t::kind_t::create: {
+						const std::string name = to_lower(statement.table);
+						size_t rows;
+						if(is_series(name, rows)) {
+							throw error_t("42S01", "Table already exists: "+statement.table);
+						}
+						if(catalog().count(name)) {
+							if(statement.if_exists) {
+								return execution_t();
+							}
+							throw error_t("42S01", "Table already exists: "+statement.table);
+						}
+						before_write(session);
+						catalog()[name].columns = statement.definitions;
+						return execution_t();
+					}
+					case statement_t::kind_t::drop: {
+						const std::string name = to_lower(statement.table);
+						if(!catalog().count(name)) {
+							if(statement.if_exists) {
+								return execution_t();
+							}
+							throw error_t("42S02", "Table not found: "+statement.table);
+						}
+						before_write(session);
+						catalog().erase(name);
+						return execution_t();
+					}
+					case statement_t::kind_t::savepoint:
+						if(session.autocommit) {
+							throw error_t("25000", "Invalid transaction state: savepoints need a transaction");
+						}
+						before_write(session);
+						session.savepoints.emplace_back(statement.savepoint, catalog());
+						return execution_t();
+					case statement_t::kind_t::release_savepoint:
+					case statement_t::kind_t::rollback_to_savepoint: {
+						auto it = session.savepoints.end();
+						while(it != session.savepoints.begin() && (it - 1)->first != statement.savepoint) {
+							--it;
+						}
+						if(it == session.savepoints.begin()) {
+							throw error_t("3B001", "Savepoint does not exist: "+statement.savepoint);
+						}
+						if(statement.kind == statement_t::kind_t::rollback_to_savepoint) {
+							//The savepoint itself remains
+							catalog() = (it - 1)->second;
+						} else {
+							--it;
+						}
+						session.savepoints.erase(it, session.savepoints.end());
+						return execution_t();
+					}
+					case statement_t::kind_t::kill:
+						//The server rolls back what the session left open
+						if(session.snapshot) {
+							catalog().swap(*session.snapshot);
+							session.snapshot.reset();
+						}
+						session.savepoints.clear();
+						session.killed = true;
+						return execution_t();
+					case statement_t::kind_t::sleep: {
+						execution_t execution;
+						execution.sleep = statement.seconds;
+						return execution;
+					}
+					default:
+						return execution_t();
+				}
+			}
+			
+			void commit(session_t& session) {
+				std::lock_guard<std::mutex> lock(catalog_mutex());
+				session.snapshot.reset();
+				session.savepoints.clear();
+			}
+			
+			void rollback(session_t& session) {
+				std::lock_guard<std::mutex> lock(catalog_mutex());
+				if(session.snapshot) {
+					catalog().swap(*session.snapshot);
+					session.snapshot.reset();
+				}
+				session.savepoints.clear();
+			}
+		}
+	}
+}
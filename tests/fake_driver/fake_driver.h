@@ -0,0 +1,155 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SQLPP11_ODBC_FAKE_DRIVER_H
+#define SQLPP11_ODBC_FAKE_DRIVER_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlpp {
+	namespace odbc {
+		namespace fake {
+			enum class value_type {
+				null,
+				integer,
+				real,
+				text,
+				date,
+				timestamp,
+				time
+			};
+			
+			struct value_t {
+				value_type type = value_type::null;
+				int64_t integer = 0;
+				double real = 0.0;
+				std::string text;
+				//date, timestamp and time parts, fraction is in nanoseconds
+				int year = 0;
+				unsigned month = 0, day = 0, hour = 0, minute = 0, second = 0;
+				uint32_t fraction = 0;
+				
+				bool is_null() const { return type == value_type::null; }
+			};
+			
+			value_t make_integer(int64_t i);
+			value_t make_real(double d);
+			value_t make_text(std::string s);
+			value_t make_date(int year, unsigned month, unsigned day);
+			value_t make_timestamp(int year, unsigned month, unsigned day, unsigned hour, unsigned minute, unsigned second, uint32_t fraction);
+			value_t make_time(unsigned hour, unsigned minute, unsigned second);
+			
+			std::string to_text(const value_t& v);
+			
+			enum class column_type {
+				integer,
+				boolean,
+				real,
+				text,
+				date,
+				timestamp,
+				time
+			};
+			
+			struct column_t {
+				std::string name;
+				column_type type = column_type::text;
+				size_t length = 255;
+				//DECIMAL/NUMERIC columns are stored as real, but described with their precision (non zero) and scale
+				unsigned precision = 0;
+				unsigned scale = 0;
+				bool nullable = true;
+				bool auto_increment = false;
+			};
+			
+			//! Converts v to the storage type of a column, throws error_t(22018) if impossible
+			value_t coerce(const value_t& v, column_type type);
+			
+			//! Thrown by the engine, reported to the application through SQLGetDiagRec
+			struct error_t : public std::runtime_error {
+				error_t(std::string state, const std::string& message) : std::runtime_error(message), sqlstate(std::move(state)) {}
+				std::string sqlstate;
+			};
+			
+			struct table_t {
+				std::vector<column_t> columns;
+				std::vector<std::vector<value_t>> rows;
+				int64_t next_id = 1;
+			};
+			using catalog_t = std::map<std::string, table_t>;
+			
+			//! Per connection state
+			struct session_t {
+				bool autocommit = true;
+				int64_t last_insert_id = 0;
+				//Copy of the catalog taken at the first write of a transaction, restored on rollback
+				std::unique_ptr<catalog_t> snapshot;
+				//Named copies of the catalog, restored by ROLLBACK TO SAVEPOINT
+				std::vector<std::pair<std::string, catalog_t>> savepoints;
+				//Set by KILL CONNECTION, everything but SQLDisconnect fails with a communication link failure from then on
+				bool killed = false;
+			};
+			
+			struct result_set_t {
+				std::vector<column_t> columns;
+				size_t rows = 0;
+				std::function<value_t(size_t row, size_t column)> cell;
+			};
+			
+			struct execution_t {
+				std::shared_ptr<result_set_t> result;
+				int64_t affected = -1;
+				//Seconds the driver waits for DO SLEEP, unless the statement is cancelled or times out
+				double sleep = 0;
+			};
+			
+			struct statement_t;
+			
+			std::shared_ptr<const statement_t> parse(const std::string& sql);
+			size_t parameter_count(const statement_t& statement);
+			execution_t execute(const statement_t& statement, session_t& session, const std::vector<value_t>& parameters);
+			
+			void commit(session_t& session);
+			void rollback(session_t& session);
+			
+			//Driver specific statement attributes (from SQL_DRIVER_STMT_ATTR_BASE on), tests set them through statement_options::attributes
+			//Runs every set of a parameter array like SQL Server does, failing sets are marked and reported with SQL_SUCCESS_WITH_INFO
+			const int32_t attr_continue_after_errors = 0x4000;
+			//Lowers a larger SQL_ATTR_PARAMSET_SIZE to this many sets with 01S02 Option value changed
+			const int32_t attr_max_paramset_size = 0x4001;
+		}
+	}
+}
+
+#endif //SQLPP11_ODBC_FAKE_DRIVER_H
@@ -0,0 +1,1414 @@
+/* 
+ * Copyright (c) 2017, Aaron Bishop
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#endif
+
+#include <sql.h>
+#include <sqlext.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include "fake_driver.h"
+
+namespace sqlpp {
+	namespace odbc {
+		namespace fake {
+			namespace {
+				struct diagnostic_t {
+					std::string sqlstate;
+					std::string message;
+				};
+				
+				struct handle_t {
+					SQLSMALLINT type;
+					std::vector<diagnostic_t> diagnostics;
+					
+					explicit handle_t(SQLSMALLINT t) : type(t) {}
+					virtual ~handle_t() = default;
+				};
+				
+				struct env_t : public handle_t {
+					SQLINTEGER version = SQL_OV_ODBC3;
+					
+					env_t() : handle_t(SQL_HANDLE_ENV) {}
+				};
+				
+				struct dbc_t : public handle_t {
+					env_t* env;
+					bool connected = false;
+					session_t session;
+					std::map<SQLINTEGER, SQLUINTEGER> attributes;
+					
+					explicit dbc_t(env_t* e) : handle_t(SQL_HANDLE_DBC), env(e) {}
+				};
+				
+				struct parameter_t {
+					SQLSMALLINT c_type;
+					SQLSMALLINT sql_type;
+					SQLPOINTER value;
+					SQLLEN buffer_length;
+					SQLLEN* indicator;
+				};
+				
+				//! A column bound by SQLBindCol
+				struct binding_t {
+					SQLSMALLINT c_type;
+					SQLPOINTER target;
+					SQLLEN buffer_length;
+					SQLLEN* indicator;
+				};
+				
+				struct stmt_t;
+				
+				//! Application row or parameter descriptor, it only keeps the fields SQL_C_NUMERIC needs
+				struct desc_t : public handle_t {
+					struct record_t {
+						SQLSMALLINT type;
+						SQLSMALLINT precision;
+						SQLSMALLINT scale;
+					};
+					
+					stmt_t* stmt;
+					bool rows;
+					std::map<SQLSMALLINT, record_t> records;
+					
+					desc_t(stmt_t* s, bool r) : handle_t(SQL_HANDLE_DESC), stmt(s), rows(r) {}
+					
+					const record_t* record(SQLSMALLINT number) const {
+						auto it = records.find(number);
+						return it == records.end() ? nullptr : &it->second;
+					}
+				};
+				
+				struct stmt_t : public handle_t {
+					dbc_t* dbc;
+					std::shared_ptr<const statement_t> prepared;
+					std::map<SQLUSMALLINT, parameter_t> parameters;
+					std::map<SQLUSMALLINT, binding_t> bindings;
+					std::map<SQLINTEGER, SQLULEN> attributes;
+					desc_t row_descriptor{this, true};
+					desc_t parameter_descriptor{this, false};
+					std::shared_ptr<result_set_t> result;
+					int64_t affected = -1;
+					//Cursor position, the current rowset starts at row - rowset_size
+					size_t row = 0;
+					size_t rowset_size = 0;
+					bool on_row = false;
+					//SQLGetData state of the current row
+					SQLUSMALLINT data_column = 0;
+					size_t data_offset = 0;
+					bool data_done = false;
+					//SQLCancel is called from other threads, it ends a DO SLEEP that's waiting
+					std::mutex cancel_mutex;
+					std::condition_variable cancel_condition;
+					bool executing = false;
+					bool cancel_requested = false;
+					
+					explicit stmt_t(dbc_t* d) : handle_t(SQL_HANDLE_STMT), dbc(d) {}
+					
+					void close_cursor() {
+						result.reset();
+						row = 0;
+						rowset_size = 0;
+						on_row = false;
+					}
+					
+					SQLULEN attribute(SQLINTEGER key, SQLULEN fallback) const {
+						auto it = attributes.find(key);
+						return it == attributes.end() ? fallback : it->second;
+					}
+				};
+				
+				SQLRETURN fail(handle_t* handle, const std::string& sqlstate, const std::string& message) {
+					handle->diagnostics.push_back({sqlstate, "[sqlpp11][fake driver]"+message});
+					return SQL_ERROR;
+				}
+				
+				SQLRETURN warn(handle_t* handle, const std::string& sqlstate, const std::string& message) {
+					handle->diagnostics.push_back({sqlstate, "[sqlpp11][fake driver]"+message});
+					return SQL_SUCCESS_WITH_INFO;
+				}
+				
+				template<typename Handle>
+				Handle* get(SQLHANDLE handle, SQLSMALLINT type) {
+					handle_t* h = static_cast<handle_t*>(handle);
+					if(!h || h->type != type) {
+						return nullptr;
+					}
+					h->diagnostics.clear();
+					return static_cast<Handle*>(h);
+				}
+				
+				std::string make_string(const SQLCHAR* text, SQLINTEGER length) {
+					if(!text) {
+						return std::string();
+					}
+					const char* chars = reinterpret_cast<const char*>(text);
+					return length == SQL_NTS ? std::string(chars) : std::string(chars, static_cast<size_t>(length));
+				}
+				
+				//! Copies text into a character buffer, returns false if it had to be truncated
+				template<typename Length>
+				bool copy_string(const std::string& text, SQLPOINTER target, SQLLEN buffer_length, Length* length) {
+					if(length) {
+						*length = static_cast<Length>(text.size());
+					}
+					if(!target || buffer_length <= 0) {
+						return text.empty();
+					}
+					const size_t count = std::min(text.size(), static_cast<size_t>(buffer_length - 1));
+					std::memcpy(target, text.data(), count);
+					static_cast<char*>(target)[count] = '\0';
+					return count == text.size();
+				}
+				
+				SQLSMALLINT sql_type(const column_t& column) {
+					if(column.precision) {
+						return SQL_DECIMAL;
+					}
+					switch(column.type) {
+						case column_type::integer: return SQL_BIGINT;
+						case column_type::boolean: return SQL_BIT;
+						case column_type::real: return SQL_DOUBLE;
+						case column_type::date: return SQL_TYPE_DATE;
+						case column_type::timestamp: return SQL_TYPE_TIMESTAMP;
+						case column_type::time: return SQL_TYPE_TIME;
+						default: return SQL_VARCHAR;
+					}
+				}
+				
+				SQLULEN column_size(const column_t& column) {
+					if(column.precision) {
+						return column.precision;
+					}
+					switch(column.type) {
+						case column_type::integer: return 19;
+						case column_type::boolean: return 1;
+						case column_type::real: return 15;
+						case column_type::date: return 10;
+						case column_type::timestamp: return 26;
+						case column_type::time: return 8;
+						default: return column.length;
+					}
+				}
+				
+				SQLSMALLINT decimal_digits(const column_t& column) {
+					if(column.precision) {
+						return static_cast<SQLSMALLINT>(column.scale);
+					}
+					return column.type == column_type::timestamp ? 6 : 0;
+				}
+				
+				SQLSMALLINT default_c_type(column_type type) {
+					switch(type) {
+						case column_type::integer: return SQL_C_SBIGINT;
+						case column_type::boolean: return SQL_C_BIT;
+						case column_type::real: return SQL_C_DOUBLE;
+						case column_type::date: return SQL_C_TYPE_DATE;
+						case column_type::timestamp: return SQL_C_TYPE_TIMESTAMP;
+						case column_type::time: return SQL_C_TYPE_TIME;
+						default: return SQL_C_CHAR;
+					}
+				}
+				
+				template<typename T>
+				SQLRETURN write_fixed(const T& value, SQLPOINTER target, SQLLEN* indicator) {
+					std::memcpy(target, &value, sizeof(T));
+					if(indicator) {
+						*indicator = sizeof(T);
+					}
+					return SQL_SUCCESS;
+				}
+				
+				//! The engine stores text as UTF-8, SQL_C_WCHAR buffers hold UTF-16 (invalid input isn't diagnosed)
+				std::u16string widen(const std::string& text) {
+					std::u16string wide;
+					for(size_t i = 0; i < text.size();) {
+						const unsigned char lead = static_cast<unsigned char>(text[i]);
+						const size_t size = lead < 0xC0 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+						uint32_t c = size == 1 ? lead : lead & (0x7F >> size);
+						for(size_t k = 1; k < size && i + k < text.size(); ++k) {
+							c = (c << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+						}
+						i += size;
+						if(c >= 0x10000) {
+							wide.push_back(static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10)));
+							wide.push_back(static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+						} else {
+							wide.push_back(static_cast<char16_t>(c));
+						}
+					}
+					return wide;
+				}
+				
+				std::string narrow(const char16_t* wide, size_t length) {
+					std::string text;
+					for(size_t i = 0; i < length; ++i) {
+						uint32_t c = wide[i];
+						if(c >= 0xD800 && c < 0xDC00 && i + 1 < length) {
+							c = 0x10000 + ((c - 0xD800) << 10) + (wide[++i] - 0xDC00);
+						}
+						if(c < 0x80) {
+							text.push_back(static_cast<char>(c));
+						} else if(c < 0x800) {
+							text.push_back(static_cast<char>(0xC0 | (c >> 6)));
+							text.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+						} else if(c < 0x10000) {
+							text.push_back(static_cast<char>(0xE0 | (c >> 12)));
+							text.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+							text.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+						} else {
+							text.push_back(static_cast<char>(0xF0 | (c >> 18)));
+							text.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+							text.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+							text.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+						}
+					}
+					return text;
+				}
+				
+				//! Converts a value to the C type requested by the application, offset tracks partial character fetches.
+				// record holds the precision and scale for SQL_C_NUMERIC, without one the scale is 0.
+				SQLRETURN write_value(stmt_t* s, const value_t& v, SQLSMALLINT c_type, SQLPOINTER target, SQLLEN buffer_length,
+					SQLLEN* indicator, size_t& offset, bool& done, const desc_t::record_t* record) {
+					if(v.is_null()) {
+						if(!indicator) {
+							return fail(s, "22002", "Indicator variable required but not supplied");
+						}
+						*indicator = SQL_NULL_DATA;
+						done = true;
+						return SQL_SUCCESS;
+					}
+					switch(c_type) {
+						case SQL_C_CHAR:
+						case SQL_C_BINARY: {
+							const std::string text = to_text(v);
+							if(offset >= text.size() && offset > 0) {
+								return SQL_NO_DATA;
+							}
+							const std::string rest = text.substr(offset);
+							const size_t capacity = c_type == SQL_C_CHAR ? std::max<SQLLEN>(buffer_length - 1, 0) : std::max<SQLLEN>(buffer_length, 0);
+							const size_t count = std::min(rest.size(), capacity);
+							if(target && count) {
+								std::memcpy(target, rest.data(), count);
+							}
+							if(target && c_type == SQL_C_CHAR && buffer_length > 0) {
+								static_cast<char*>(target)[count] = '\0';
+							}
+							if(indicator) {
+								*indicator = static_cast<SQLLEN>(rest.size());
+							}
+							if(count < rest.size()) {
+								offset += count;
+								return warn(s, "01004", "String data, right truncated");
+							}
+							offset = text.size() ? text.size() : 1;
+							done = true;
+							return SQL_SUCCESS;
+						}
+						case SQL_C_WCHAR: {
+							//As for SQL_C_CHAR, but the offset counts units and the lengths are in bytes
+							const std::u16string text = widen(to_text(v));
+							if(offset >= text.size() && offset > 0) {
+								return SQL_NO_DATA;
+							}
+							const std::u16string rest = text.substr(offset);
+							const size_t capacity = std::max<SQLLEN>(buffer_length / 2 - 1, 0);
+							const size_t count = std::min(rest.size(), capacity);
+							if(target && count) {
+								std::memcpy(target, rest.data(), count * sizeof(char16_t));
+							}
+							if(target && buffer_length >= 2) {
+								static_cast<char16_t*>(target)[count] = u'\0';
+							}
+							if(indicator) {
+								*indicator = static_cast<SQLLEN>(rest.size() * sizeof(char16_t));
+							}
+							if(count < rest.size()) {
+								offset += count;
+								return warn(s, "01004", "String data, right truncated");
+							}
+							offset = text.size() ? text.size() : 1;
+							done = true;
+							return SQL_SUCCESS;
+						}
+						case SQL_C_SBIGINT:
+						case SQL_C_UBIGINT:
+							done = true;
+							return write_fixed(static_cast<SQLBIGINT>(coerce(v, column_type::integer).integer), target, indicator);
+						case SQL_C_LONG:
+						case SQL_C_SLONG:
+						case SQL_C_ULONG:
+							done = true;
+							return write_fixed(static_cast<SQLINTEGER>(coerce(v, column_type::integer).integer), target, indicator);
+						case SQL_C_SHORT:
+						case SQL_C_SSHORT:
+						case SQL_C_USHORT:
+							done = true;
+							return write_fixed(static_cast<SQLSMALLINT>(coerce(v, column_type::integer).integer), target, indicator);
+						case SQL_C_BIT:
+						case SQL_C_TINYINT:
+						case SQL_C_STINYINT:
+						case SQL_C_UTINYINT:
+							done = true;
+							return write_fixed(static_cast<SQLCHAR>(coerce(v, c_type == SQL_C_BIT ? column_type::boolean : column_type::integer).integer), target, indicator);
+						case SQL_C_DOUBLE:
+							done = true;
+							return write_fixed(static_cast<SQLDOUBLE>(coerce(v, column_type::real).real), target, indicator);
+						case SQL_C_FLOAT:
+							done = true;
+							return write_fixed(static_cast<SQLREAL>(coerce(v, column_type::real).real), target, indicator);
+						case SQL_C_DATE:
+						case SQL_C_TYPE_DATE: {
+							const value_t d = coerce(v, column_type::date);
+							SQL_DATE_STRUCT date;
+							date.year = static_cast<SQLSMALLINT>(d.year);
+							date.month = static_cast<SQLUSMALLINT>(d.month);
+							date.day = static_cast<SQLUSMALLINT>(d.day);
+							done = true;
+							return write_fixed(date, target, indicator);
+						}
+						case SQL_C_TIMESTAMP:
+						case SQL_C_TYPE_TIMESTAMP: {
+							const value_t t = coerce(v, column_type::timestamp);
+							SQL_TIMESTAMP_STRUCT ts;
+							ts.year = static_cast<SQLSMALLINT>(t.year);
+							ts.month = static_cast<SQLUSMALLINT>(t.month);
+							ts.day = static_cast<SQLUSMALLINT>(t.day);
+							ts.hour = static_cast<SQLUSMALLINT>(t.hour);
+							ts.minute = static_cast<SQLUSMALLINT>(t.minute);
+							ts.second = static_cast<SQLUSMALLINT>(t.second);
+							ts.fraction = t.fraction;
+							done = true;
+							return write_fixed(ts, target, indicator);
+						}
+						case SQL_C_TIME:
+						case SQL_C_TYPE_TIME: {
+							const value_t t = coerce(v, column_type::time);
+							SQL_TIME_STRUCT time;
+							time.hour = static_cast<SQLUSMALLINT>(t.hour);
+							time.minute = static_cast<SQLUSMALLINT>(t.minute);
+							time.second = static_cast<SQLUSMALLINT>(t.second);
+							done = true;
+							return write_fixed(time, target, indicator);
+						}
+						case SQL_C_NUMERIC: {
+							const double real = coerce(v, column_type::real).real;
+							const SQLSMALLINT scale = record ? record->scale : 0;
+							const double magnitude = std::floor(std::fabs(real) * std::pow(10.0, scale) + 0.5);
+							if(magnitude >= 18446744073709551616.0) {
+								return fail(s, "22003", "Numeric value out of range");
+							}
+							SQL_NUMERIC_STRUCT numeric;
+							std::memset(&numeric, 0, sizeof(numeric));
+							numeric.precision = static_cast<SQLCHAR>(record && record->precision ? record->precision : 38);
+							numeric.scale = static_cast<SQLSCHAR>(scale);
+							numeric.sign = real < 0 ? 0 : 1;
+							const uint64_t bits = static_cast<uint64_t>(magnitude);
+							for(int i = 0; i < 8; ++i) {
+								numeric.val[i] = static_cast<SQLCHAR>(bits >> (8 * i));
+							}
+							done = true;
+							return write_fixed(numeric, target, indicator);
+						}
+						default:
+							return fail(s, "HYC00", "Optional feature not implemented: C type "+std::to_string(c_type));
+					}
+				}
+				
+				template<typename T>
+				T read_fixed(SQLPOINTER value) {
+					T t;
+					std::memcpy(&t, value, sizeof(T));
+					return t;
+				}
+				
+				//! Reads a bound parameter at execution time, as real drivers do, record is its APD record
+				value_t read_parameter(const parameter_t& p, const desc_t::record_t* record) {
+					if(!p.value || (p.indicator && *p.indicator == SQL_NULL_DATA)) {
+						return value_t();
+					}
+					switch(p.c_type) {
+						case SQL_C_CHAR:
+						case SQL_C_BINARY: {
+							const char* chars = static_cast<const char*>(p.value);
+							if(!p.indicator || *p.indicator == SQL_NTS) {
+								return make_text(std::string(chars));
+							}
+							return make_text(std::string(chars, static_cast<size_t>(*p.indicator)));
+						}
+						case SQL_C_WCHAR: {
+							const char16_t* wide = static_cast<const char16_t*>(p.value);
+							size_t length = 0;
+							if(!p.indicator || *p.indicator == SQL_NTS) {
+								while(wide[length]) {
+									++length;
+								}
+							} else {
+								length = static_cast<size_t>(*p.indicator) / sizeof(char16_t);
+							}
+							return make_text(narrow(wide, length));
+						}
+						case SQL_C_SBIGINT:
+							return make_integer(read_fixed<SQLBIGINT>(p.value));
+						case SQL_C_UBIGINT:
+							return make_integer(static_cast<int64_t>(read_fixed<SQLUBIGINT>(p.value)));
+						case SQL_C_LONG:
+						case SQL_C_SLONG:
+							return make_integer(read_fixed<SQLINTEGER>(p.value));
+						case SQL_C_ULONG:
+							return make_integer(read_fixed<SQLUINTEGER>(p.value));
+						case SQL_C_SHORT:
+						case SQL_C_SSHORT:
+							return make_integer(read_fixed<SQLSMALLINT>(p.value));
+						case SQL_C_USHORT:
+							return make_integer(read_fixed<SQLUSMALLINT>(p.value));
+						case SQL_C_TINYINT:
+						case SQL_C_STINYINT:
+							return make_integer(read_fixed<SQLSCHAR>(p.value));
+						case SQL_C_BIT:
+						case SQL_C_UTINYINT:
+							return make_integer(read_fixed<SQLCHAR>(p.value));
+						case SQL_C_DOUBLE:
+							return make_real(read_fixed<SQLDOUBLE>(p.value));
+						case SQL_C_FLOAT:
+							return make_real(read_fixed<SQLREAL>(p.value));
+						case SQL_C_DATE:
+						case SQL_C_TYPE_DATE: {
+							const auto d = read_fixed<SQL_DATE_STRUCT>(p.value);
+							return make_date(d.year, d.month, d.day);
+						}
+						case SQL_C_TIMESTAMP:
+						case SQL_C_TYPE_TIMESTAMP: {
+							const auto t = read_fixed<SQL_TIMESTAMP_STRUCT>(p.value);
+							return make_timestamp(t.year, t.month, t.day, t.hour, t.minute, t.second, t.fraction);
+						}
+						case SQL_C_TIME:
+						case SQL_C_TYPE_TIME: {
+							const auto t = read_fixed<SQL_TIME_STRUCT>(p.value);
+							return make_time(t.hour, t.minute, t.second);
+						}
+						case SQL_C_NUMERIC: {
+							const auto n = read_fixed<SQL_NUMERIC_STRUCT>(p.value);
+							double magnitude = 0;
+							for(int i = SQL_MAX_NUMERIC_LEN - 1; i >= 0; --i) {
+								magnitude = magnitude * 256 + n.val[i];
+							}
+							//The scale is taken from the descriptor, the one in the struct is ignored
+							const double value = magnitude / std::pow(10.0, record ? record->scale : 0);
+							return make_real(n.sign ? value : -value);
+						}
+						default:
+							throw error_t("HYC00", "Optional feature not implemented: parameter C type "+std::to_string(p.c_type));
+					}
+				}
+				
+				//! Waits for DO SLEEP, returns the SQLSTATE if it ended early: HY008 when cancelled, HYT00 when SQL_ATTR_QUERY_TIMEOUT expired
+				std::string sleep(stmt_t* s, double seconds) {
+					const double timeout = static_cast<double>(s->attribute(SQL_ATTR_QUERY_TIMEOUT, 0));
+					const bool times_out = timeout > 0 && timeout < seconds;
+					const std::chrono::duration<double> wait(times_out ? timeout : seconds);
+					std::unique_lock<std::mutex> lock(s->cancel_mutex);
+					if(s->cancel_condition.wait_for(lock, wait, [s]() { return s->cancel_requested; })) {
+						return "HY008";
+					}
+					return times_out ? "HYT00" : std::string();
+				}
+				
+				//! Marks the statement as executing, so SQLCancel has something to cancel
+				struct executing_t {
+					stmt_t* s;
+					
+					explicit executing_t(stmt_t* statement) : s(statement) {
+						std::lock_guard<std::mutex> lock(s->cancel_mutex);
+						s->executing = true;
+						s->cancel_requested = false;
+					}
+					~executing_t() {
+						std::lock_guard<std::mutex> lock(s->cancel_mutex);
+						s->executing = false;
+						s->cancel_requested = false;
+					}
+				};
+				
+				//! The set-th element of a bound parameter array, at a stride of buffer_length (column-wise, like SQLFetch) or bind_type (row-wise)
+				parameter_t parameter_element(const parameter_t& p, size_t set, SQLULEN bind_type) {
+					if(set == 0) {
+						return p;
+					}
+					const size_t value_stride = bind_type == SQL_PARAM_BIND_BY_COLUMN ? static_cast<size_t>(p.buffer_length) : bind_type;
+					const size_t indicator_stride = bind_type == SQL_PARAM_BIND_BY_COLUMN ? sizeof(SQLLEN) : bind_type;
+					parameter_t element = p;
+					if(p.value) {
+						element.value = static_cast<char*>(p.value) + set * value_stride;
+					}
+					if(p.indicator) {
+						element.indicator = reinterpret_cast<SQLLEN*>(reinterpret_cast<char*>(p.indicator) + set * indicator_stride);
+					}
+					return element;
+				}
+				
+				SQLRETURN execute_statement(stmt_t* s) {
+					if(s->result) {
+						return fail(s, "24000", "Invalid cursor state");
+					}
+					if(!s->prepared) {
+						return fail(s, "HY010", "Function sequence error");
+					}
+					if(s->dbc->session.killed) {
+						return fail(s, "08S01", "Communication link failure");
+					}
+					executing_t executing(s);
+					//Parameter arrays (SQL_ATTR_PARAMSET_SIZE) run the statement once per set, the last result set is kept.
+					// Like most drivers, the first failing set stops the execution, the sets after it are left unused,
+					// unless attr_continue_after_errors asks to run them all.
+					const size_t sets = std::max<SQLULEN>(s->attribute(SQL_ATTR_PARAMSET_SIZE, 1), 1);
+					SQLULEN* processed = reinterpret_cast<SQLULEN*>(s->attribute(SQL_ATTR_PARAMS_PROCESSED_PTR, 0));
+					SQLUSMALLINT* status = reinterpret_cast<SQLUSMALLINT*>(s->attribute(SQL_ATTR_PARAM_STATUS_PTR, 0));
+					if(processed) {
+						*processed = 0;
+					}
+					if(status) {
+						std::fill(status, status + sets, static_cast<SQLUSMALLINT>(SQL_PARAM_UNUSED));
+					}
+					const bool continue_after_errors = sets > 1 && s->attribute(attr_continue_after_errors, 0) != 0;
+					size_t set = 0;
+					const auto failed = [&]() {
+						if(processed) {
+							*processed = std::min(set + 1, sets);
+						}
+						if(status && set < sets) {
+							status[set] = SQL_PARAM_ERROR;
+						}
+					};
+					try {
+						const SQLULEN bind_type = s->attribute(SQL_ATTR_PARAM_BIND_TYPE, SQL_PARAM_BIND_BY_COLUMN);
+						const size_t count = parameter_count(*s->prepared);
+						execution_t execution;
+						int64_t affected = 0;
+						//Diagnostics of the sets that failed when continue_after_errors runs past them
+						std::vector<diagnostic_t> errors;
+						for(set = 0; set < sets; ++set) {
+							std::vector<value_t> parameters;
+							for(size_t i = 1; i <= count; ++i) {
+								auto it = s->parameters.find(static_cast<SQLUSMALLINT>(i));
+								if(it == s->parameters.end()) {
+									return fail(s, "07002", "COUNT field incorrect");
+								}
+								parameters.push_back(read_parameter(parameter_element(it->second, set, bind_type), s->parameter_descriptor.record(static_cast<SQLSMALLINT>(i))));
+							}
+							if(continue_after_errors) {
+								try {
+									execution = execute(*s->prepared, s->dbc->session, parameters);
+								} catch(const error_t& e) {
+									failed();
+									errors.push_back({e.sqlstate, "[sqlpp11][fake driver]"+std::string(e.what())});
+									continue;
+								}
+							} else {
+								execution = execute(*s->prepared, s->dbc->session, parameters);
+							}
+							if(execution.sleep > 0) {
+								const std::string state = sleep(s, execution.sleep);
+								if(state == "HY008") {
+									return fail(s, state, "Operation canceled");
+								} else if(!state.empty()) {
+									return fail(s, state, "Timeout expired");
+								}
+							}
+							if(processed) {
+								*processed = set + 1;
+							}
+							if(status) {
+								status[set] = SQL_PARAM_SUCCESS;
+							}
+							affected = execution.affected < 0 || affected < 0 ? -1 : affected + execution.affected;
+						}
+						execution.affected = affected;
+						s->affected = execution.affected;
+						s->result = execution.result;
+						if(s->result) {
+							const auto max_rows = s->attributes.find(SQL_ATTR_MAX_ROWS);
+							if(max_rows != s->attributes.end() && max_rows->second) {
+								s->result->rows = std::min<size_t>(s->result->rows, max_rows->second);
+							}
+							//Like MySQL, report the size of result sets
+							s->affected = static_cast<int64_t>(s->result->rows);
+						}
+						if(!errors.empty()) {
+							s->diagnostics = errors;
+							return errors.size() == sets ? SQL_ERROR : SQL_SUCCESS_WITH_INFO;
+						}
+						return SQL_SUCCESS;
+					} catch(const error_t& e) {
+						failed();
+						return fail(s, e.sqlstate, e.what());
+					} catch(const std::exception& e) {
+						failed();
+						return fail(s, "HY000", e.what());
+					}
+				}
+				
+				SQLRETURN prepare_statement(stmt_t* s, SQLCHAR* text, SQLINTEGER length) {
+					if(s->result) {
+						return fail(s, "24000", "Invalid cursor state");
+					}
+					if(s->dbc->session.killed) {
+						return fail(s, "08S01", "Communication link failure");
+					}
+					try {
+						s->prepared = parse(make_string(text, length));
+						return SQL_SUCCESS;
+					} catch(const error_t& e) {
+						s->prepared.reset();
+						return fail(s, e.sqlstate, e.what());
+					}
+				}
+			}
+		}
+	}
+}
+
+using namespace sqlpp::odbc::fake;
+
+extern "C" {
+	SQLRETURN SQL_API SQLAllocHandle(SQLSMALLINT HandleType, SQLHANDLE InputHandle, SQLHANDLE* OutputHandlePtr) {
+		if(!OutputHandlePtr) {
+			return SQL_ERROR;
+		}
+		*OutputHandlePtr = SQL_NULL_HANDLE;
+		switch(HandleType) {
+			case SQL_HANDLE_ENV:
+				*OutputHandlePtr = new env_t();
+				return SQL_SUCCESS;
+			case SQL_HANDLE_DBC: {
+				env_t* env = get<env_t>(InputHandle, SQL_HANDLE_ENV);
+				if(!env) {
+					return SQL_INVALID_HANDLE;
+				}
+				*OutputHandlePtr = new dbc_t(env);
+				return SQL_SUCCESS;
+			}
+			case SQL_HANDLE_STMT: {
+				dbc_t* dbc = get<dbc_t>(InputHandle, SQL_HANDLE_DBC);
+				if(!dbc) {
+					return SQL_INVALID_HANDLE;
+				}
+				if(!dbc->connected) {
+					return fail(dbc, "08003", "Connection not open");
+				}
+				*OutputHandlePtr = new stmt_t(dbc);
+				return SQL_SUCCESS;
+			}
+			default:
+				return SQL_ERROR;
+		}
+	}
+	
+	SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT HandleType, SQLHANDLE Handle) {
+		handle_t* h = static_cast<handle_t*>(Handle);
+		if(!h || h->type != HandleType) {
+			return SQL_INVALID_HANDLE;
+		}
+		delete h;
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLSetEnvAttr(SQLHENV EnvironmentHandle, SQLINTEGER Attribute, SQLPOINTER ValuePtr, SQLINTEGER) {
+		env_t* env = get<env_t>(EnvironmentHandle, SQL_HANDLE_ENV);
+		if(!env) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(Attribute == SQL_ATTR_ODBC_VERSION) {
+			env->version = static_cast<SQLINTEGER>(reinterpret_cast<SQLLEN>(ValuePtr));
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLGetEnvAttr(SQLHENV EnvironmentHandle, SQLINTEGER Attribute, SQLPOINTER ValuePtr, SQLINTEGER, SQLINTEGER* StringLengthPtr) {
+		env_t* env = get<env_t>(EnvironmentHandle, SQL_HANDLE_ENV);
+		if(!env) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(Attribute != SQL_ATTR_ODBC_VERSION) {
+			return fail(env, "HY092", "Invalid attribute/option identifier");
+		}
+		if(ValuePtr) {
+			*static_cast<SQLINTEGER*>(ValuePtr) = env->version;
+		}
+		if(StringLengthPtr) {
+			*StringLengthPtr = sizeof(SQLINTEGER);
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLConnect(SQLHDBC ConnectionHandle, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT) {
+		dbc_t* dbc = get<dbc_t>(ConnectionHandle, SQL_HANDLE_DBC);
+		if(!dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(dbc->connected) {
+			return fail(dbc, "08002", "Connection name in use");
+		}
+		dbc->connected = true;
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLDriverConnect(SQLHDBC ConnectionHandle, SQLHWND, SQLCHAR* InConnectionString, SQLSMALLINT StringLength1,
+		SQLCHAR* OutConnectionString, SQLSMALLINT BufferLength, SQLSMALLINT* StringLength2Ptr, SQLUSMALLINT) {
+		dbc_t* dbc = get<dbc_t>(ConnectionHandle, SQL_HANDLE_DBC);
+		if(!dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(dbc->connected) {
+			return fail(dbc, "08002", "Connection name in use");
+		}
+		dbc->connected = true;
+		if(!copy_string(make_string(InConnectionString, StringLength1), OutConnectionString, BufferLength, StringLength2Ptr)) {
+			return warn(dbc, "01004", "String data, right truncated");
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLDisconnect(SQLHDBC ConnectionHandle) {
+		dbc_t* dbc = get<dbc_t>(ConnectionHandle, SQL_HANDLE_DBC);
+		if(!dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!dbc->connected) {
+			return fail(dbc, "08003", "Connection not open");
+		}
+		rollback(dbc->session);
+		dbc->connected = false;
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLGetDiagRec(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT RecNumber, SQLCHAR* SQLState,
+		SQLINTEGER* NativeErrorPtr, SQLCHAR* MessageText, SQLSMALLINT BufferLength, SQLSMALLINT* TextLengthPtr) {
+		handle_t* h = static_cast<handle_t*>(Handle);
+		if(!h || h->type != HandleType) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(RecNumber < 1) {
+			return SQL_ERROR;
+		}
+		if(static_cast<size_t>(RecNumber) > h->diagnostics.size()) {
+			return SQL_NO_DATA;
+		}
+		const diagnostic_t& d = h->diagnostics[static_cast<size_t>(RecNumber - 1)];
+		if(SQLState) {
+			copy_string(d.sqlstate, SQLState, SQL_SQLSTATE_SIZE + 1, static_cast<SQLSMALLINT*>(nullptr));
+		}
+		if(NativeErrorPtr) {
+			*NativeErrorPtr = 0;
+		}
+		return copy_string(d.message, MessageText, BufferLength, TextLengthPtr) ? SQL_SUCCESS : SQL_SUCCESS_WITH_INFO;
+	}
+	
+	SQLRETURN SQL_API SQLGetDiagField(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT RecNumber, SQLSMALLINT DiagIdentifier,
+		SQLPOINTER DiagInfoPtr, SQLSMALLINT BufferLength, SQLSMALLINT* StringLengthPtr) {
+		handle_t* h = static_cast<handle_t*>(Handle);
+		if(!h || h->type != HandleType) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(DiagIdentifier == SQL_DIAG_NUMBER) {
+			if(DiagInfoPtr) {
+				*static_cast<SQLINTEGER*>(DiagInfoPtr) = static_cast<SQLINTEGER>(h->diagnostics.size());
+			}
+			return SQL_SUCCESS;
+		}
+		if(RecNumber < 1) {
+			return SQL_ERROR;
+		}
+		if(static_cast<size_t>(RecNumber) > h->diagnostics.size()) {
+			return SQL_NO_DATA;
+		}
+		const diagnostic_t& d = h->diagnostics[static_cast<size_t>(RecNumber - 1)];
+		switch(DiagIdentifier) {
+			case SQL_DIAG_SQLSTATE:
+				return copy_string(d.sqlstate, DiagInfoPtr, BufferLength, StringLengthPtr) ? SQL_SUCCESS : SQL_SUCCESS_WITH_INFO;
+			case SQL_DIAG_MESSAGE_TEXT:
+				return copy_string(d.message, DiagInfoPtr, BufferLength, StringLengthPtr) ? SQL_SUCCESS : SQL_SUCCESS_WITH_INFO;
+			case SQL_DIAG_NATIVE:
+				if(DiagInfoPtr) {
+					*static_cast<SQLINTEGER*>(DiagInfoPtr) = 0;
+				}
+				return SQL_SUCCESS;
+			default:
+				return SQL_ERROR;
+		}
+	}
+	
+	SQLRETURN SQL_API SQLPrepare(SQLHSTMT StatementHandle, SQLCHAR* StatementText, SQLINTEGER TextLength) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		return prepare_statement(s, StatementText, TextLength);
+	}
+	
+	SQLRETURN SQL_API SQLExecute(SQLHSTMT StatementHandle) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		return execute_statement(s);
+	}
+	
+	SQLRETURN SQL_API SQLExecDirect(SQLHSTMT StatementHandle, SQLCHAR* StatementText, SQLINTEGER TextLength) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		const SQLRETURN rc = prepare_statement(s, StatementText, TextLength);
+		return SQL_SUCCEEDED(rc) ? execute_statement(s) : rc;
+	}
+	
+	SQLRETURN SQL_API SQLRowCount(SQLHSTMT StatementHandle, SQLLEN* RowCountPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(RowCountPtr) {
+			*RowCountPtr = static_cast<SQLLEN>(s->affected);
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!s->result) {
+			return fail(s, "24000", "Invalid cursor state");
+		}
+		s->data_column = 0;
+		s->data_offset = 0;
+		s->data_done = false;
+		const SQLULEN array_size = std::max<SQLULEN>(s->attribute(SQL_ATTR_ROW_ARRAY_SIZE, 1), 1);
+		const SQLULEN bind_type = s->attribute(SQL_ATTR_ROW_BIND_TYPE, SQL_BIND_BY_COLUMN);
+		SQLULEN* fetched = reinterpret_cast<SQLULEN*>(s->attribute(SQL_ATTR_ROWS_FETCHED_PTR, 0));
+		SQLUSMALLINT* status = reinterpret_cast<SQLUSMALLINT*>(s->attribute(SQL_ATTR_ROW_STATUS_PTR, 0));
+		const size_t count = std::min<size_t>(array_size, s->result->rows - std::min(s->row, s->result->rows));
+		if(fetched) {
+			*fetched = count;
+		}
+		if(status) {
+			std::fill(status, status + array_size, static_cast<SQLUSMALLINT>(SQL_ROW_NOROW));
+		}
+		if(count == 0) {
+			s->on_row = false;
+			s->rowset_size = 0;
+			return SQL_NO_DATA;
+		}
+		s->row += count;
+		s->rowset_size = count;
+		s->on_row = true;
+		
+		//Bound columns are written row by row, at a stride of buffer_length (column-wise) or bind_type (row-wise)
+		SQLRETURN rc = SQL_SUCCESS;
+		const size_t first = s->row - count;
+		for(size_t r = 0; r < count; ++r) {
+			SQLRETURN row_rc = SQL_SUCCESS;
+			for(const auto& entry : s->bindings) {
+				if(entry.first > s->result->columns.size()) {
+					return fail(s, "07009", "Invalid descriptor index");
+				}
+				const binding_t& binding = entry.second;
+				const size_t value_stride = bind_type == SQL_BIND_BY_COLUMN ? static_cast<size_t>(binding.buffer_length) : bind_type;
+				const size_t indicator_stride = bind_type == SQL_BIND_BY_COLUMN ? sizeof(SQLLEN) : bind_type;
+				SQLPOINTER target = static_cast<char*>(binding.target) + r * value_stride;
+				SQLLEN* indicator = binding.indicator ? reinterpret_cast<SQLLEN*>(reinterpret_cast<char*>(binding.indicator) + r * indicator_stride) : nullptr;
+				size_t offset = 0;
+				bool done = false;
+				SQLRETURN value_rc;
+				try {
+					const value_t v = s->result->cell(first + r, entry.first - 1);
+					value_rc = write_value(s, v, binding.c_type, target, binding.buffer_length, indicator, offset, done,
+						s->row_descriptor.record(static_cast<SQLSMALLINT>(entry.first)));
+				} catch(const sqlpp::odbc::fake::error_t& e) {
+					return fail(s, e.sqlstate, e.what());
+				}
+				if(value_rc == SQL_ERROR) {
+					if(status) {
+						status[r] = SQL_ROW_ERROR;
+					}
+					return SQL_ERROR;
+				}
+				if(value_rc == SQL_SUCCESS_WITH_INFO) {
+					row_rc = SQL_SUCCESS_WITH_INFO;
+				}
+			}
+			if(status) {
+				status[r] = row_rc == SQL_SUCCESS ? SQL_ROW_SUCCESS : SQL_ROW_SUCCESS_WITH_INFO;
+			}
+			if(row_rc != SQL_SUCCESS) {
+				rc = row_rc;
+			}
+		}
+		return rc;
+	}
+	
+	SQLRETURN SQL_API SQLBindCol(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLSMALLINT TargetType,
+		SQLPOINTER TargetValuePtr, SQLLEN BufferLength, SQLLEN* StrLen_or_IndPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(ColumnNumber < 1) {
+			return fail(s, "07009", "Invalid descriptor index: bookmarks are not supported");
+		}
+		if(!TargetValuePtr) {
+			s->bindings.erase(ColumnNumber);
+			return SQL_SUCCESS;
+		}
+		if(BufferLength < 0) {
+			return fail(s, "HY090", "Invalid string or buffer length");
+		}
+		s->bindings[ColumnNumber] = binding_t{TargetType, TargetValuePtr, BufferLength, StrLen_or_IndPtr};
+		//Binding resets precision and scale to their defaults
+		s->row_descriptor.records[ColumnNumber] = desc_t::record_t{TargetType, 0, 0};
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLGetData(SQLHSTMT StatementHandle, SQLUSMALLINT Col_or_Param_Num, SQLSMALLINT TargetType,
+		SQLPOINTER TargetValuePtr, SQLLEN BufferLength, SQLLEN* StrLen_or_IndPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!s->result || !s->on_row) {
+			return fail(s, "24000", "Invalid cursor state");
+		}
+		if(Col_or_Param_Num < 1 || Col_or_Param_Num > s->result->columns.size()) {
+			return fail(s, "07009", "Invalid descriptor index");
+		}
+		//Neither SQL_GD_BLOCK nor SQL_GD_BOUND is reported
+		if(s->rowset_size > 1) {
+			return fail(s, "HYC00", "Optional feature not implemented: SQLGetData with a rowset size above 1");
+		}
+		if(s->bindings.count(Col_or_Param_Num)) {
+			return fail(s, "07009", "Invalid descriptor index: column is bound");
+		}
+		//SQL_GETDATA_EXTENSIONS is reported as 0, so columns have to be retrieved in increasing order
+		if(Col_or_Param_Num < s->data_column) {
+			return fail(s, "07009", "Invalid descriptor index: columns must be retrieved in increasing order");
+		}
+		if(Col_or_Param_Num != s->data_column) {
+			s->data_column = Col_or_Param_Num;
+			s->data_offset = 0;
+			s->data_done = false;
+		} else if(s->data_done) {
+			return SQL_NO_DATA;
+		}
+		const column_t& column = s->result->columns[Col_or_Param_Num - 1];
+		SQLSMALLINT c_type = TargetType == SQL_C_DEFAULT ? default_c_type(column.type) : TargetType;
+		//Only SQL_ARD_TYPE takes the type, precision and scale from the ARD, SQL_C_NUMERIC alone uses the defaults
+		const desc_t::record_t* record = nullptr;
+		if(TargetType == SQL_ARD_TYPE) {
+			record = s->row_descriptor.record(static_cast<SQLSMALLINT>(Col_or_Param_Num));
+			if(!record) {
+				return fail(s, "07009", "Invalid descriptor index: no ARD record");
+			}
+			c_type = record->type;
+		}
+		try {
+			const value_t v = s->result->cell(s->row - 1, Col_or_Param_Num - 1);
+			return write_value(s, v, c_type, TargetValuePtr, BufferLength, StrLen_or_IndPtr, s->data_offset, s->data_done, record);
+		} catch(const sqlpp::odbc::fake::error_t& e) {
+			return fail(s, e.sqlstate, e.what());
+		}
+	}
+	
+	SQLRETURN SQL_API SQLBindParameter(SQLHSTMT StatementHandle, SQLUSMALLINT ParameterNumber, SQLSMALLINT InputOutputType,
+		SQLSMALLINT ValueType, SQLSMALLINT ParameterType, SQLULEN, SQLSMALLINT, SQLPOINTER ParameterValuePtr, SQLLEN BufferLength,
+		SQLLEN* StrLen_or_IndPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(ParameterNumber < 1) {
+			return fail(s, "07009", "Invalid descriptor index");
+		}
+		if(InputOutputType != SQL_PARAM_INPUT) {
+			return fail(s, "HYC00", "Optional feature not implemented: output parameters");
+		}
+		s->parameters[ParameterNumber] = parameter_t{ValueType, ParameterType, ParameterValuePtr, BufferLength, StrLen_or_IndPtr};
+		s->parameter_descriptor.records[ParameterNumber] = desc_t::record_t{ValueType, 0, 0};
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLNumParams(SQLHSTMT StatementHandle, SQLSMALLINT* ParameterCountPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!s->prepared) {
+			return fail(s, "HY010", "Function sequence error");
+		}
+		if(ParameterCountPtr) {
+			*ParameterCountPtr = static_cast<SQLSMALLINT>(parameter_count(*s->prepared));
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT StatementHandle, SQLUSMALLINT Option) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		switch(Option) {
+			case SQL_CLOSE:
+				s->close_cursor();
+				return SQL_SUCCESS;
+			case SQL_UNBIND:
+				s->bindings.clear();
+				s->row_descriptor.records.clear();
+				return SQL_SUCCESS;
+			case SQL_RESET_PARAMS:
+				s->parameters.clear();
+				s->parameter_descriptor.records.clear();
+				return SQL_SUCCESS;
+			case SQL_DROP:
+				delete s;
+				return SQL_SUCCESS;
+			default:
+				return fail(s, "HY092", "Invalid attribute/option identifier");
+		}
+	}
+	
+	SQLRETURN SQL_API SQLCloseCursor(SQLHSTMT StatementHandle) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!s->result) {
+			return fail(s, "24000", "Invalid cursor state");
+		}
+		s->close_cursor();
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLCancel(SQLHSTMT StatementHandle) {
+		stmt_t* s = static_cast<stmt_t*>(StatementHandle);
+		if(!s || s->type != SQL_HANDLE_STMT) {
+			return SQL_INVALID_HANDLE;
+		}
+		//Only DO SLEEP takes long enough to be cancelled, without a running statement this does nothing
+		std::lock_guard<std::mutex> lock(s->cancel_mutex);
+		if(s->executing) {
+			s->cancel_requested = true;
+			s->cancel_condition.notify_all();
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLMoreResults(SQLHSTMT StatementHandle) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		s->close_cursor();
+		return SQL_NO_DATA;
+	}
+	
+	SQLRETURN SQL_API SQLSetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER Attribute, SQLPOINTER ValuePtr, SQLINTEGER) {
+		dbc_t* dbc = get<dbc_t>(ConnectionHandle, SQL_HANDLE_DBC);
+		if(!dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		const SQLUINTEGER value = static_cast<SQLUINTEGER>(reinterpret_cast<SQLULEN>(ValuePtr));
+		if(Attribute == SQL_ATTR_AUTOCOMMIT) {
+			const bool autocommit = value == SQL_AUTOCOMMIT_ON;
+			if(autocommit && !dbc->session.autocommit) {
+				//Switching autocommit on commits the open transaction
+				commit(dbc->session);
+			}
+			dbc->session.autocommit = autocommit;
+		}
+		dbc->attributes[Attribute] = value;
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLGetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER Attribute, SQLPOINTER ValuePtr, SQLINTEGER, SQLINTEGER* StringLengthPtr) {
+		dbc_t* dbc = get<dbc_t>(ConnectionHandle, SQL_HANDLE_DBC);
+		if(!dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		SQLUINTEGER value = 0;
+		if(Attribute == SQL_ATTR_AUTOCOMMIT) {
+			value = dbc->session.autocommit ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
+		} else if(Attribute == SQL_ATTR_CONNECTION_DEAD) {
+			value = dbc->connected && !dbc->session.killed ? SQL_CD_FALSE : SQL_CD_TRUE;
+		} else {
+			auto it = dbc->attributes.find(Attribute);
+			if(it == dbc->attributes.end()) {
+				return fail(dbc, "HY092", "Invalid attribute/option identifier");
+			}
+			value = it->second;
+		}
+		if(ValuePtr) {
+			*static_cast<SQLUINTEGER*>(ValuePtr) = value;
+		}
+		if(StringLengthPtr) {
+			*StringLengthPtr = sizeof(SQLUINTEGER);
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLSetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute, SQLPOINTER ValuePtr, SQLINTEGER) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		s->attributes[Attribute] = reinterpret_cast<SQLULEN>(ValuePtr);
+		const SQLULEN max_sets = s->attribute(attr_max_paramset_size, 0);
+		if(Attribute == SQL_ATTR_PARAMSET_SIZE && max_sets && s->attributes[Attribute] > max_sets) {
+			s->attributes[Attribute] = max_sets;
+			return warn(s, "01S02", "Option value changed");
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLGetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute, SQLPOINTER ValuePtr, SQLINTEGER, SQLINTEGER* StringLengthPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(Attribute == SQL_ATTR_APP_ROW_DESC || Attribute == SQL_ATTR_APP_PARAM_DESC) {
+			if(ValuePtr) {
+				*static_cast<SQLHDESC*>(ValuePtr) = Attribute == SQL_ATTR_APP_ROW_DESC ? &s->row_descriptor : &s->parameter_descriptor;
+			}
+			return SQL_SUCCESS;
+		}
+		const SQLULEN value = s->attribute(Attribute, Attribute == SQL_ATTR_ROW_ARRAY_SIZE || Attribute == SQL_ATTR_PARAMSET_SIZE ? 1 : 0);
+		if(ValuePtr) {
+			*static_cast<SQLULEN*>(ValuePtr) = value;
+		}
+		if(StringLengthPtr) {
+			*StringLengthPtr = sizeof(SQLULEN);
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLSetDescField(SQLHDESC DescriptorHandle, SQLSMALLINT RecNumber, SQLSMALLINT FieldIdentifier, SQLPOINTER ValuePtr, SQLINTEGER) {
+		desc_t* d = get<desc_t>(DescriptorHandle, SQL_HANDLE_DESC);
+		if(!d) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(RecNumber < 1) {
+			return fail(d, "07009", "Invalid descriptor index");
+		}
+		desc_t::record_t& record = d->records[RecNumber];
+		const SQLSMALLINT value = static_cast<SQLSMALLINT>(reinterpret_cast<SQLLEN>(ValuePtr));
+		switch(FieldIdentifier) {
+			case SQL_DESC_TYPE:
+			case SQL_DESC_CONCISE_TYPE:
+				record = desc_t::record_t{value, 0, 0};
+				return SQL_SUCCESS;
+			case SQL_DESC_PRECISION:
+				record.precision = value;
+				return SQL_SUCCESS;
+			case SQL_DESC_SCALE:
+				record.scale = value;
+				return SQL_SUCCESS;
+			case SQL_DESC_DATA_PTR:
+				//Binds the record with the type set before, keeping length and indicator of an earlier binding
+				if(d->rows) {
+					binding_t& binding = d->stmt->bindings[RecNumber];
+					binding.c_type = record.type;
+					binding.target = ValuePtr;
+				} else {
+					parameter_t& parameter = d->stmt->parameters[RecNumber];
+					parameter.c_type = record.type;
+					parameter.value = ValuePtr;
+				}
+				return SQL_SUCCESS;
+			default:
+				return fail(d, "HY091", "Invalid descriptor field identifier");
+		}
+	}
+	
+	SQLRETURN SQL_API SQLEndTran(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT CompletionType) {
+		dbc_t* dbc = get<dbc_t>(Handle, SQL_HANDLE_DBC);
+		if(HandleType != SQL_HANDLE_DBC || !dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(dbc->session.killed) {
+			return fail(dbc, "08S01", "Communication link failure");
+		}
+		if(CompletionType == SQL_COMMIT) {
+			commit(dbc->session);
+		} else {
+			rollback(dbc->session);
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT StatementHandle, SQLSMALLINT* ColumnCountPtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(ColumnCountPtr) {
+			*ColumnCountPtr = s->result ? static_cast<SQLSMALLINT>(s->result->columns.size()) : 0;
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLDescribeCol(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLCHAR* ColumnName, SQLSMALLINT BufferLength,
+		SQLSMALLINT* NameLengthPtr, SQLSMALLINT* DataTypePtr, SQLULEN* ColumnSizePtr, SQLSMALLINT* DecimalDigitsPtr, SQLSMALLINT* NullablePtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!s->result) {
+			return fail(s, "07005", "Prepared statement not a cursor-specification");
+		}
+		if(ColumnNumber < 1 || ColumnNumber > s->result->columns.size()) {
+			return fail(s, "07009", "Invalid descriptor index");
+		}
+		const column_t& column = s->result->columns[ColumnNumber - 1];
+		if(DataTypePtr) {
+			*DataTypePtr = sql_type(column);
+		}
+		if(ColumnSizePtr) {
+			*ColumnSizePtr = column_size(column);
+		}
+		if(DecimalDigitsPtr) {
+			*DecimalDigitsPtr = decimal_digits(column);
+		}
+		if(NullablePtr) {
+			*NullablePtr = column.nullable ? SQL_NULLABLE : SQL_NO_NULLS;
+		}
+		if(!copy_string(column.name, ColumnName, BufferLength, NameLengthPtr)) {
+			return warn(s, "01004", "String data, right truncated");
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLColAttribute(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLUSMALLINT FieldIdentifier,
+		SQLPOINTER CharacterAttributePtr, SQLSMALLINT BufferLength, SQLSMALLINT* StringLengthPtr, SQLLEN* NumericAttributePtr) {
+		stmt_t* s = get<stmt_t>(StatementHandle, SQL_HANDLE_STMT);
+		if(!s) {
+			return SQL_INVALID_HANDLE;
+		}
+		if(!s->result) {
+			return fail(s, "07005", "Prepared statement not a cursor-specification");
+		}
+		if(FieldIdentifier == SQL_DESC_COUNT) {
+			if(NumericAttributePtr) {
+				*NumericAttributePtr = static_cast<SQLLEN>(s->result->columns.size());
+			}
+			return SQL_SUCCESS;
+		}
+		if(ColumnNumber < 1 || ColumnNumber > s->result->columns.size()) {
+			return fail(s, "07009", "Invalid descriptor index");
+		}
+		const column_t& column = s->result->columns[ColumnNumber - 1];
+		SQLLEN value = 0;
+		switch(FieldIdentifier) {
+			case SQL_DESC_NAME:
+			case SQL_DESC_LABEL:
+				if(!copy_string(column.name, CharacterAttributePtr, BufferLength, StringLengthPtr)) {
+					return warn(s, "01004", "String data, right truncated");
+				}
+				return SQL_SUCCESS;
+			case SQL_DESC_TYPE:
+			case SQL_DESC_CONCISE_TYPE:
+				value = sql_type(column);
+				break;
+			case SQL_DESC_LENGTH:
+			case SQL_DESC_PRECISION:
+			case SQL_DESC_DISPLAY_SIZE:
+			case SQL_DESC_OCTET_LENGTH:
+				value = static_cast<SQLLEN>(column_size(column));
+				break;
+			case SQL_DESC_SCALE:
+				value = decimal_digits(column);
+				break;
+			case SQL_DESC_NULLABLE:
+				value = column.nullable ? SQL_NULLABLE : SQL_NO_NULLS;
+				break;
+			case SQL_DESC_UNSIGNED:
+				value = column.type == column_type::integer || column.type == column_type::real ? SQL_FALSE : SQL_TRUE;
+				break;
+			default:
+				return fail(s, "HY091", "Invalid descriptor field identifier");
+		}
+		if(NumericAttributePtr) {
+			*NumericAttributePtr = value;
+		}
+		return SQL_SUCCESS;
+	}
+	
+	SQLRETURN SQL_API SQLGetInfo(SQLHDBC ConnectionHandle, SQLUSMALLINT InfoType, SQLPOINTER InfoValuePtr, SQLSMALLINT BufferLength, SQLSMALLINT* StringLengthPtr) {
+		dbc_t* dbc = get<dbc_t>(ConnectionHandle, SQL_HANDLE_DBC);
+		if(!dbc) {
+			return SQL_INVALID_HANDLE;
+		}
+		const char* text = nullptr;
+		switch(InfoType) {
+			case SQL_DRIVER_NAME: text = "sqlpp11-odbc-fake-driver"; break;
+			case SQL_DRIVER_VER: text = "01.00.0000"; break;
+			case SQL_DRIVER_ODBC_VER: text = "03.80"; break;
+			case SQL_DBMS_NAME: text = "sqlpp11 fake"; break;
+			case SQL_DBMS_VER: text = "01.00.0000"; break;
+			case SQL_IDENTIFIER_QUOTE_CHAR: text = "\""; break;
+			case SQL_GETDATA_EXTENSIONS:
+				if(InfoValuePtr) {
+					*static_cast<SQLUINTEGER*>(InfoValuePtr) = 0;
+				}
+				return SQL_SUCCESS;
+			case SQL_MAX_CONCURRENT_ACTIVITIES:
+			case SQL_TXN_CAPABLE:
+			case SQL_CURSOR_COMMIT_BEHAVIOR:
+				if(InfoValuePtr) {
+					*static_cast<SQLUSMALLINT*>(InfoValuePtr) = InfoType == SQL_TXN_CAPABLE ? SQL_TC_ALL :
+						InfoType == SQL_CURSOR_COMMIT_BEHAVIOR ? SQL_CB_PRESERVE : 0;
+				}
+				return SQL_SUCCESS;
+			default:
+				return fail(dbc, "HY096", "Information type out of range");
+		}
+		if(!copy_string(text, InfoValuePtr, BufferLength, StringLengthPtr)) {
+			return warn(dbc, "01004", "String data, right truncated");
+		}
+		return SQL_SUCCESS;
+	}
+}